@@ -0,0 +1,47 @@
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "config.h"
+#include "globals.h"
+#include "CalibrationStore.h"
+#include "Sensors.h"
+
+// Firmware entry point (main.cpp)
+void loop();
+
+// Line sensor pins in RawSensorFrame order
+static const uint8_t LINE_PINS[NUM_SENSORES] = {
+    PIN_LINE_LEFT_EDGE, PIN_LINE_LEFT_MID, PIN_LINE_CENTER_LEFT,
+    PIN_LINE_CENTER_RIGHT, PIN_LINE_RIGHT_MID, PIN_LINE_RIGHT_EDGE
+};
+
+void FirmwareHarness::begin(const int16_t* sensorMin, const int16_t* sensorMax) {
+    HostHardware::reset();
+
+    // Markers idle (white) until the first step
+    HostHardware::setAnalog(PIN_MARKER_LEFT, ADC_MAX_VALUE);
+    HostHardware::setAnalog(PIN_MARKER_RIGHT, ADC_MAX_VALUE);
+
+    // Same path as setup() after a boot with stored calibration, which
+    // holds sensor counts of the acquisition mode
+    int16_t storedMin[NUM_SENSORES], storedMax[NUM_SENSORES];
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        storedMin[i] = sensorMin[i] >> SENSOR_ADC_SHIFT;
+        storedMax[i] = sensorMax[i] >> SENSOR_ADC_SHIFT;
+    }
+    CalibrationStore::save(storedMin, storedMax);
+    initializeControl();
+    Sensors::loadCalibration();
+    startRun();
+}
+
+void FirmwareHarness::step(uint32_t timestamp, const int16_t* line,
+    int16_t markerLeft, int16_t markerRight) {
+    HostHardware::setMicros(timestamp);
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        HostHardware::setAnalog(LINE_PINS[i], line[i]);
+    }
+    HostHardware::setAnalog(PIN_MARKER_LEFT, markerLeft);
+    HostHardware::setAnalog(PIN_MARKER_RIGHT, markerRight);
+
+    loop();
+}
@@ -0,0 +1,20 @@
+#ifndef FIRMWAREHARNESS_H
+#define FIRMWAREHARNESS_H
+
+#include <stdint.h>
+
+// Drives the real setup path and loop() of the firmware on the host.
+// Firmware state is static, so use one harness run per process.
+// Sensor values and calibration are 10-bit ADC counts, the firmware's
+// acquisition mode (SENSOR_ADC_BITS) is applied on the way in.
+class FirmwareHarness {
+public:
+    // Reset the simulated hardware, store calibration and start a run
+    static void begin(const int16_t* sensorMin, const int16_t* sensorMax);
+
+    // Run one loop() iteration with the given inputs at the given time
+    static void step(uint32_t timestamp, const int16_t* line,
+        int16_t markerLeft, int16_t markerRight);
+};
+
+#endif // FIRMWAREHARNESS_H
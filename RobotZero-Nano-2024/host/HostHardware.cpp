@@ -0,0 +1,190 @@
+#include "HostHardware.h"
+#include "config.h"
+#include <EEPROM.h>
+#include <avr/boot.h>
+#include <deque>
+#include <random>
+
+// Arduino globals
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+uint8_t SREG = 0;
+
+// Conversion noise source
+static std::mt19937 noiseSource;
+
+// Received bytes not yet read, capacity as SERIAL_RX_BUFFER_SIZE - 1
+static std::deque<uint8_t> serialInput;
+static const size_t SERIAL_INPUT_CAPACITY = 63;
+
+// Emulated non-volatile memories
+static uint8_t flashMemory[FLASHEND + 1];
+static uint8_t eepromMemory[E2END + 1];
+
+// Static member initialization
+uint32_t HostHardware::nowMicros = 0;
+int16_t HostHardware::analogInputs[NUM_HOST_PINS];
+uint8_t HostHardware::digitalInputs[NUM_HOST_PINS];
+uint8_t HostHardware::digitalOutputs[NUM_HOST_PINS];
+int16_t HostHardware::pwmOutputs[NUM_HOST_PINS];
+uint32_t HostHardware::adcConversions = 0;
+float HostHardware::analogNoise = 0.0f;
+void (*HostHardware::serialSink)(uint8_t) = nullptr;
+
+void HostHardware::reset() {
+    nowMicros = 0;
+    memset(analogInputs, 0, sizeof(analogInputs));
+    memset(digitalInputs, 0, sizeof(digitalInputs));
+    memset(digitalOutputs, 0, sizeof(digitalOutputs));
+    memset(pwmOutputs, 0, sizeof(pwmOutputs));
+    adcConversions = 0;
+    analogNoise = 0.0f;
+    serialInput.clear();
+    memset(flashMemory, 0xFF, sizeof(flashMemory));
+    memset(eepromMemory, 0xFF, sizeof(eepromMemory));
+}
+
+void HostHardware::setMicros(uint32_t us) {
+    nowMicros = us;
+}
+
+void HostHardware::advanceMicros(uint32_t us) {
+    nowMicros += us;
+}
+
+void HostHardware::setAnalog(uint8_t pin, int16_t value) {
+    analogInputs[pin] = value;
+}
+
+void HostHardware::setDigital(uint8_t pin, uint8_t value) {
+    digitalInputs[pin] = value;
+}
+
+int16_t HostHardware::getLeftPower() {
+    return motorPower(PIN_MOTOR_LEFT_FWD, PIN_MOTOR_LEFT_REV, PIN_MOTOR_LEFT_PWM);
+}
+
+int16_t HostHardware::getRightPower() {
+    return motorPower(PIN_MOTOR_RIGHT_FWD, PIN_MOTOR_RIGHT_REV, PIN_MOTOR_RIGHT_PWM);
+}
+
+void HostHardware::setSerialSink(void (*sink)(uint8_t)) {
+    serialSink = sink;
+}
+
+size_t HostHardware::pushSerialInput(const uint8_t* data, size_t size) {
+    size_t accepted = min(size, getSerialInputRoom());
+    serialInput.insert(serialInput.end(), data, data + accepted);
+    return accepted;
+}
+
+size_t HostHardware::getSerialInputRoom() {
+    return SERIAL_INPUT_CAPACITY - serialInput.size();
+}
+
+void HostHardware::setAnalogNoise(float sigma, uint32_t seed) {
+    analogNoise = sigma;
+    noiseSource.seed(seed);
+}
+
+uint32_t HostHardware::getAdcConversions() {
+    return adcConversions;
+}
+
+int16_t HostHardware::motorPower(uint8_t fwd, uint8_t rev, uint8_t pwm) {
+    if (digitalOutputs[fwd] && !digitalOutputs[rev]) return pwmOutputs[pwm];
+    if (digitalOutputs[rev] && !digitalOutputs[fwd]) return -pwmOutputs[pwm];
+    return 0;
+}
+
+// Arduino core
+unsigned long micros() {
+    return HostHardware::nowMicros;
+}
+
+unsigned long millis() {
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+    HostHardware::advanceMicros(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    HostHardware::advanceMicros(us);
+}
+
+int analogRead(uint8_t pin) {
+    HostHardware::adcConversions++;
+    if (HostHardware::analogNoise <= 0.0f) return HostHardware::analogInputs[pin];
+
+    std::normal_distribution<float> noise(0.0f, HostHardware::analogNoise);
+    float value = HostHardware::analogInputs[pin] + noise(noiseSource);
+    return constrain((int)lroundf(value), 0, (int)ADC_MAX_VALUE);
+}
+
+void analogWrite(uint8_t pin, int value) {
+    HostHardware::pwmOutputs[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+    return HostHardware::digitalInputs[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    HostHardware::digitalOutputs[pin] = value ? HIGH : LOW;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    if (HostHardware::serialSink) HostHardware::serialSink(value);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) write(data[i]);
+    return size;
+}
+
+int HardwareSerial::availableForWrite() {
+    return 63;
+}
+
+int HardwareSerial::available() {
+    return serialInput.size();
+}
+
+int HardwareSerial::read() {
+    if (serialInput.empty()) return -1;
+
+    uint8_t value = serialInput.front();
+    serialInput.pop_front();
+    return value;
+}
+
+// Flash and EEPROM
+uint8_t pgm_read_byte(uint32_t address) {
+    return flashMemory[address & FLASHEND];
+}
+
+void boot_page_erase(uint32_t address) {
+    memset(&flashMemory[address & FLASHEND & ~(SPM_PAGESIZE - 1)], 0xFF, SPM_PAGESIZE);
+}
+
+void boot_page_fill(uint32_t address, uint16_t word) {
+    // Written straight through, the page buffer is not modelled
+    flashMemory[address & FLASHEND] = word & 0xFF;
+    flashMemory[(address + 1) & FLASHEND] = word >> 8;
+}
+
+void boot_page_write(uint32_t address) {
+    (void)address;
+}
+
+uint8_t* EEPROMClass::data() {
+    return eepromMemory;
+}
@@ -0,0 +1,59 @@
+#ifndef HOSTHARDWARE_H
+#define HOSTHARDWARE_H
+
+#include <Arduino.h>
+
+// Simulated ATmega328P peripherals for host builds of the firmware.
+// Time only moves when the harness advances it.
+class HostHardware {
+public:
+    // Clear time, pins, flash and EEPROM
+    static void reset();
+
+    // Virtual clock
+    static void setMicros(uint32_t us);
+    static void advanceMicros(uint32_t us);
+
+    // Inputs seen by the firmware
+    static void setAnalog(uint8_t pin, int16_t value);
+    static void setDigital(uint8_t pin, uint8_t value);
+
+    // Gaussian noise added to every ADC conversion (10-bit counts, 0 = off)
+    static void setAnalogNoise(float sigma, uint32_t seed);
+
+    // Motor commands reconstructed from direction pins and PWM
+    static int16_t getLeftPower();
+    static int16_t getRightPower();
+
+    // Serial output sink (nullptr discards)
+    static void setSerialSink(void (*sink)(uint8_t));
+
+    // Serial input, held like the core's 64 byte RX ring: returns the
+    // number of bytes accepted, the rest would be lost on the UART
+    static size_t pushSerialInput(const uint8_t* data, size_t size);
+    static size_t getSerialInputRoom();
+
+    // ADC conversions started since reset()
+    static uint32_t getAdcConversions();
+
+private:
+    friend unsigned long micros();
+    friend int analogRead(uint8_t pin);
+    friend void analogWrite(uint8_t pin, int value);
+    friend int digitalRead(uint8_t pin);
+    friend void digitalWrite(uint8_t pin, uint8_t value);
+    friend class HardwareSerial;
+
+    static uint32_t nowMicros;
+    static int16_t analogInputs[NUM_HOST_PINS];
+    static uint8_t digitalInputs[NUM_HOST_PINS];
+    static uint8_t digitalOutputs[NUM_HOST_PINS];
+    static int16_t pwmOutputs[NUM_HOST_PINS];
+    static uint32_t adcConversions;
+    static float analogNoise;
+    static void (*serialSink)(uint8_t);
+
+    static int16_t motorPower(uint8_t fwd, uint8_t rev, uint8_t pwm);
+};
+
+#endif // HOSTHARDWARE_H
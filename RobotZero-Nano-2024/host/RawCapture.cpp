@@ -0,0 +1,60 @@
+#include "RawCapture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool RawCapture::load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[256];
+    bool ok = true;
+    frames.clear();
+
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '\n' || strncmp(line, "timestamp_us", 12) == 0) continue;
+
+        // "# lost N" comments mark sequence gaps
+        if (line[0] == '#') {
+            unsigned lost;
+            if (sscanf(line, "# lost %u", &lost) == 1) lostFrames += lost;
+            continue;
+        }
+
+        if (strncmp(line, "calibration,", 12) == 0) {
+            int v[12];
+            if (sscanf(line + 12, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+                &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
+                &v[6], &v[7], &v[8], &v[9], &v[10], &v[11]) != 12) {
+                ok = false;
+                break;
+            }
+            for (int i = 0; i < 6; i++) {
+                sensorMin[i] = v[i];
+                sensorMax[i] = v[6 + i];
+            }
+            hasCalibration = true;
+            continue;
+        }
+
+        unsigned long timestamp;
+        int v[10];
+        if (sscanf(line, "%lu,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d", &timestamp,
+            &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9]) != 11) {
+            ok = false;
+            break;
+        }
+
+        RawCaptureFrame frame;
+        frame.timestamp = timestamp;
+        for (int i = 0; i < 6; i++) frame.line[i] = v[i];
+        frame.markerLeft = v[6];
+        frame.markerRight = v[7];
+        frame.leftPower = v[8];
+        frame.rightPower = v[9];
+        frames.push_back(frame);
+    }
+
+    fclose(file);
+    return ok && hasCalibration;
+}
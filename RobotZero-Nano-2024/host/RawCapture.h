@@ -0,0 +1,30 @@
+#ifndef RAWCAPTURE_H
+#define RAWCAPTURE_H
+
+#include <stdint.h>
+#include <vector>
+
+// One loop iteration as recorded by Telemetry::sendRawFrame
+struct RawCaptureFrame {
+    uint32_t timestamp;     // micros() at loop start
+    int16_t line[6];        // Raw line sensors, left edge first
+    int16_t markerLeft;
+    int16_t markerRight;
+    int16_t leftPower;      // Recorded motor commands
+    int16_t rightPower;
+};
+
+// Capture file written by tools/telemetry_receiver.py --raw-csv
+class RawCapture {
+public:
+    int16_t sensorMin[6];
+    int16_t sensorMax[6];
+    bool hasCalibration = false;
+    uint32_t lostFrames = 0;    // Gaps reported by the receiver
+    std::vector<RawCaptureFrame> frames;
+
+    // Parse a capture file, returns false on I/O or format errors
+    bool load(const char* path);
+};
+
+#endif // RAWCAPTURE_H
@@ -0,0 +1,129 @@
+// Line sensor acquisition benchmark for the SENSOR_ADC_BITS modes.
+//
+//   adcbench [--seconds N] [--noise sigma]
+//
+// Build once per mode (pio run -e adcbench, pio run -e adcbench10) and
+// compare. Runs loop() over a straight for --seconds of simulated time and
+// reports the ADC conversions per control cycle with their conversion time
+// at the mode's prescaler (ADC_CONVERSION_US), then sweeps the line between
+// the outer sensors in 0.05 mm steps and counts the distinct line positions
+// the firmware resolves. Last, it adds --noise (10-bit counts) to every
+// conversion and runs in precision mode, where the control budget allows
+// oversampling, and prints the noise floor the firmware reports per sensor.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <set>
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "Sensors.h"
+#include "config.h"
+#include "globals.h"
+
+// Same sensor model and calibration as the golden scenarios
+static const float SENSOR_POSITION_MM[NUM_SENSORES] = { -30.0f, -15.0f, -8.0f, 8.0f, 15.0f, 30.0f };
+static const float SENSOR_SPREAD_MM = 12.0f;
+static const int16_t WHITE = 900;
+static const int16_t BLACK = 100;
+
+static const uint8_t LINE_PINS[NUM_SENSORES] = {
+    PIN_LINE_LEFT_EDGE, PIN_LINE_LEFT_MID, PIN_LINE_CENTER_LEFT,
+    PIN_LINE_CENTER_RIGHT, PIN_LINE_RIGHT_MID, PIN_LINE_RIGHT_EDGE
+};
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void lineAt(float position, int16_t* line) {
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        float distance = (position - SENSOR_POSITION_MM[i]) / SENSOR_SPREAD_MM;
+        line[i] = WHITE - int16_t(expf(-distance * distance) * (WHITE - BLACK));
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t simulatedSeconds = 2;
+    float noise = 4.0f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) simulatedSeconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) noise = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--seconds N] [--noise sigma]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int16_t sensorMin[NUM_SENSORES], sensorMax[NUM_SENSORES];
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        sensorMin[i] = BLACK;
+        sensorMax[i] = WHITE;
+    }
+    FirmwareHarness::begin(sensorMin, sensorMax);
+
+    // Conversions per control cycle on a straight, one loop() per period
+    int16_t line[NUM_SENSORES];
+    lineAt(0.0f, line);
+    uint32_t cycles = simulatedSeconds * (1000000 / TASK_PERIOD_CONTROL_US);
+    uint32_t before = HostHardware::getAdcConversions();
+    double start = seconds();
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        FirmwareHarness::step((cycle + 1) * TASK_PERIOD_CONTROL_US, line, ADC_MAX_VALUE, ADC_MAX_VALUE);
+    }
+    double elapsed = seconds() - start;
+
+    float perCycle = float(HostHardware::getAdcConversions() - before) / cycles;
+    float adcUs = perCycle * ADC_CONVERSION_US;
+    float sweepUs = NUM_SENSORES * ADC_CONVERSION_US;
+
+    printf("mode:        %d-bit line sensors, ADC clk/%u, %u us per conversion\n",
+        SENSOR_ADC_BITS, ADC_PRESCALER, ADC_CONVERSION_US);
+    printf("conversions: %.2f per control cycle (line and marker sensors)\n", perCycle);
+    printf("adc time:    %.0f us per %u us control period (%.0f%%)\n",
+        adcUs, TASK_PERIOD_CONTROL_US, 100.0f * adcUs / TASK_PERIOD_CONTROL_US);
+    printf("line sweep:  %.0f us, up to %.0f sweeps/s\n", sweepUs, 1e6f / sweepUs);
+    printf("host:        %.3g loop() calls/s\n", cycles / elapsed);
+
+    // Resolution: distinct positions while the line crosses the array
+    std::set<int16_t> positions;
+    int16_t previous = 0;
+    int maxStep = 0;
+    for (int step = 0; step <= 1200; step++) {
+        float position = -30.0f + step * 0.05f;
+        lineAt(position, line);
+        for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+            HostHardware::setAnalog(LINE_PINS[i], line[i]);
+        }
+
+        int16_t linePosition = Sensors::calculateLinePosition();
+        if (step > 0) maxStep = max(maxStep, abs(linePosition - previous));
+        previous = linePosition;
+        positions.insert(linePosition);
+    }
+
+    printf("resolution:  %zu distinct positions over +/-30 mm, largest step %d\n",
+        positions.size(), maxStep);
+
+    // Precision mode with conversion noise: oversampling and noise floor
+    HostHardware::setAnalogNoise(noise, 1);
+    Sensors::resetStatistics();
+    isPrecisionMode = true;
+    lineAt(0.0f, line);
+    uint32_t startTime = cycles * TASK_PERIOD_CONTROL_US;
+    before = HostHardware::getAdcConversions();
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        FirmwareHarness::step(startTime + (cycle + 1) * TASK_PERIOD_CONTROL_US, line,
+            ADC_MAX_VALUE, ADC_MAX_VALUE);
+    }
+
+    printf("precision:   %.2f conversions per control cycle\n",
+        float(HostHardware::getAdcConversions() - before) / cycles);
+    printf("noise floor:");
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) printf(" %.2f", Sensors::getNoiseFloor(i));
+    printf(" counts (input sigma %.2f)\n", noise);
+    return 0;
+}
@@ -0,0 +1,326 @@
+// Columnar session archive: build once from FlashReader dumps, query in place.
+//
+//   archive build <out.rza> <dump or directory>... [--block N]
+//   archive info <file.rza>
+//   archive query <file.rza> [term...] [--limit N]
+//
+// A query term is <field><op><value> with op one of < <= > >= = !=.
+// Session fields (from the session index):
+//   mode (analysis, speed, normal), kp, kd, filter, speed, laps
+// Lap fields (per complete lap, from the block statistics and events):
+//   deviation  max |linePosition|     error  max |error|
+//   correction max |correction|       time   lap time (s)
+// Example, speed runs with a high Kd that stayed close to the line:
+//   archive query season.rza mode=speed "kd>600" "deviation<40"
+// Sessions that fail a session term are skipped with all their blocks; lap
+// extremes come from block min/max, the record columns of a lap are read
+// only to report its mean motor command.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "SessionArchive.h"
+#include "SessionLog.h"
+
+enum class Field : uint8_t {
+    MODE, KP, KD, FILTER, SPEED, LAPS,                  // Session fields
+    DEVIATION, ERROR, CORRECTION, TIME                  // Lap fields
+};
+
+enum class Op : uint8_t { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL };
+
+struct Term {
+    Field field;
+    Op op;
+    double value;
+};
+
+static const struct {
+    const char* name;
+    Field field;
+} FIELD_NAMES[] = {
+    { "mode", Field::MODE }, { "kp", Field::KP }, { "kd", Field::KD }, { "filter", Field::FILTER },
+    { "speed", Field::SPEED }, { "laps", Field::LAPS }, { "deviation", Field::DEVIATION },
+    { "error", Field::ERROR }, { "correction", Field::CORRECTION }, { "time", Field::TIME }
+};
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static const char* modeName(DebugMode mode) {
+    return mode == DebugMode::SPEED ? "speed" : mode == DebugMode::ANALYSIS ? "analysis" : "normal";
+}
+
+static bool isLapField(Field field) {
+    return field >= Field::DEVIATION;
+}
+
+static bool parseTerm(const char* text, Term& term) {
+    size_t nameLength = strcspn(text, "<>=!");
+    const char* op = text + nameLength;
+    bool found = false;
+    for (const auto& entry : FIELD_NAMES) {
+        if (strlen(entry.name) == nameLength && strncmp(text, entry.name, nameLength) == 0) {
+            term.field = entry.field;
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    const char* value;
+    if (strncmp(op, "<=", 2) == 0) { term.op = Op::LESS_EQUAL; value = op + 2; }
+    else if (strncmp(op, ">=", 2) == 0) { term.op = Op::GREATER_EQUAL; value = op + 2; }
+    else if (strncmp(op, "!=", 2) == 0) { term.op = Op::NOT_EQUAL; value = op + 2; }
+    else if (*op == '<') { term.op = Op::LESS; value = op + 1; }
+    else if (*op == '>') { term.op = Op::GREATER; value = op + 1; }
+    else if (*op == '=') { term.op = Op::EQUAL; value = op + 1; }
+    else return false;
+
+    if (term.field == Field::MODE) {
+        if (strcmp(value, "speed") == 0) term.value = double(DebugMode::SPEED);
+        else if (strcmp(value, "analysis") == 0) term.value = double(DebugMode::ANALYSIS);
+        else if (strcmp(value, "normal") == 0) term.value = double(DebugMode::NORMAL);
+        else return false;
+        return term.op == Op::EQUAL || term.op == Op::NOT_EQUAL;
+    }
+
+    char* end;
+    term.value = strtod(value, &end);
+    return end != value && *end == '\0';
+}
+
+static bool compare(double value, const Term& term) {
+    switch (term.op) {
+        case Op::LESS: return value < term.value;
+        case Op::LESS_EQUAL: return value <= term.value;
+        case Op::GREATER: return value > term.value;
+        case Op::GREATER_EQUAL: return value >= term.value;
+        case Op::EQUAL: return value == term.value;
+        case Op::NOT_EQUAL: return value != term.value;
+    }
+    return false;
+}
+
+static double sessionValue(const ArchiveSession& session, Field field) {
+    switch (field) {
+        case Field::MODE: return double(session.mode);
+        case Field::KP: return session.pidKp;
+        case Field::KD: return session.pidKd;
+        case Field::FILTER: return session.filterAlpha;
+        case Field::SPEED: return session.configuredSpeed;
+        default: return session.lapCount;
+    }
+}
+
+static int32_t maxMagnitude(const ArchiveBlock& block, ArchiveColumn column) {
+    return std::max(std::abs(block.minimum[column]), std::abs(block.maximum[column]));
+}
+
+static int build(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    const char* out = nullptr;
+    uint32_t blockSize = ARCHIVE_BLOCK_SIZE;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) blockSize = atoi(argv[++i]);
+        else if (!out) out = argv[i];
+        else inputs.push_back(argv[i]);
+    }
+    if (!out || inputs.empty()) {
+        fprintf(stderr, "usage: archive build <out.rza> <dump or directory>... [--block N]\n");
+        return 2;
+    }
+
+    double start = seconds();
+    std::vector<std::string> paths;
+    SessionLog::collectDumps(inputs, paths);
+
+    ArchiveWriter writer(blockSize);
+    SessionLog log;
+    uint32_t unreadable = 0;
+    for (const std::string& path : paths) {
+        if (!log.load(path.c_str())) {
+            fprintf(stderr, "%s: not a session dump\n", path.c_str());
+            unreadable++;
+            continue;
+        }
+        writer.add(path.c_str(), log);
+    }
+    if (!writer.write(out)) {
+        fprintf(stderr, "cannot write %s\n", out);
+        return 1;
+    }
+    printf("%s: %zu sessions (%u unreadable), %zu records in %.0f ms\n", out,
+        writer.getSessionCount(), unreadable, writer.getRecordCount(), (seconds() - start) * 1e3);
+    return 0;
+}
+
+static int info(int argc, char** argv) {
+    SessionArchive archive;
+    if (argc != 1 || !archive.open(argv[0])) {
+        fprintf(stderr, argc != 1 ? "usage: archive info <file.rza>\n" : "%s: not an archive\n", argv[0]);
+        return argc != 1 ? 2 : 1;
+    }
+
+    const ArchiveHeader& header = archive.getHeader();
+    printf("%s: version %u, %llu bytes\n", argv[0], header.version, (unsigned long long)header.fileSize);
+    printf("  %u sessions, %u blocks (up to %u records), %u records, %u events\n", header.sessionCount,
+        header.blockCount, header.blockSize, header.recordCount, header.eventCount);
+
+    uint32_t laps = 0;
+    for (uint32_t s = 0; s < header.sessionCount; s++) laps += archive.getSessions()[s].lapCount;
+    printf("  %u complete laps\n", laps);
+    return 0;
+}
+
+static int query(int argc, char** argv) {
+    const char* path = nullptr;
+    uint32_t limit = 20;
+    std::vector<Term> sessionTerms, lapTerms;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = atoi(argv[++i]);
+            continue;
+        }
+        if (!path) {
+            path = argv[i];
+            continue;
+        }
+        Term term;
+        if (!parseTerm(argv[i], term)) {
+            fprintf(stderr, "bad term %s\n", argv[i]);
+            return 2;
+        }
+        (isLapField(term.field) ? lapTerms : sessionTerms).push_back(term);
+    }
+    if (!path) {
+        fprintf(stderr, "usage: archive query <file.rza> [term...] [--limit N]\n");
+        return 2;
+    }
+
+    double start = seconds();
+    SessionArchive archive;
+    if (!archive.open(path)) {
+        fprintf(stderr, "%s: not an archive\n", path);
+        return 1;
+    }
+    double opened = seconds();
+
+    const ArchiveHeader& header = archive.getHeader();
+    const ArchiveSession* sessions = archive.getSessions();
+    const ArchiveBlock* blocks = archive.getBlocks();
+    const uint8_t* speedLeft = archive.getColumn<uint8_t>(COLUMN_SPEED_LEFT);
+    const uint8_t* speedRight = archive.getColumn<uint8_t>(COLUMN_SPEED_RIGHT);
+
+    struct Match {
+        uint32_t session;
+        uint32_t lap;
+        float time;
+        int32_t deviation;
+        int32_t error;
+        float meanPwm;
+    };
+    std::vector<Match> matches;
+    uint32_t sessionsMatched = 0, lapsTotal = 0;
+    uint32_t blocksSkipped = 0, blocksStatistics = 0, blocksScanned = 0;
+    std::vector<uint32_t> finishes;
+
+    struct LapSummary {
+        int32_t deviation = 0, error = 0, correction = 0;
+        uint32_t firstBlock = 0, blockCount = 0;
+    };
+    std::vector<LapSummary> summaries;
+
+    for (uint32_t s = 0; s < header.sessionCount; s++) {
+        const ArchiveSession& session = sessions[s];
+        lapsTotal += session.lapCount;
+
+        bool selected = true;
+        for (const Term& term : sessionTerms) selected = selected && compare(sessionValue(session, term.field), term);
+        if (!selected || session.lapCount == 0) {
+            blocksSkipped += session.blockCount;
+            continue;
+        }
+        sessionsMatched++;
+
+        // Lap extremes from the statistics of the lap's blocks
+        summaries.assign(session.lapCount + 1, LapSummary());
+        for (uint32_t b = session.blockBegin; b < session.blockBegin + session.blockCount; b++) {
+            const ArchiveBlock& block = blocks[b];
+            LapSummary& summary = summaries[block.lap];
+            if (summary.blockCount == 0) summary.firstBlock = b;
+            summary.blockCount++;
+            if (block.lap == 0) continue;
+            summary.deviation = std::max(summary.deviation, maxMagnitude(block, COLUMN_LINE_POSITION));
+            summary.error = std::max(summary.error, maxMagnitude(block, COLUMN_ERROR));
+            summary.correction = std::max(summary.correction, maxMagnitude(block, COLUMN_CORRECTION));
+            blocksStatistics++;
+        }
+        blocksSkipped += summaries[0].blockCount;
+
+        archive.getFinishTimes(session, finishes);
+        for (uint32_t lap = 1; lap <= session.lapCount; lap++) {
+            const LapSummary& summary = summaries[lap];
+            float time = (finishes[lap] - finishes[lap - 1]) * 1e-3f;
+            bool match = true;
+            for (const Term& term : lapTerms) {
+                double value = term.field == Field::DEVIATION ? summary.deviation :
+                    term.field == Field::ERROR ? summary.error :
+                    term.field == Field::CORRECTION ? summary.correction : time;
+                match = match && compare(value, term);
+            }
+            if (!match) continue;
+
+            // Mean motor command from the record columns of the lap
+            uint64_t sum = 0, count = 0;
+            for (uint32_t b = summary.firstBlock; b < summary.firstBlock + summary.blockCount; b++) {
+                const ArchiveBlock& block = blocks[b];
+                if (block.lap != lap) continue;
+                for (uint32_t row = block.begin; row < block.begin + block.count; row++) {
+                    sum += speedLeft[row] + speedRight[row];
+                }
+                count += 2 * block.count;
+                blocksScanned++;
+            }
+            matches.push_back({ s, lap, time, summary.deviation, summary.error,
+                count ? float(sum) / count : 0.0f });
+        }
+    }
+    double finished = seconds();
+
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.time < b.time; });
+    printf("%-32s %3s %-8s %5s %4s %7s %5s %5s %5s\n", "session", "lap", "mode", "kp", "kd", "time s",
+        "dev", "err", "pwm");
+    for (size_t i = 0; i < matches.size() && i < limit; i++) {
+        const Match& match = matches[i];
+        const ArchiveSession& session = sessions[match.session];
+        printf("%-32s %3u %-8s %5.2f %4.0f %7.3f %5d %5d %5.1f\n", session.name, match.lap,
+            modeName(session.mode), (double)session.pidKp, (double)session.pidKd, match.time,
+            match.deviation, match.error, match.meanPwm);
+    }
+    if (matches.size() > limit) printf("... %zu more\n", matches.size() - limit);
+
+    printf("\n%zu of %u laps in %u of %u sessions\n", matches.size(), lapsTotal, sessionsMatched,
+        header.sessionCount);
+    printf("blocks: %u skipped, %u from statistics, %u scanned of %u\n", blocksSkipped, blocksStatistics,
+        blocksScanned, header.blockCount);
+    printf("open %.2f ms, query %.2f ms\n", (opened - start) * 1e3, (finished - opened) * 1e3);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "build") == 0) return build(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "info") == 0) return info(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "query") == 0) return query(argc - 2, argv + 2);
+
+    fprintf(stderr, "usage: %s build <out.rza> <dump or directory>... [--block N]\n"
+        "       %s info <file.rza>\n"
+        "       %s query <file.rza> [term...] [--limit N]\n", argv[0], argv[0], argv[0]);
+    return 2;
+}
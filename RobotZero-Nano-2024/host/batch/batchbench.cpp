@@ -0,0 +1,237 @@
+// Batch simulation throughput benchmark and firmware equivalence check.
+//
+//   batchbench [--robots N] [--steps N] [--threads N] [--seed N] [--spread F]
+//              [--track file]
+//   batchbench --verify [--steps N] [--track file]
+//
+// The benchmark steps --robots robots with profiles spread +-F around the
+// active profile, split over --threads threads, and reports robot-steps per
+// second. --verify records the sensor inputs of one robot running the
+// firmware profile and feeds them to the real firmware through
+// FirmwareHarness, then checks the motor outputs match step by step.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BatchSim.h"
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "ProfileManager.h"
+#include "globals.h"
+
+struct Options {
+    uint32_t robots = 4096;
+    uint32_t steps = 20000;
+    uint32_t threads = 0;
+    uint32_t seed = 1;
+    float spread = 0.2f;
+    bool verify = false;
+    const char* track = nullptr;
+};
+
+struct StepRecord {
+    int16_t line[NUM_SENSORES];
+    int16_t left;
+    int16_t right;
+    int16_t speed;
+};
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Profile and gains the firmware uses in this build (DEBUG_LEVEL selects them)
+static SpeedProfile activeProfile() {
+    ProfileManager::initialize(DEBUG_LEVEL == 1 ? DebugMode::ANALYSIS : DebugMode::SPEED);
+    return *ProfileManager::getActiveProfile();
+}
+
+static GainSchedule activeGains() {
+    ProfileManager::initialize(DEBUG_LEVEL == 1 ? DebugMode::ANALYSIS : DebugMode::SPEED);
+    GainSchedule gains;
+    memcpy_P(&gains, ProfileManager::getGainSchedule(), sizeof(gains));
+    return gains;
+}
+
+static uint8_t jitter(std::mt19937& random, uint8_t value, float spread, uint8_t low, uint8_t high) {
+    float scaled = value * (1.0f + std::uniform_real_distribution<float>(-spread, spread)(random));
+    return uint8_t(constrain(scaled + 0.5f, float(low), float(high)));
+}
+
+// Random profile around the base, the 16 speed and control fields
+static SpeedProfile drawProfile(std::mt19937& random, const SpeedProfile& base, float spread) {
+    SpeedProfile p = base;
+    uint8_t* speeds[] = { &p.speedStartup, &p.speedTurn, &p.speedBrake, &p.speedCruise,
+        &p.speedSlow, &p.speedFast, &p.speedBoost, &p.speedMax };
+    for (uint8_t* speed : speeds) *speed = jitter(random, *speed, spread, 40, 255);
+    p.accelerationStep = jitter(random, p.accelerationStep, spread, 1, 255);
+    p.brakeStep = jitter(random, p.brakeStep, spread, 1, 255);
+    p.turnSpeed = jitter(random, p.turnSpeed, spread, 40, 255);
+    p.turnThreshold = jitter(random, p.turnThreshold, spread, 20, 90);
+    p.straightThreshold = jitter(random, p.straightThreshold, spread, 2, p.turnThreshold - 1);
+    p.boostDuration = jitter(random, p.boostDuration, spread, 0, 255);
+    p.boostIncrement = jitter(random, p.boostIncrement, spread, 0, 255);
+    return p;
+}
+
+// Gain schedule scaled around the base, one factor per gain
+static GainSchedule drawGains(std::mt19937& random, const GainSchedule& base, float spread) {
+    std::uniform_real_distribution<float> scale(1.0f - spread, 1.0f + spread);
+    float kp = scale(random), kd = scale(random), filter = scale(random);
+    GainSchedule gains = base;
+    for (GainPoint& point : gains.point) {
+        point.kp = uint16_t(constrain(point.kp * kp, 0.0f, 65535.0f));
+        point.kd = uint16_t(constrain(point.kd * kd, 0.0f, 65535.0f));
+        point.filter = uint16_t(constrain(point.filter * filter, 13.0f, 256.0f));
+    }
+    return gains;
+}
+
+static int benchmark(const Options& options, const Track& track) {
+    BatchSim batch(track, options.robots);
+    SpeedProfile base = activeProfile();
+    GainSchedule baseGains = activeGains();
+    std::mt19937 random(options.seed);
+
+    for (uint32_t i = 0; i < options.robots; i++) {
+        RobotModel::Variation variation;
+        variation.sensorNoise = 15.0f;
+        if (i == 0) {
+            batch.setRobot(i, BatchSim::firmwareProfile(base), baseGains, variation, options.seed * 7919u);
+            batch.setOutputLimits(i, base.accelerationStep, base.brakeStep);
+            continue;
+        }
+        SpeedProfile profile = drawProfile(random, base, options.spread);
+        batch.setRobot(i, profile, drawGains(random, baseGains, options.spread), variation,
+            options.seed * 7919u + i);
+    }
+    batch.reset(0.0f);
+
+    uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    uint32_t slice = (options.robots + threads - 1) / threads;
+
+    double start = seconds();
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        uint32_t begin = t * slice;
+        uint32_t end = std::min(options.robots, begin + slice);
+        if (begin >= end) break;
+        workers.emplace_back([&batch, begin, end, &options]() { batch.run(begin, end, options.steps); });
+    }
+    for (std::thread& worker : workers) worker.join();
+    double elapsed = seconds() - start;
+
+    uint32_t finished = 0, lost = 0, best = 0, bestLap = UINT32_MAX;
+    for (uint32_t i = 0; i < options.robots; i++) {
+        if (batch.getStatus(i) == BatchSim::LINE_LOST) lost++;
+        if (batch.getStatus(i) != BatchSim::FINISHED) continue;
+        finished++;
+        if (batch.getLapSteps(i) < bestLap) {
+            bestLap = batch.getLapSteps(i);
+            best = i;
+        }
+    }
+
+    double robotSteps = double(options.robots) * options.steps;
+    printf("robots:      %u x %u steps on %zu threads\n", options.robots, options.steps, workers.size());
+    printf("throughput:  %.3g robot-steps/s (%.2f s, %.0f simulated s per s)\n",
+        robotSteps / elapsed, elapsed, robotSteps * BatchSim::STEP_SECONDS / elapsed);
+    printf("outcome:     %u finished, %u line lost, %u running\n", finished, lost,
+        options.robots - finished - lost);
+    if (finished) {
+        printf("best lap:    robot %u, %.3f s (firmware profile: %s)\n", best,
+            bestLap * BatchSim::STEP_SECONDS,
+            batch.getStatus(0) == BatchSim::FINISHED ? "finished" : "not finished");
+    }
+    return 0;
+}
+
+static int verify(const Options& options, const Track& track) {
+    BatchSim batch(track, 1);
+    RobotModel::Variation variation;
+    variation.sensorNoise = 15.0f;
+    batch.setRobot(0, BatchSim::firmwareProfile(activeProfile()), activeGains(), variation, options.seed);
+    batch.setOutputLimits(0, activeProfile().accelerationStep, activeProfile().brakeStep);
+    batch.reset(0.0f);
+
+    // Batch side: record inputs and outputs of every step
+    std::vector<StepRecord> records(options.steps);
+    for (uint32_t step = 0; step < options.steps; step++) {
+        batch.run(0, 1, 1);
+        StepRecord& record = records[step];
+        for (uint8_t k = 0; k < NUM_SENSORES; k++) record.line[k] = batch.getRawSensor(0, k);
+        record.left = batch.getLeftPower(0);
+        record.right = batch.getRightPower(0);
+        record.speed = batch.getSpeed(0);
+    }
+
+    // Firmware side: same inputs at the control period
+    int16_t sensorMin[NUM_SENSORES], sensorMax[NUM_SENSORES];
+    for (uint8_t k = 0; k < NUM_SENSORES; k++) {
+        sensorMin[k] = RobotModel::SENSOR_MIN;
+        sensorMax[k] = RobotModel::SENSOR_MAX;
+    }
+    FirmwareHarness::begin(sensorMin, sensorMax);
+
+    uint32_t mismatches = 0;
+    double start = seconds();
+    for (uint32_t step = 0; step < options.steps; step++) {
+        const StepRecord& record = records[step];
+        FirmwareHarness::step((step + 1) * TASK_PERIOD_CONTROL_US, record.line,
+            ADC_MAX_VALUE, ADC_MAX_VALUE);
+
+        int16_t left = HostHardware::getLeftPower();
+        int16_t right = HostHardware::getRightPower();
+        if (left != record.left || right != record.right || currentSpeed != record.speed) {
+            if (mismatches < 10) {
+                printf("step %u: batch %d/%d speed %d, firmware %d/%d speed %d\n", step,
+                    record.left, record.right, record.speed, left, right, currentSpeed);
+            }
+            mismatches++;
+        }
+    }
+    double elapsed = seconds() - start;
+
+    printf("verify:      %u steps, %u mismatches (firmware path %.3g steps/s)\n",
+        options.steps, mismatches, options.steps / elapsed);
+    return mismatches ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            options.verify = true;
+            continue;
+        }
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--robots") == 0) options.robots = atoi(value);
+        else if (strcmp(argv[i], "--steps") == 0) options.steps = atoi(value);
+        else if (strcmp(argv[i], "--threads") == 0) options.threads = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = atoi(value);
+        else if (strcmp(argv[i], "--spread") == 0) options.spread = atof(value);
+        else if (strcmp(argv[i], "--track") == 0) options.track = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (options.robots == 0 || options.steps == 0) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+
+    Track track = Track::createDefault();
+    if (options.track && !track.load(options.track)) return 1;
+    return options.verify ? verify(options, track) : benchmark(options, track);
+}
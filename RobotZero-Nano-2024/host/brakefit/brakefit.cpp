@@ -0,0 +1,177 @@
+// Motor model fit for the stop sequence braking profile.
+//
+//   brakefit [--pad-mm N] [--min-pulses N] <capture.csv>...
+//
+// The robot has no encoders, so the speeds come from the course markers:
+// every marker pulse in a raw capture is a pad of known length (--pad-mm,
+// 25 mm by default) crossed in the pulse duration. The motor model of
+// MotorDriver::getSpeedEstimate (speed follows the mean motor command
+// through a first-order lag) runs over the recorded commands for each
+// time constant on a grid; the best fit max speed comes in closed form and
+// the time constant with the lowest rms speed error wins. Prints the
+// MOTOR_MODEL_ lines for config.h.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "RawCapture.h"
+#include "config.h"
+
+struct Options {
+    float padMm = 25.0f;
+    uint32_t minPulses = 8;
+    std::vector<const char*> captures;
+};
+
+// One pad crossing
+struct Pulse {
+    const RawCapture* capture;
+    size_t first;           // Frames under the pad, [first, last)
+    size_t last;
+    float speed;            // Measured, mm/s
+};
+
+struct Fit {
+    uint16_t timeConstant;  // ms
+    float maxSpeed;         // mm/s at full command
+    float rmsError;         // mm/s
+    uint32_t decelerating;  // Pulses with the command below the model speed
+};
+
+static const uint16_t TAU_MIN_MS = 1;
+static const uint16_t TAU_MAX_MS = 300;
+
+static float meanCommand(const RawCaptureFrame& frame) {
+    return (frame.leftPower + frame.rightPower) / (2.0f * 255.0f);
+}
+
+// Marker pulses of one channel, same thresholds as CourseMarkers
+template <typename Reading>
+static void findPulses(const RawCapture& capture, Reading reading, float padMm,
+    std::vector<Pulse>& pulses) {
+    bool dark = false;
+    size_t start = 0;
+    for (size_t i = 0; i < capture.frames.size(); i++) {
+        int16_t value = reading(capture.frames[i]);
+        if (!dark && value <= MARKER_DETECTION_THRESHOLD) {
+            dark = true;
+            start = i;
+        }
+        else if (dark && value >= MARKER_RELEASE_THRESHOLD) {
+            dark = false;
+            uint32_t duration = capture.frames[i].timestamp - capture.frames[start].timestamp;
+            if (duration >= MARKER_MIN_PULSE_US && duration <= MARKER_MAX_PULSE_US) {
+                pulses.push_back({ &capture, start, i, padMm * 1e6f / duration });
+            }
+        }
+    }
+}
+
+// Normalised model speed per frame for one time constant
+static std::vector<float> runModel(const RawCapture& capture, float tauMs) {
+    std::vector<float> model(capture.frames.size());
+    float speed = 0.0f;
+    for (size_t i = 0; i < capture.frames.size(); i++) {
+        if (i > 0) {
+            float dtMs = (capture.frames[i].timestamp - capture.frames[i - 1].timestamp) / 1000.0f;
+            speed += (meanCommand(capture.frames[i - 1]) - speed) * (1.0f - expf(-dtMs / tauMs));
+        }
+        model[i] = speed;
+    }
+    return model;
+}
+
+static Fit fitTimeConstant(const std::vector<RawCapture>& captures,
+    const std::vector<Pulse>& pulses, uint16_t tauMs) {
+    std::vector<std::vector<float>> models;
+    for (const RawCapture& capture : captures) models.push_back(runModel(capture, tauMs));
+
+    // Mean normalised model speed under each pad
+    std::vector<float> predicted(pulses.size());
+    Fit fit = { tauMs, 0.0f, 0.0f, 0 };
+    for (size_t p = 0; p < pulses.size(); p++) {
+        const Pulse& pulse = pulses[p];
+        const std::vector<float>& model = models[pulse.capture - captures.data()];
+        float sum = 0.0f;
+        for (size_t i = pulse.first; i < pulse.last; i++) sum += model[i];
+        predicted[p] = sum / (pulse.last - pulse.first);
+        if (meanCommand(pulse.capture->frames[pulse.first]) < model[pulse.first]) fit.decelerating++;
+    }
+
+    // Least squares max speed: sum(m * p) / sum(p * p)
+    double numerator = 0.0, denominator = 0.0;
+    for (size_t p = 0; p < pulses.size(); p++) {
+        numerator += pulses[p].speed * predicted[p];
+        denominator += predicted[p] * predicted[p];
+    }
+    fit.maxSpeed = denominator > 0.0 ? numerator / denominator : 0.0f;
+
+    double squares = 0.0;
+    for (size_t p = 0; p < pulses.size(); p++) {
+        float error = pulses[p].speed - fit.maxSpeed * predicted[p];
+        squares += error * error;
+    }
+    fit.rmsError = sqrt(squares / pulses.size());
+    return fit;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pad-mm") == 0 && i + 1 < argc) options.padMm = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-pulses") == 0 && i + 1 < argc) options.minPulses = atoi(argv[++i]);
+        else options.captures.push_back(argv[i]);
+    }
+
+    if (options.captures.empty() || options.padMm <= 0.0f) {
+        fprintf(stderr, "usage: %s [--pad-mm N] [--min-pulses N] <capture.csv>...\n", argv[0]);
+        return 2;
+    }
+
+    // Loaded up front, pulses point into the vector
+    std::vector<RawCapture> captures(options.captures.size());
+    for (size_t c = 0; c < captures.size(); c++) {
+        if (!captures[c].load(options.captures[c])) {
+            fprintf(stderr, "cannot read capture %s (missing calibration or bad row)\n",
+                options.captures[c]);
+            return 2;
+        }
+        if (captures[c].lostFrames > 0) {
+            fprintf(stderr, "warning: %s lost %u frames, the model runs across the gaps\n",
+                options.captures[c], captures[c].lostFrames);
+        }
+    }
+
+    std::vector<Pulse> pulses;
+    for (const RawCapture& capture : captures) {
+        findPulses(capture, [](const RawCaptureFrame& f) { return f.markerLeft; }, options.padMm, pulses);
+        findPulses(capture, [](const RawCaptureFrame& f) { return f.markerRight; }, options.padMm, pulses);
+    }
+    if (pulses.size() < options.minPulses) {
+        fprintf(stderr, "%zu marker pulses, need at least %u\n", pulses.size(), options.minPulses);
+        return 1;
+    }
+
+    Fit best = fitTimeConstant(captures, pulses, TAU_MIN_MS);
+    for (uint16_t tau = TAU_MIN_MS + 1; tau <= TAU_MAX_MS; tau++) {
+        Fit fit = fitTimeConstant(captures, pulses, tau);
+        if (fit.rmsError < best.rmsError) best = fit;
+    }
+
+    printf("%zu pulses, %u decelerating, rms error %.0f mm/s\n",
+        pulses.size(), best.decelerating, best.rmsError);
+    if (best.decelerating < options.minPulses / 2) {
+        fprintf(stderr, "warning: few pads crossed while slowing down, "
+            "the time constant is poorly constrained\n");
+    }
+    if (best.timeConstant == TAU_MIN_MS || best.timeConstant == TAU_MAX_MS) {
+        fprintf(stderr, "warning: time constant at the end of the %u-%u ms grid\n",
+            TAU_MIN_MS, TAU_MAX_MS);
+    }
+
+    printf("static constexpr uint16_t MOTOR_MODEL_MAX_SPEED = %.0f;\n", best.maxSpeed);
+    printf("static constexpr uint16_t MOTOR_MODEL_TIME_CONSTANT = %u;\n", best.timeConstant);
+    printf("(currently %u and %u)\n", MOTOR_MODEL_MAX_SPEED, MOTOR_MODEL_TIME_CONSTANT);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Host firmware behind a pseudo terminal, for the serial console.
+//
+//   console [--seconds N]
+//
+// Starts a run on a straight with the golden calibration and steps loop()
+// in real time, 1 ms per control period. The firmware's serial port is the
+// master side of a PTY, the slave path is printed on the first line so
+// tools/robot_console.py (or tools/run_console_check.py) can open it like
+// the robot's USB port. Received bytes go through the 64 byte RX ring
+// model, what does not fit stays in the PTY until the firmware reads.
+// Runs until --seconds of simulated time (0 = until interrupted).
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "config.h"
+
+static const int16_t WHITE = 900;
+static const int16_t BLACK = 100;
+
+// Line centred between the two middle sensors
+static const int16_t LINE_CENTERED[NUM_SENSORES] = { 900, 880, 300, 300, 880, 900 };
+
+static std::vector<uint8_t> serialOutput;
+
+static void collectSerial(uint8_t value) {
+    serialOutput.push_back(value);
+}
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Master side of a raw PTY, the slave stays open so the master keeps
+// working while no client is connected
+static int openTerminal(int& slave) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    if (slave < 0) return -1;
+
+    // Binary frames must pass without echo or line editing
+    struct termios settings;
+    tcgetattr(slave, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slave, TCSANOW, &settings);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return master;
+}
+
+int main(int argc, char** argv) {
+    uint32_t simulatedSeconds = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) simulatedSeconds = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--seconds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int slave;
+    int master = openTerminal(slave);
+    if (master < 0) {
+        fprintf(stderr, "cannot open a pseudo terminal: %s\n", strerror(errno));
+        return 1;
+    }
+    printf("%s\n", ptsname(master));
+    fflush(stdout);
+
+    int16_t sensorMin[NUM_SENSORES], sensorMax[NUM_SENSORES];
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        sensorMin[i] = BLACK;
+        sensorMax[i] = WHITE;
+    }
+    HostHardware::setSerialSink(collectSerial);
+    FirmwareHarness::begin(sensorMin, sensorMax);
+
+    const uint64_t steps = (uint64_t)simulatedSeconds * (1000000 / TASK_PERIOD_CONTROL_US);
+    const double start = seconds();
+    for (uint64_t step = 0; steps == 0 || step < steps; step++) {
+        // Bytes the UART would have received by now
+        uint8_t input[64];
+        size_t room = min(HostHardware::getSerialInputRoom(), sizeof(input));
+        ssize_t received = room ? read(master, input, room) : 0;
+        if (received > 0) HostHardware::pushSerialInput(input, received);
+
+        FirmwareHarness::step((uint32_t)(step + 1) * TASK_PERIOD_CONTROL_US, LINE_CENTERED,
+            ADC_MAX_VALUE, ADC_MAX_VALUE);
+
+        // Whatever the PTY cannot take is lost, like a disconnected port
+        if (!serialOutput.empty()) {
+            ssize_t written = write(master, serialOutput.data(), serialOutput.size());
+            (void)written;
+            serialOutput.clear();
+        }
+
+        // Real time pacing
+        double ahead = (step + 1) * TASK_PERIOD_CONTROL_US * 1e-6 - (seconds() - start);
+        if (ahead > 0) {
+            struct timespec pause = { 0, (long)(ahead * 1e9) };
+            nanosleep(&pause, nullptr);
+        }
+    }
+
+    close(slave);
+    close(master);
+    return 0;
+}
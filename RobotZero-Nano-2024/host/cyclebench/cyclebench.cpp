@@ -0,0 +1,311 @@
+// Cycle counts of the uno firmware under simavr (ATmega328P at 16 MHz).
+//
+//   cyclebench <firmware.elf> [--seconds N] [--baseline file] [--tolerance %]
+//              [--update file]
+//
+// Runs a CYCLE_BENCH build (pio run -e cyclefw) and stubs its pins from the
+// simulator: a stored calibration is preloaded into EEPROM, the start button
+// is pressed once setup() waits for it, the line sensors see a line swaying
+// across the array and the markers stay white. The serial output is dropped
+// and the SPI flash is left unconnected.
+//
+// The firmware marks sections with CYCLE_PROBE_BEGIN/END (src/CycleProbe.h),
+// writes to GPIOR0 and GPIOR1 that are timestamped with the simulator's cycle
+// counter. Measuring starts at the first loop() and runs for --seconds of
+// simulated time; the cost of the probe itself (the empty probe) is removed
+// from every section, nested probes stay in the enclosing section's count.
+// --update writes the mean and worst cycles per section, --baseline compares
+// against such a file and fails when a mean grew by more than --tolerance
+// percent.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <string>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/avr_adc.h>
+#include <simavr/avr_eeprom.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_uart.h>
+#include <util/crc16.h>
+#include "CalibrationStore.h"
+#include "CycleProbe.h"
+#include "config.h"
+
+static const uint32_t CPU_FREQUENCY = 16000000;
+
+// Data space addresses of the probe registers on the ATmega328P
+static const avr_io_addr_t GPIOR0_ADDRESS = 0x3E;
+static const avr_io_addr_t GPIOR1_ADDRESS = 0x4A;
+
+static const char* const PROBE_NAMES[CYCLE_PROBE_COUNT] = {
+    "", "empty", "loop", "control", "calculateLinePosition", "speedControl",
+    "PidController::update", "setMotorsPower", "Logger::logPerformance"
+};
+
+// Same sensor model as the host benchmarks, in 10-bit ADC counts
+static const float SENSOR_POSITION_MM[NUM_SENSORES] = { -30.0f, -15.0f, -8.0f, 8.0f, 15.0f, 30.0f };
+static const float SENSOR_SPREAD_MM = 12.0f;
+static const int16_t WHITE = 900;
+static const int16_t BLACK = 100;
+static const float SWAY_MM = 12.0f;         // Line offset amplitude
+static const float SWAY_PERIOD_S = 0.8f;
+
+static const uint8_t LINE_PINS[NUM_SENSORES] = {
+    PIN_LINE_LEFT_EDGE, PIN_LINE_LEFT_MID, PIN_LINE_CENTER_LEFT,
+    PIN_LINE_CENTER_RIGHT, PIN_LINE_RIGHT_MID, PIN_LINE_RIGHT_EDGE
+};
+
+// Start button press, from when setup() is at the second button wait
+static const float BUTTON_PRESS_S = 1.5f;
+static const float BUTTON_HOLD_S = 0.1f;
+static const float BUTTON_REPEAT_S = 1.0f;
+
+struct Probe {
+    avr_cycle_count_t start = 0;
+    bool open = false;
+    uint64_t calls = 0;
+    uint64_t total = 0;
+    uint64_t minimum = UINT64_MAX;
+    uint64_t maximum = 0;
+};
+
+struct Bench {
+    avr_t* avr = nullptr;
+    bool measuring = false;
+    Probe probes[CYCLE_PROBE_COUNT];
+};
+
+static float secondsAt(avr_t* avr) {
+    return float(avr->cycle) / CPU_FREQUENCY;
+}
+
+static void probeBegin(avr_t* avr, avr_io_addr_t, uint8_t id, void* param) {
+    Bench* bench = static_cast<Bench*>(param);
+    if (id == CYCLE_PROBE_LOOP) bench->measuring = true;
+    if (!bench->measuring || id == 0 || id >= CYCLE_PROBE_COUNT) return;
+    bench->probes[id].start = avr->cycle;
+    bench->probes[id].open = true;
+}
+
+static void probeEnd(avr_t* avr, avr_io_addr_t, uint8_t id, void* param) {
+    Bench* bench = static_cast<Bench*>(param);
+    if (id == 0 || id >= CYCLE_PROBE_COUNT || !bench->probes[id].open) return;
+
+    Probe& probe = bench->probes[id];
+    uint64_t cycles = avr->cycle - probe.start;
+    probe.open = false;
+    probe.calls++;
+    probe.total += cycles;
+    if (cycles < probe.minimum) probe.minimum = cycles;
+    if (cycles > probe.maximum) probe.maximum = cycles;
+}
+
+// The ADC asks for the input of the channel it starts converting
+static void adcTrigger(avr_irq_t*, uint32_t value, void* param) {
+    Bench* bench = static_cast<Bench*>(param);
+    union {
+        avr_adc_mux_t mux;
+        uint32_t value;
+    } event;
+    event.value = value;
+    uint8_t channel = event.mux.src;
+
+    int16_t counts = WHITE;
+    float line = SWAY_MM * sinf(2.0f * float(M_PI) * secondsAt(bench->avr) / SWAY_PERIOD_S);
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        if (LINE_PINS[i] - A0 != channel) continue;
+        float distance = (line - SENSOR_POSITION_MM[i]) / SENSOR_SPREAD_MM;
+        counts = WHITE - int16_t(expf(-distance * distance) * (WHITE - BLACK));
+    }
+
+    uint32_t millivolts = uint32_t(counts) * 5000 / 1023;
+    avr_raise_irq(avr_io_getirq(bench->avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + channel), millivolts);
+}
+
+// Calibration block as CalibrationStore::save writes it
+static void preloadCalibration(avr_t* avr) {
+    CalibrationData data;
+    data.version = CALIBRATION_VERSION;
+    data.adcBits = SENSOR_ADC_BITS;
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        data.sensorMin[i] = BLACK >> SENSOR_ADC_SHIFT;
+        data.sensorMax[i] = WHITE >> SENSOR_ADC_SHIFT;
+    }
+    uint16_t crc = 0xFFFF;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+    for (size_t i = 0; i < sizeof(data) - sizeof(data.crc); i++) crc = _crc16_update(crc, bytes[i]);
+    data.crc = crc;
+
+    avr_eeprom_desc_t eeprom;
+    eeprom.ee = reinterpret_cast<uint8_t*>(&data);
+    eeprom.offset = EEPROM_CALIBRATION_ADDRESS;
+    eeprom.size = sizeof(data);
+    avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &eeprom);
+}
+
+static bool readBaseline(const char* path, std::map<std::string, double>& means) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char line[128], name[64];
+    double mean, worst;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %lf %lf", name, &mean, &worst) == 3) means[name] = mean;
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* firmwarePath = nullptr;
+    const char* baselinePath = nullptr;
+    const char* updatePath = nullptr;
+    float seconds = 2.0f;
+    float tolerance = 2.0f;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strncmp(argv[i], "--", 2) != 0) {
+            firmwarePath = argv[i];
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--seconds") == 0) seconds = atof(value);
+        else if (strcmp(argv[i], "--baseline") == 0) baselinePath = value;
+        else if (strcmp(argv[i], "--tolerance") == 0) tolerance = atof(value);
+        else if (strcmp(argv[i], "--update") == 0) updatePath = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (!firmwarePath || seconds <= 0.0f) {
+        fprintf(stderr, "usage: %s <firmware.elf> [--seconds N] [--baseline file] [--tolerance %%] "
+            "[--update file]\n", argv[0]);
+        return 2;
+    }
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(firmwarePath, &firmware) != 0) {
+        fprintf(stderr, "%s: cannot read firmware\n", firmwarePath);
+        return 1;
+    }
+
+    Bench bench;
+    bench.avr = avr_make_mcu_by_name("atmega328p");
+    if (!bench.avr) {
+        fprintf(stderr, "simavr has no atmega328p core\n");
+        return 1;
+    }
+    avr_t* avr = bench.avr;
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = CPU_FREQUENCY;
+    avr->avcc = 5000;
+    avr->aref = 5000;
+
+    // Pin stubs
+    preloadCalibration(avr);
+    avr_register_io_write(avr, GPIOR0_ADDRESS, probeBegin, &bench);
+    avr_register_io_write(avr, GPIOR1_ADDRESS, probeEnd, &bench);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_OUT_TRIGGER), adcTrigger, &bench);
+    avr_irq_t* button = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), PIN_START_BUTTON - 8);
+
+    uint32_t uartFlags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &uartFlags);
+    uartFlags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &uartFlags);
+
+    // Boot and setup, pressing the button until loop() runs
+    const avr_cycle_count_t setupLimit = avr_cycle_count_t(30) * CPU_FREQUENCY;
+    bool pressed = false;
+    while (!bench.measuring && avr->cycle < setupLimit) {
+        float t = secondsAt(avr);
+        bool press = t >= BUTTON_PRESS_S && fmodf(t - BUTTON_PRESS_S, BUTTON_REPEAT_S) < BUTTON_HOLD_S;
+        if (press != pressed) {
+            avr_raise_irq(button, press ? 1 : 0);
+            pressed = press;
+        }
+        int state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) break;
+    }
+    if (!bench.measuring) {
+        fprintf(stderr, "loop() not reached after %.1f s of simulated time\n", secondsAt(avr));
+        return 1;
+    }
+    if (pressed) avr_raise_irq(button, 0);
+
+    const avr_cycle_count_t start = avr->cycle;
+    const avr_cycle_count_t end = start + avr_cycle_count_t(seconds * CPU_FREQUENCY);
+    while (avr->cycle < end) {
+        int state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) {
+            fprintf(stderr, "firmware stopped at %.3f s\n", secondsAt(avr));
+            return 1;
+        }
+    }
+
+    // Report, probe overhead removed
+    const Probe& empty = bench.probes[CYCLE_PROBE_EMPTY];
+    const uint64_t overhead = empty.calls ? empty.minimum : 0;
+    printf("%.1f s simulated at %u MHz, probe overhead %llu cycles\n\n", seconds,
+        unsigned(CPU_FREQUENCY / 1000000), (unsigned long long)overhead);
+    printf("%-24s %9s %9s %9s %9s %9s\n", "section", "calls", "mean", "min", "max", "mean us");
+
+    std::map<std::string, double> baseline;
+    bool compare = baselinePath != nullptr;
+    if (compare && !readBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "%s: cannot read baseline (record one with --update)\n", baselinePath);
+        return 1;
+    }
+    FILE* update = updatePath ? fopen(updatePath, "w") : nullptr;
+    if (updatePath && !update) {
+        fprintf(stderr, "cannot write %s\n", updatePath);
+        return 1;
+    }
+    if (update) fprintf(update, "# section mean max (cycles), cyclebench --update\n");
+
+    uint32_t regressions = 0;
+    for (uint8_t id = CYCLE_PROBE_LOOP; id < CYCLE_PROBE_COUNT; id++) {
+        const Probe& probe = bench.probes[id];
+        if (probe.calls == 0) {
+            printf("%-24s %9s\n", PROBE_NAMES[id], "not run");
+            continue;
+        }
+        double mean = double(probe.total) / probe.calls - overhead;
+        uint64_t minimum = probe.minimum - overhead;
+        uint64_t maximum = probe.maximum - overhead;
+        printf("%-24s %9llu %9.1f %9llu %9llu %9.2f", PROBE_NAMES[id], (unsigned long long)probe.calls,
+            mean, (unsigned long long)minimum, (unsigned long long)maximum, mean * 1e6 / CPU_FREQUENCY);
+
+        if (compare) {
+            auto entry = baseline.find(PROBE_NAMES[id]);
+            if (entry != baseline.end() && entry->second > 0.0) {
+                double change = (mean - entry->second) / entry->second * 100.0;
+                bool regressed = change > tolerance;
+                regressions += regressed;
+                printf("  %+6.1f%%%s", change, regressed ? "  REGRESSION" : "");
+            }
+            else {
+                printf("  (no baseline)");
+            }
+        }
+        printf("\n");
+        if (update) fprintf(update, "%s %.1f %llu\n", PROBE_NAMES[id], mean, (unsigned long long)maximum);
+    }
+    if (update) fclose(update);
+
+    if (compare) {
+        printf("\n%u of %u sections above the baseline by more than %.1f%%\n", regressions,
+            unsigned(CYCLE_PROBE_COUNT - CYCLE_PROBE_LOOP), tolerance);
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+// Gain schedule fit on the batch simulator.
+//
+//   gainfit [--steps N] [--repeats N] [--threads N] [--seed N] [--noise C]
+//           [--track file]
+//
+// For every gain schedule bucket above speed 0, drives a population of
+// robots around the track at that constant base speed. Each robot runs a
+// candidate Kp/Kd/filter (a grid of scale factors around the active
+// profile's schedule) with --repeats noise seeds per candidate. The
+// candidate with the lowest mean |line error| that never lost the line
+// wins the bucket; bucket 0 copies bucket 1. Prints the table as a
+// GainSchedule initializer for ProfileManager.cpp.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "BatchSim.h"
+#include "ProfileManager.h"
+
+struct Options {
+    uint32_t steps = 10000;
+    uint32_t repeats = 4;
+    uint32_t threads = 0;
+    uint32_t seed = 1;
+    float noise = 15.0f;
+    const char* track = nullptr;
+};
+
+struct Candidate {
+    GainPoint gains;
+    float meanError;
+    uint32_t lost;
+    bool atEdge;      // A scale at the end of its range, widen the grid
+};
+
+// Scale factors tried around the profile's gains
+static const float KP_SCALES[] = { 0.4f, 0.55f, 0.7f, 0.85f, 1.0f, 1.2f, 1.4f, 1.7f };
+static const float KD_SCALES[] = { 0.4f, 0.55f, 0.7f, 0.85f, 1.0f, 1.2f, 1.4f, 1.7f };
+static const float FILTER_SCALES[] = { 0.4f, 0.6f, 0.8f, 1.0f, 1.3f };
+
+static const uint8_t KP_COUNT = sizeof(KP_SCALES) / sizeof(KP_SCALES[0]);
+static const uint8_t KD_COUNT = sizeof(KD_SCALES) / sizeof(KD_SCALES[0]);
+static const uint8_t FILTER_COUNT = sizeof(FILTER_SCALES) / sizeof(FILTER_SCALES[0]);
+
+static uint16_t scaleGain(uint16_t value, float scale, float high) {
+    return uint16_t(constrain(value * scale + 0.5f, 1.0f, high));
+}
+
+// Every speed value at the bucket speed, no turn slowdown or boost
+static SpeedProfile constantSpeedProfile(const SpeedProfile& base, uint8_t speed) {
+    SpeedProfile profile = BatchSim::firmwareProfile(base);
+    profile.speedStop = profile.speedStartup = profile.speedTurn = profile.speedBrake = speed;
+    profile.speedCruise = profile.speedSlow = profile.speedFast = profile.speedBoost = speed;
+    profile.speedMax = speed;
+    profile.turnSpeed = BASE_FAST;
+    profile.boostIncrement = 0;
+    return profile;
+}
+
+static Candidate fitBucket(const Options& options, const Track& track, const SpeedProfile& base,
+    const GainPoint& around, uint8_t speed) {
+    uint32_t candidates = KP_COUNT * KD_COUNT * FILTER_COUNT;
+    uint32_t robots = candidates * options.repeats;
+    BatchSim batch(track, robots);
+    SpeedProfile profile = constantSpeedProfile(base, speed);
+
+    std::vector<GainPoint> points(candidates);
+    for (uint32_t c = 0; c < candidates; c++) {
+        points[c].kp = scaleGain(around.kp, KP_SCALES[c % KP_COUNT], 65535.0f);
+        points[c].kd = scaleGain(around.kd, KD_SCALES[c / KP_COUNT % KD_COUNT], 65535.0f);
+        points[c].filter = scaleGain(around.filter, FILTER_SCALES[c / (KP_COUNT * KD_COUNT)],
+            1 << GAIN_FILTER_FRACTION_BITS);
+
+        // Same gains in every bucket, the robot never changes speed
+        GainSchedule flat;
+        for (GainPoint& point : flat.point) point = points[c];
+
+        for (uint32_t r = 0; r < options.repeats; r++) {
+            RobotModel::Variation variation;
+            variation.sensorNoise = options.noise;
+            batch.setRobot(c * options.repeats + r, profile, flat, variation,
+                options.seed * 7919u + r * 104729u + speed);
+            batch.setOutputLimits(c * options.repeats + r, base.accelerationStep, base.brakeStep);
+        }
+    }
+    batch.reset(0.0f);
+
+    uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    uint32_t slice = (robots + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        uint32_t begin = t * slice;
+        uint32_t end = std::min(robots, begin + slice);
+        if (begin >= end) break;
+        workers.emplace_back([&batch, begin, end, &options]() { batch.run(begin, end, options.steps); });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    // Fewest lost lines first, then the smallest tracking error
+    Candidate best = { points[0], INFINITY, UINT32_MAX, false };
+    for (uint32_t c = 0; c < candidates; c++) {
+        uint32_t kp = c % KP_COUNT, kd = c / KP_COUNT % KD_COUNT, filter = c / (KP_COUNT * KD_COUNT);
+        bool atEdge = kp == 0 || kp == KP_COUNT - 1U || kd == 0 || kd == KD_COUNT - 1U ||
+            filter == 0 || filter == FILTER_COUNT - 1U;
+        Candidate candidate = { points[c], 0.0f, 0, atEdge };
+        for (uint32_t r = 0; r < options.repeats; r++) {
+            uint32_t robot = c * options.repeats + r;
+            candidate.lost += batch.getStatus(robot) == BatchSim::LINE_LOST;
+            candidate.meanError += batch.getMeanError(robot) / options.repeats;
+        }
+        if (candidate.lost < best.lost || (candidate.lost == best.lost && candidate.meanError < best.meanError)) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--steps") == 0) options.steps = atoi(value);
+        else if (strcmp(argv[i], "--repeats") == 0) options.repeats = atoi(value);
+        else if (strcmp(argv[i], "--threads") == 0) options.threads = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = atoi(value);
+        else if (strcmp(argv[i], "--noise") == 0) options.noise = atof(value);
+        else if (strcmp(argv[i], "--track") == 0) options.track = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (options.steps == 0 || options.repeats == 0) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+
+    Track track = Track::createDefault();
+    if (options.track && !track.load(options.track)) return 1;
+
+    ProfileManager::initialize(DEBUG_LEVEL == 1 ? DebugMode::ANALYSIS : DebugMode::SPEED);
+    SpeedProfile base = *ProfileManager::getActiveProfile();
+    GainSchedule current;
+    memcpy_P(&current, ProfileManager::getGainSchedule(), sizeof(current));
+
+    GainSchedule fitted = current;
+    float meanError[GAIN_SCHEDULE_BUCKETS] = {};
+    uint32_t lost[GAIN_SCHEDULE_BUCKETS] = {};
+    for (uint8_t b = 1; b < GAIN_SCHEDULE_BUCKETS; b++) {
+        uint8_t speed = uint8_t(std::min(255, b << GAIN_SCHEDULE_SHIFT));
+        Candidate best = fitBucket(options, track, base, current.point[b], speed);
+        fitted.point[b] = best.gains;
+        meanError[b] = best.meanError;
+        lost[b] = best.lost;
+        fprintf(stderr, "speed %3u: kp %.2f kd %.1f filter %.2f, mean |error| %.2f, %u/%u lost%s\n", speed,
+            best.gains.kp / float(1 << GAIN_KP_FRACTION_BITS), best.gains.kd / float(1 << GAIN_KD_FRACTION_BITS),
+            best.gains.filter / float(1 << GAIN_FILTER_FRACTION_BITS), best.meanError, best.lost,
+            options.repeats, best.atEdge ? " (edge of the search grid)" : "");
+    }
+    fitted.point[0] = fitted.point[1];
+    meanError[0] = meanError[1];
+    lost[0] = lost[1];
+
+    printf("// gainfit: %s profile, %s track, %u steps x %u repeats, noise %.0f\n",
+        DEBUG_LEVEL == 1 ? "analysis" : "speed", options.track ? options.track : "default",
+        options.steps, options.repeats, options.noise);
+    printf("{ {\n");
+    for (uint8_t b = 0; b < GAIN_SCHEDULE_BUCKETS; b++) {
+        printf("    { %5u, %5u, %3u },  // speed %3u: mean |error| %.2f%s\n", fitted.point[b].kp,
+            fitted.point[b].kd, fitted.point[b].filter, std::min(255, b << GAIN_SCHEDULE_SHIFT),
+            meanError[b], lost[b] ? ", lost the line" : "");
+    }
+    printf("} }\n");
+    return 0;
+}
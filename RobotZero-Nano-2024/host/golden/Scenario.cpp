@@ -0,0 +1,105 @@
+#include "Scenario.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Sensor positions (mm), proportional to SENSOR_WEIGHT_S1..S6
+static const float SENSOR_POSITION_MM[6] = { -30.0f, -15.0f, -8.0f, 8.0f, 15.0f, 30.0f };
+static const float SENSOR_SPREAD_MM = 12.0f;
+
+static bool parseMarkers(const char* text, bool& left, bool& right) {
+    left = right = false;
+    if (text[0] == '\0') return true;
+    if (strcmp(text, "L") == 0) left = true;
+    else if (strcmp(text, "R") == 0) right = true;
+    else if (strcmp(text, "LR") == 0) left = right = true;
+    else return false;
+    return true;
+}
+
+bool Scenario::load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open scenario %s\n", path);
+        return false;
+    }
+
+    char text[128];
+    int lineNumber = 0;
+    bool ok = true;
+    segments.clear();
+
+    while (ok && fgets(text, sizeof(text), file)) {
+        lineNumber++;
+        char command[16] = "";
+        char markers[8] = "";
+        unsigned value;
+        float from, to;
+        Segment segment = {};
+
+        if (sscanf(text, "%15s", command) != 1 || command[0] == '#') continue;
+
+        if (strcmp(command, "period") == 0 && sscanf(text, "%*s %u", &value) == 1) {
+            periodUs = value;
+        }
+        else if (strcmp(command, "line") == 0 &&
+            sscanf(text, "%*s %u %f %f %7s", &value, &from, &to, markers) >= 3) {
+            segment.durationUs = value * 1000;
+            segment.lineVisible = true;
+            segment.from = from;
+            segment.to = to;
+            ok = parseMarkers(markers, segment.markerLeft, segment.markerRight);
+            segments.push_back(segment);
+        }
+        else if (strcmp(command, "lost") == 0 &&
+            sscanf(text, "%*s %u %7s", &value, markers) >= 1) {
+            segment.durationUs = value * 1000;
+            ok = parseMarkers(markers, segment.markerLeft, segment.markerRight);
+            segments.push_back(segment);
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, lineNumber, text);
+    }
+
+    fclose(file);
+    return ok;
+}
+
+uint32_t Scenario::getStepCount() const {
+    uint32_t total = 0;
+    for (const Segment& segment : segments) total += segment.durationUs;
+    return total / periodUs;
+}
+
+void Scenario::getInputs(uint32_t step, int16_t* line, int16_t& markerLeft, int16_t& markerRight) const {
+    uint32_t time = step * periodUs;
+    const Segment* segment = &segments.back();
+    uint32_t offset = 0;
+
+    for (const Segment& candidate : segments) {
+        if (time < offset + candidate.durationUs) {
+            segment = &candidate;
+            break;
+        }
+        offset += candidate.durationUs;
+    }
+
+    float progress = segment->durationUs ? float(time - offset) / segment->durationUs : 0.0f;
+    float position = segment->from + (segment->to - segment->from) * progress;
+
+    // Dark line reads low, white floor reads high
+    for (uint8_t i = 0; i < 6; i++) {
+        float coverage = 0.0f;
+        if (segment->lineVisible) {
+            float distance = (position - SENSOR_POSITION_MM[i]) / SENSOR_SPREAD_MM;
+            coverage = expf(-distance * distance);
+        }
+        line[i] = SENSOR_MAX - int16_t(coverage * (SENSOR_MAX - SENSOR_MIN));
+    }
+
+    markerLeft = segment->markerLeft ? SENSOR_MIN : SENSOR_MAX;
+    markerRight = segment->markerRight ? SENSOR_MIN : SENSOR_MAX;
+}
@@ -0,0 +1,42 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdint.h>
+#include <vector>
+
+// Scripted sensor input for golden-trace runs.
+//
+// Script lines (positions in mm from the array centre, + is right):
+//   period <us>                          loop period, default 1000
+//   line <ms> <from> <to> [L|R|LR]       line moving from/to, optional markers
+//   lost <ms> [L|R|LR]                   no line under the array
+//   # comment
+class Scenario {
+public:
+    struct Segment {
+        uint32_t durationUs;
+        bool lineVisible;
+        float from;
+        float to;
+        bool markerLeft;
+        bool markerRight;
+    };
+
+    uint32_t periodUs = 1000;
+    std::vector<Segment> segments;
+
+    // Parse a script, returns false and prints the line on errors
+    bool load(const char* path);
+
+    // Total number of loop iterations
+    uint32_t getStepCount() const;
+
+    // Synthesized raw ADC values for one loop iteration
+    void getInputs(uint32_t step, int16_t* line, int16_t& markerLeft, int16_t& markerRight) const;
+
+    // Calibration used for every scenario
+    static const int16_t SENSOR_MIN = 100;
+    static const int16_t SENSOR_MAX = 900;
+};
+
+#endif // SCENARIO_H
@@ -0,0 +1,164 @@
+// Golden-trace check for control-loop changes.
+//
+// Runs a scripted sensor sequence through setup/loop() and compares the
+// (left_power, right_power, currentSpeed, isPrecisionMode, lapCount)
+// trace with a checked-in golden file.
+//
+//   golden <scenario.txt> <expected.csv> [--tolerance N] [--update]
+//
+// Traces are generated with the host build flags (DEBUG_LEVEL=1, analysis
+// profile). Use --update only when a behavior change is intended.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "Scenario.h"
+#include "globals.h"
+
+struct TraceRow {
+    uint32_t timestamp;
+    int left;
+    int right;
+    int speed;
+    int precision;
+    int laps;
+};
+
+static const char* TRACE_HEADER = "timestamp_us,left_power,right_power,current_speed,precision_mode,lap_count";
+static const int MAX_REPORTED_ROWS = 12;
+
+static void runScenario(const Scenario& scenario, std::vector<TraceRow>& trace) {
+    int16_t sensorMin[6], sensorMax[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        sensorMin[i] = Scenario::SENSOR_MIN;
+        sensorMax[i] = Scenario::SENSOR_MAX;
+    }
+    FirmwareHarness::begin(sensorMin, sensorMax);
+
+    uint32_t steps = scenario.getStepCount();
+    for (uint32_t step = 0; step < steps; step++) {
+        int16_t line[6], markerLeft, markerRight;
+        scenario.getInputs(step, line, markerLeft, markerRight);
+
+        uint32_t timestamp = (step + 1) * scenario.periodUs;
+        FirmwareHarness::step(timestamp, line, markerLeft, markerRight);
+
+        TraceRow row = { timestamp, HostHardware::getLeftPower(), HostHardware::getRightPower(),
+            currentSpeed, isPrecisionMode ? 1 : 0, lapCount };
+        trace.push_back(row);
+    }
+}
+
+static bool writeTrace(const char* path, const std::vector<TraceRow>& trace) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "%s\n", TRACE_HEADER);
+    for (const TraceRow& row : trace) {
+        fprintf(file, "%u,%d,%d,%d,%d,%d\n", row.timestamp, row.left, row.right,
+            row.speed, row.precision, row.laps);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool readTrace(const char* path, std::vector<TraceRow>& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char text[128];
+    while (fgets(text, sizeof(text), file)) {
+        TraceRow row;
+        if (sscanf(text, "%u,%d,%d,%d,%d,%d", &row.timestamp, &row.left, &row.right,
+            &row.speed, &row.precision, &row.laps) == 6) {
+            trace.push_back(row);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// Prints a side-by-side diff of differing rows, returns the mismatch count
+static size_t compareTraces(const std::vector<TraceRow>& expected,
+    const std::vector<TraceRow>& actual, int tolerance) {
+    size_t mismatches = 0;
+    size_t rows = min(expected.size(), actual.size());
+
+    for (size_t i = 0; i < rows; i++) {
+        const TraceRow& e = expected[i];
+        const TraceRow& a = actual[i];
+        bool differs = abs(e.left - a.left) > tolerance || abs(e.right - a.right) > tolerance ||
+            abs(e.speed - a.speed) > tolerance || e.precision != a.precision || e.laps != a.laps ||
+            e.timestamp != a.timestamp;
+        if (!differs) continue;
+
+        if (mismatches == 0) {
+            printf("  %8s %10s | %-26s | %-26s\n", "row", "t_us", "expected L/R/spd/prec/lap",
+                "actual L/R/spd/prec/lap");
+        }
+        if (mismatches < MAX_REPORTED_ROWS) {
+            printf("  %8zu %10u | %5d %5d %5d %3d %3d   | %5d %5d %5d %3d %3d\n", i, e.timestamp,
+                e.left, e.right, e.speed, e.precision, e.laps,
+                a.left, a.right, a.speed, a.precision, a.laps);
+        }
+        mismatches++;
+    }
+
+    if (mismatches > MAX_REPORTED_ROWS) {
+        printf("  ... %zu more differing rows\n", mismatches - MAX_REPORTED_ROWS);
+    }
+    if (expected.size() != actual.size()) {
+        printf("  trace length differs: expected %zu rows, got %zu\n", expected.size(), actual.size());
+        mismatches += max(expected.size(), actual.size()) - rows;
+    }
+
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    const char* scenarioPath = nullptr;
+    const char* expectedPath = nullptr;
+    int tolerance = 0;
+    bool update = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--update") == 0) update = true;
+        else if (!scenarioPath) scenarioPath = argv[i];
+        else expectedPath = argv[i];
+    }
+
+    if (!scenarioPath || !expectedPath) {
+        fprintf(stderr, "usage: %s <scenario.txt> <expected.csv> [--tolerance N] [--update]\n", argv[0]);
+        return 2;
+    }
+
+    Scenario scenario;
+    if (!scenario.load(scenarioPath)) return 2;
+
+    std::vector<TraceRow> actual;
+    runScenario(scenario, actual);
+
+    if (update) {
+        if (!writeTrace(expectedPath, actual)) {
+            fprintf(stderr, "cannot write %s\n", expectedPath);
+            return 2;
+        }
+        printf("UPDATED %s (%zu rows)\n", expectedPath, actual.size());
+        return 0;
+    }
+
+    std::vector<TraceRow> expected;
+    if (!readTrace(expectedPath, expected)) {
+        fprintf(stderr, "cannot read %s (run with --update to create it)\n", expectedPath);
+        return 2;
+    }
+
+    size_t mismatches = compareTraces(expected, actual, tolerance);
+    printf("%s %s: %zu rows, %zu differing (tolerance %d)\n", mismatches ? "FAIL" : "PASS",
+        scenarioPath, actual.size(), mismatches, tolerance);
+
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// Host stand-in for the Arduino core, backed by HostHardware.
+// Only the subset used by the firmware is provided.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+// ATmega328P pin numbering
+static const uint8_t A0 = 14;
+static const uint8_t A1 = 15;
+static const uint8_t A2 = 16;
+static const uint8_t A3 = 17;
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+static const uint8_t A6 = 20;
+static const uint8_t A7 = 21;
+static const uint8_t NUM_HOST_PINS = 22;
+
+#define FLASHEND 0x7FFF
+#define E2END 0x3FF
+#define SPM_PAGESIZE 128
+
+// Arduino helpers (templates instead of macros so STL headers keep working)
+template<typename A, typename B>
+inline auto min(A a, B b) -> typename std::common_type<A, B>::type { return (a < b) ? a : b; }
+template<typename A, typename B>
+inline auto max(A a, B b) -> typename std::common_type<A, B>::type { return (a > b) ? a : b; }
+template<typename T, typename L, typename H>
+inline auto constrain(T x, L low, H high) -> typename std::common_type<T, L, H>::type {
+    return (x < low) ? low : ((x > high) ? high : x);
+}
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Time and I/O (HostHardware.cpp)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void pinMode(uint8_t pin, uint8_t mode);
+
+// Interrupts are not simulated
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void cli() {}
+inline void sei() {}
+extern uint8_t SREG;
+
+// Serial port, output goes to HostHardware's sink
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* data, size_t size);
+    int availableForWrite();
+    int available();
+    int read();
+    void flush() {}
+
+    template<typename T> size_t print(T) { return 0; }
+    template<typename T> size_t println(T) { return 0; }
+    size_t println() { return 0; }
+};
+extern HardwareSerial Serial;
+
+#include <avr/pgmspace.h>
+
+#endif // HOST_ARDUINO_H
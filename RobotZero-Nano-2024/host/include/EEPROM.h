@@ -0,0 +1,30 @@
+// Host stand-in for the Arduino EEPROM library (1 KB, erased to 0xFF)
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass {
+public:
+    uint8_t read(int address) { return data()[address]; }
+    void write(int address, uint8_t value) { data()[address] = value; }
+    void update(int address, uint8_t value) { data()[address] = value; }
+    uint16_t length() { return E2END_SIZE; }
+
+    template<typename T> T& get(int address, T& value) {
+        memcpy(&value, &data()[address], sizeof(T));
+        return value;
+    }
+    template<typename T> const T& put(int address, const T& value) {
+        memcpy(&data()[address], &value, sizeof(T));
+        return value;
+    }
+
+private:
+    static const uint16_t E2END_SIZE = 1024;
+    static uint8_t* data();
+};
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
@@ -0,0 +1,12 @@
+// Host stand-in: self-programming writes the emulated flash
+#ifndef HOST_AVR_BOOT_H
+#define HOST_AVR_BOOT_H
+
+#include <stdint.h>
+
+void boot_page_erase(uint32_t address);
+void boot_page_fill(uint32_t address, uint16_t word);
+void boot_page_write(uint32_t address);
+inline void boot_spm_busy_wait() {}
+
+#endif // HOST_AVR_BOOT_H
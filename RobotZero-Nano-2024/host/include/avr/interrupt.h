@@ -0,0 +1,6 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <Arduino.h>
+
+#endif // HOST_AVR_INTERRUPT_H
@@ -0,0 +1,17 @@
+// Host stand-in: PROGMEM data lives in RAM, integer addresses read the emulated flash
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+inline uint8_t pgm_read_byte(const void* address) { return *(const uint8_t*)address; }
+inline uint16_t pgm_read_word(const void* address) { uint16_t v; memcpy(&v, address, sizeof(v)); return v; }
+uint8_t pgm_read_byte(uint32_t address);
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+
+#endif // HOST_AVR_PGMSPACE_H
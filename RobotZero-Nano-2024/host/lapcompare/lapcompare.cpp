@@ -0,0 +1,214 @@
+// Distance-aligned lap comparison across logged sessions.
+//
+//   lapcompare [--grid MM] [--segment MM] [--mm-per-pwm F] [--reference dump]
+//              [--csv laps.csv] <dump or directory>...
+//
+// Reads FlashReader dumps (directories: every *.dump inside), splits them
+// into laps at the finish line events and places every record on the track
+// by integrating the logged motor commands. Laps are resampled onto a
+// common --grid, stretched to the reference lap's length, and compared
+// --segment by segment against the reference lap: the fastest lap, or the
+// first lap of --reference. Laps are grouped by profile (mode and PID gains
+// from the session header); the report gives each group's mean time gained
+// (-) or lost (+) per segment. --csv writes every lap and segment.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "LapAnalysis.h"
+#include "SessionLog.h"
+
+struct Options {
+    float grid = 10.0f;              // Resampling step (mm)
+    float segment = 500.0f;          // Report segment length (mm)
+    float mmPerPwm = 1500.0f / 255;  // Wheel speed per PWM count (host/sim RobotModel)
+    const char* reference = nullptr;
+    const char* csv = nullptr;
+    std::vector<std::string> inputs;
+};
+
+struct Session {
+    std::string path;
+    SessionHeader header;
+};
+
+struct LapEntry {
+    uint32_t session;
+    LapAnalysis::Lap lap;
+    std::vector<float> time;    // At every grid point
+};
+
+// Laps run with the same profile
+struct Group {
+    uint32_t laps = 0;
+    double lapTime = 0.0;
+    float bestLap = INFINITY;
+    std::vector<double> delta;  // Sum of segment deltas (s)
+};
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static std::string profileName(const SessionHeader& header) {
+    const char* mode = header.mode == DebugMode::SPEED ? "speed" :
+        header.mode == DebugMode::ANALYSIS ? "analysis" : "normal";
+    char name[96];
+    snprintf(name, sizeof(name), "%s kp %.2f kd %.0f f %.2f", mode,
+        (double)header.pidKp, (double)header.pidKd, (double)header.filterAlpha);
+    return name;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strncmp(argv[i], "--", 2) != 0) {
+            options.inputs.push_back(argv[i]);
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--grid") == 0) options.grid = atof(value);
+        else if (strcmp(argv[i], "--segment") == 0) options.segment = atof(value);
+        else if (strcmp(argv[i], "--mm-per-pwm") == 0) options.mmPerPwm = atof(value);
+        else if (strcmp(argv[i], "--reference") == 0) options.reference = value;
+        else if (strcmp(argv[i], "--csv") == 0) options.csv = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (options.inputs.empty() || options.grid <= 0.0f || options.segment < options.grid) {
+        fprintf(stderr, "usage: %s [--grid MM] [--segment MM] [--mm-per-pwm F] [--reference dump] "
+            "[--csv laps.csv] <dump or directory>...\n", argv[0]);
+        return 2;
+    }
+
+    double start = seconds();
+    std::vector<std::string> paths;
+    SessionLog::collectDumps(options.inputs, paths);
+    if (options.reference) paths.insert(paths.begin(), options.reference);
+
+    // Decode and split every session
+    std::vector<Session> sessions;
+    std::vector<LapEntry> entries;
+    uint32_t unreadable = 0;
+    size_t records = 0;
+    SessionLog log;
+    std::vector<LapAnalysis::Lap> laps;
+    for (const std::string& path : paths) {
+        if (!log.load(path.c_str())) {
+            fprintf(stderr, "%s: not a session dump\n", path.c_str());
+            unreadable++;
+            continue;
+        }
+        records += log.records.size();
+
+        laps.clear();
+        LapAnalysis::extractLaps(log, options.mmPerPwm, laps);
+        for (LapAnalysis::Lap& lap : laps) {
+            entries.push_back({ (uint32_t)sessions.size(), std::move(lap), {} });
+        }
+        sessions.push_back({ path, log.header });
+    }
+    if (entries.empty()) {
+        fprintf(stderr, "no complete laps in %zu sessions\n", sessions.size());
+        return 1;
+    }
+
+    // Reference: first lap of --reference, otherwise the fastest lap
+    size_t reference = 0;
+    if (!options.reference || entries[0].session != 0) {
+        if (options.reference) fprintf(stderr, "%s: no complete lap, using the fastest\n", options.reference);
+        for (size_t i = 1; i < entries.size(); i++) {
+            if (entries[i].lap.duration < entries[reference].lap.duration) reference = i;
+        }
+    }
+    const float length = entries[reference].lap.length;
+
+    for (LapEntry& entry : entries) {
+        LapAnalysis::resample(entry.lap, length, options.grid, entry.time);
+    }
+
+    // Segment boundaries on the grid
+    const std::vector<float>& referenceTime = entries[reference].time;
+    const size_t gridPerSegment = size_t(options.segment / options.grid + 0.5f);
+    std::vector<size_t> bounds;
+    for (size_t k = 0; k < referenceTime.size() - 1; k += gridPerSegment) bounds.push_back(k);
+    bounds.push_back(referenceTime.size() - 1);
+    const size_t segments = bounds.size() - 1;
+
+    // Per-profile sums and the per-lap CSV
+    std::map<std::string, Group> groups;
+    FILE* csv = options.csv ? fopen(options.csv, "w") : nullptr;
+    if (options.csv && !csv) {
+        fprintf(stderr, "cannot write %s\n", options.csv);
+        return 1;
+    }
+    if (csv) fprintf(csv, "session,lap,profile,segment,start_mm,end_mm,time_s,delta_s\n");
+
+    for (const LapEntry& entry : entries) {
+        const Session& session = sessions[entry.session];
+        std::string name = profileName(session.header);
+        Group& group = groups[name];
+        group.delta.resize(segments, 0.0);
+        group.laps++;
+        group.lapTime += entry.lap.duration;
+        group.bestLap = fminf(group.bestLap, entry.lap.duration);
+
+        for (size_t s = 0; s < segments; s++) {
+            float time = entry.time[bounds[s + 1]] - entry.time[bounds[s]];
+            float delta = time - (referenceTime[bounds[s + 1]] - referenceTime[bounds[s]]);
+            group.delta[s] += delta;
+            if (csv) {
+                fprintf(csv, "%s,%u,%s,%zu,%.0f,%.0f,%.4f,%.4f\n", session.path.c_str(), entry.lap.number,
+                    name.c_str(), s, fminf(bounds[s] * options.grid, length),
+                    fminf(bounds[s + 1] * options.grid, length), time, delta);
+            }
+        }
+    }
+    if (csv) fclose(csv);
+    double elapsed = seconds() - start;
+
+    // Report
+    const LapEntry& best = entries[reference];
+    printf("sessions:  %zu (%u unreadable), %zu laps, %zu records in %.0f ms\n",
+        sessions.size(), unreadable, entries.size(), records, elapsed * 1e3);
+    printf("reference: %s lap %u, %.3f s, %.0f mm integrated\n",
+        sessions[best.session].path.c_str(), best.lap.number, best.lap.duration, length);
+
+    printf("\n%-3s %-30s %5s %8s %8s\n", "", "profile", "laps", "mean s", "best s");
+    std::vector<const Group*> columns;
+    uint32_t index = 0;
+    for (const auto& item : groups) {
+        const Group& group = item.second;
+        printf("%-3c %-30s %5u %8.3f %8.3f\n", 'A' + index++, item.first.c_str(), group.laps,
+            group.lapTime / group.laps, group.bestLap);
+        columns.push_back(&group);
+    }
+
+    printf("\nmean time lost (+) or gained (-) per segment against the reference, ms\n");
+    printf("%13s %8s", "segment mm", "ref ms");
+    for (size_t c = 0; c < columns.size(); c++) printf(" %8c", char('A' + c));
+    printf("\n");
+    for (size_t s = 0; s < segments; s++) {
+        char range[32];
+        snprintf(range, sizeof(range), "%.0f-%.0f", bounds[s] * options.grid,
+            fminf(bounds[s + 1] * options.grid, length));
+        printf("%13s %8.0f", range, (referenceTime[bounds[s + 1]] - referenceTime[bounds[s]]) * 1e3);
+        for (const Group* group : columns) printf(" %+8.1f", group->delta[s] / group->laps * 1e3);
+        printf("\n");
+    }
+    return 0;
+}
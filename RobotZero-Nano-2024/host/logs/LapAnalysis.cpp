@@ -0,0 +1,78 @@
+#include "LapAnalysis.h"
+#include <math.h>
+
+// Mean wheel speed of a record (mm/s)
+static float recordSpeed(const PerformanceRecord& record, float mmPerPwm) {
+    return (record.speedLeft + record.speedRight) * 0.5f * mmPerPwm;
+}
+
+// Speed at time t (ms), linear between the records around it
+static float speedAt(const std::vector<PerformanceRecord>& records, size_t next, uint32_t t, float mmPerPwm) {
+    if (next == 0) return recordSpeed(records.front(), mmPerPwm);
+    if (next >= records.size()) return recordSpeed(records.back(), mmPerPwm);
+
+    const PerformanceRecord& before = records[next - 1];
+    const PerformanceRecord& after = records[next];
+    float span = float(after.timestamp - before.timestamp);
+    float weight = span > 0.0f ? (t - before.timestamp) / span : 1.0f;
+    return recordSpeed(before, mmPerPwm) + weight * (recordSpeed(after, mmPerPwm) - recordSpeed(before, mmPerPwm));
+}
+
+void LapAnalysis::extractLaps(const SessionLog& log, float mmPerPwm, std::vector<Lap>& laps) {
+    std::vector<uint32_t> finishes;
+    log.getFinishTimes(finishes);
+
+    const std::vector<PerformanceRecord>& records = log.records;
+    if (records.empty()) return;
+
+    size_t next = 0;
+    for (size_t k = 0; k + 1 < finishes.size(); k++) {
+        uint32_t start = finishes[k];
+        uint32_t end = finishes[k + 1];
+        while (next < records.size() && records[next].timestamp < start) next++;
+
+        Lap lap;
+        lap.number = k + 1;
+        lap.duration = (end - start) * 1e-3f;
+        lap.time.push_back(0.0f);
+        lap.distance.push_back(0.0f);
+
+        // Trapezoids between the lap start, the records and the lap end
+        float distance = 0.0f;
+        uint32_t lastTime = start;
+        float lastSpeed = speedAt(records, next, start, mmPerPwm);
+        for (; next < records.size() && records[next].timestamp <= end; next++) {
+            float speed = recordSpeed(records[next], mmPerPwm);
+            distance += (lastSpeed + speed) * 0.5f * (records[next].timestamp - lastTime) * 1e-3f;
+            lastTime = records[next].timestamp;
+            lastSpeed = speed;
+            lap.time.push_back((lastTime - start) * 1e-3f);
+            lap.distance.push_back(distance);
+        }
+        float endSpeed = speedAt(records, next, end, mmPerPwm);
+        distance += (lastSpeed + endSpeed) * 0.5f * (end - lastTime) * 1e-3f;
+        lap.time.push_back(lap.duration);
+        lap.distance.push_back(distance);
+        lap.length = distance;
+
+        // A lap without records or movement cannot be placed on the track
+        if (lap.time.size() > 2 && lap.length > 0.0f) laps.push_back(std::move(lap));
+    }
+}
+
+void LapAnalysis::resample(const Lap& lap, float length, float step, std::vector<float>& time) {
+    size_t points = size_t(ceilf(length / step)) + 1;
+    float scale = length / lap.length;
+    time.resize(points);
+
+    size_t j = 0;
+    for (size_t k = 0; k < points; k++) {
+        float target = fminf(k * step, length);
+        while (j + 2 < lap.distance.size() && lap.distance[j + 1] * scale < target) j++;
+
+        float low = lap.distance[j] * scale;
+        float high = lap.distance[j + 1] * scale;
+        time[k] = (high > low) ?
+            lap.time[j] + (target - low) / (high - low) * (lap.time[j + 1] - lap.time[j]) : lap.time[j];
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef LAPANALYSIS_H
+#define LAPANALYSIS_H
+
+#include <stdint.h>
+#include <vector>
+#include "SessionLog.h"
+
+// Distance along the track for logged laps.
+// PerformanceRecords are indexed by time; the distance driven comes from
+// the motor commands (speedLeft/speedRight) integrated over time, so laps
+// at different speeds can be compared at the same place on the track.
+class LapAnalysis {
+public:
+    // One lap between two finish line events
+    struct Lap {
+        uint8_t number;              // Lap of the session, from 1
+        float duration;              // Lap time (s)
+        float length;                // Integrated distance (mm)
+        std::vector<float> time;     // Samples since the lap start (s)
+        std::vector<float> distance; // Integrated distance at each sample (mm)
+    };
+
+    // Split a session at its LAP_START/LAP_END events and integrate the
+    // mean motor command, mmPerPwm is the wheel speed per PWM count
+    static void extractLaps(const SessionLog& log, float mmPerPwm, std::vector<Lap>& laps);
+
+    // Lap time at every `step` mm along `length`. Integrated distance drifts
+    // with battery and wheel slip, so the lap is stretched to `length` first
+    // and the finish lines of all laps line up.
+    static void resample(const Lap& lap, float length, float step, std::vector<float>& time);
+};
+
+#endif // LAPANALYSIS_H
@@ -0,0 +1,225 @@
+#include "SessionArchive.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+static size_t align8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+template<typename T>
+static bool writeSection(FILE* file, size_t& offset, const T* data, size_t count) {
+    static const uint8_t padding[8] = {};
+    size_t start = align8(offset);
+    if (start > offset && fwrite(padding, 1, start - offset, file) != start - offset) return false;
+    offset = start + count * sizeof(T);
+    return count == 0 || fwrite(data, sizeof(T), count, file) == count;
+}
+
+ArchiveWriter::ArchiveWriter(uint32_t blockSize)
+    : blockSize(blockSize > 0 ? blockSize : ARCHIVE_BLOCK_SIZE) {
+}
+
+void ArchiveWriter::add(const char* name, const SessionLog& log) {
+    ArchiveSession session;
+    memset(&session, 0, sizeof(session));
+    const char* base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+    strncpy(session.name, base, sizeof(session.name) - 1);
+
+    const SessionHeader& header = log.header;
+    session.startTime = header.startTime;
+    session.mode = header.mode;
+    session.plannedLaps = header.plannedLaps;
+    session.configuredSpeed = header.configuredSpeed;
+    session.pidKp = header.pidKp;
+    session.pidKd = header.pidKd;
+    session.filterAlpha = header.filterAlpha;
+    memcpy(session.sensorCalibrationData, header.sensorCalibrationData, sizeof(session.sensorCalibrationData));
+
+    std::vector<uint32_t> finishes;
+    log.getFinishTimes(finishes);
+    session.lapCount = finishes.size() > 1 ? uint8_t(std::min<size_t>(finishes.size() - 1, 255)) : 0;
+
+    // Records, numbered by the lap they fall in
+    session.recordBegin = timestamp.size();
+    session.recordCount = log.records.size();
+    session.blockBegin = blocks.size();
+    size_t finish = 0;
+    for (const PerformanceRecord& record : log.records) {
+        while (finish < finishes.size() && record.timestamp >= finishes[finish]) finish++;
+        bool inLap = finish > 0 && finish < finishes.size();
+
+        timestamp.push_back(record.timestamp);
+        linePosition.push_back(record.linePosition);
+        error.push_back(record.error);
+        correction.push_back(record.correction);
+        speedLeft.push_back(record.speedLeft);
+        speedRight.push_back(record.speedRight);
+        state.push_back(record.state);
+        lap.push_back(inLap ? uint8_t(std::min<size_t>(finish, 255)) : 0);
+    }
+
+    // Blocks end at the block size and wherever the lap changes
+    uint32_t begin = session.recordBegin;
+    const uint32_t end = begin + session.recordCount;
+    sessions.push_back(session);
+    for (uint32_t row = begin + 1; row <= end; row++) {
+        if (row == end || lap[row] != lap[begin] || row - begin == blockSize) {
+            closeBlock(begin, row);
+            begin = row;
+        }
+    }
+    sessions.back().blockCount = blocks.size() - sessions.back().blockBegin;
+
+    sessions.back().eventBegin = eventTimestamp.size();
+    sessions.back().eventCount = log.events.size();
+    for (const EventRecord& event : log.events) {
+        eventTimestamp.push_back(event.timestamp);
+        eventType.push_back(uint8_t(event.type));
+        eventData.push_back(event.data);
+    }
+}
+
+void ArchiveWriter::closeBlock(uint32_t begin, uint32_t end) {
+    ArchiveBlock block;
+    block.session = sessions.size() - 1;
+    block.begin = begin;
+    block.count = end - begin;
+    block.lap = lap[begin];
+
+    for (uint8_t c = 0; c < RECORD_COLUMN_COUNT; c++) {
+        block.minimum[c] = INT32_MAX;
+        block.maximum[c] = INT32_MIN;
+    }
+    for (uint32_t row = begin; row < end; row++) {
+        const int32_t values[RECORD_COLUMN_COUNT] = {
+            int32_t(timestamp[row]), linePosition[row], error[row], correction[row],
+            speedLeft[row], speedRight[row], state[row], lap[row]
+        };
+        for (uint8_t c = 0; c < RECORD_COLUMN_COUNT; c++) {
+            block.minimum[c] = std::min(block.minimum[c], values[c]);
+            block.maximum[c] = std::max(block.maximum[c], values[c]);
+        }
+    }
+    blocks.push_back(block);
+}
+
+bool ArchiveWriter::write(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.blockSize = blockSize;
+    header.sessionCount = sessions.size();
+    header.blockCount = blocks.size();
+    header.recordCount = timestamp.size();
+    header.eventCount = eventTimestamp.size();
+
+    // Offsets first, the header goes out in front of the sections
+    size_t offset = sizeof(header);
+    auto place = [&offset](size_t bytes) {
+        size_t start = align8(offset);
+        offset = start + bytes;
+        return uint64_t(start);
+    };
+    header.sessionOffset = place(sessions.size() * sizeof(ArchiveSession));
+    header.blockOffset = place(blocks.size() * sizeof(ArchiveBlock));
+    const size_t records = timestamp.size();
+    const size_t events = eventTimestamp.size();
+    const uint8_t widths[COLUMN_COUNT] = { 4, 2, 2, 2, 1, 1, 1, 1, 4, 1, 2 };
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        header.columnWidth[c] = widths[c];
+        header.columnOffset[c] = place((c < RECORD_COLUMN_COUNT ? records : events) * widths[c]);
+    }
+    header.fileSize = offset;
+
+    offset = 0;
+    bool ok = writeSection(file, offset, &header, 1) &&
+        writeSection(file, offset, sessions.data(), sessions.size()) &&
+        writeSection(file, offset, blocks.data(), blocks.size()) &&
+        writeSection(file, offset, timestamp.data(), records) &&
+        writeSection(file, offset, linePosition.data(), records) &&
+        writeSection(file, offset, error.data(), records) &&
+        writeSection(file, offset, correction.data(), records) &&
+        writeSection(file, offset, speedLeft.data(), records) &&
+        writeSection(file, offset, speedRight.data(), records) &&
+        writeSection(file, offset, state.data(), records) &&
+        writeSection(file, offset, lap.data(), records) &&
+        writeSection(file, offset, eventTimestamp.data(), events) &&
+        writeSection(file, offset, eventType.data(), events) &&
+        writeSection(file, offset, eventData.data(), events);
+
+    // Trailing padding so the file ends where the header says
+    static const uint8_t padding[8] = {};
+    ok = ok && fwrite(padding, 1, header.fileSize - offset, file) == header.fileSize - offset;
+    return fclose(file) == 0 && ok;
+}
+
+SessionArchive::~SessionArchive() {
+    close();
+}
+
+bool SessionArchive::open(const char* path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(ArchiveHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    base = static_cast<const uint8_t*>(mapped);
+    size = info.st_size;
+    header = reinterpret_cast<const ArchiveHeader*>(base);
+
+    // Every section must lie inside the file
+    bool valid = memcmp(header->magic, ARCHIVE_MAGIC, sizeof(header->magic)) == 0 &&
+        header->version == ARCHIVE_VERSION && header->fileSize == size &&
+        header->sessionOffset + uint64_t(header->sessionCount) * sizeof(ArchiveSession) <= size &&
+        header->blockOffset + uint64_t(header->blockCount) * sizeof(ArchiveBlock) <= size;
+    for (uint8_t c = 0; valid && c < COLUMN_COUNT; c++) {
+        uint64_t rows = c < RECORD_COLUMN_COUNT ? header->recordCount : header->eventCount;
+        valid = header->columnOffset[c] % 8 == 0 && header->columnOffset[c] + rows * header->columnWidth[c] <= size;
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    sessions = reinterpret_cast<const ArchiveSession*>(base + header->sessionOffset);
+    blocks = reinterpret_cast<const ArchiveBlock*>(base + header->blockOffset);
+    return true;
+}
+
+void SessionArchive::close() {
+    if (base) munmap(const_cast<uint8_t*>(base), size);
+    base = nullptr;
+    size = 0;
+    header = nullptr;
+    sessions = nullptr;
+    blocks = nullptr;
+}
+
+void SessionArchive::getFinishTimes(const ArchiveSession& session, std::vector<uint32_t>& times) const {
+    times.clear();
+    const uint32_t* timestamp = getColumn<uint32_t>(COLUMN_EVENT_TIMESTAMP);
+    const uint8_t* type = getColumn<uint8_t>(COLUMN_EVENT_TYPE);
+    for (uint32_t row = session.eventBegin; row < session.eventBegin + session.eventCount; row++) {
+        if (type[row] == uint8_t(EventType::LAP_START) || type[row] == uint8_t(EventType::LAP_END)) {
+            times.push_back(timestamp[row]);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef SESSIONARCHIVE_H
+#define SESSIONARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "SessionLog.h"
+
+// Columnar archive of decoded session logs, read in place through mmap.
+//
+// Layout (host byte order, every section starts 8 byte aligned):
+//   ArchiveHeader
+//   ArchiveSession[sessionCount]   session index: header fields, row ranges
+//   ArchiveBlock[blockCount]       min/max of every record column per block
+//   record columns                 one array per PerformanceRecord field, plus lap
+//   event columns                  one array per EventRecord field
+// Record checksums are verified on import and not stored. Blocks never span
+// a session or a lap, so lap extremes come from the block statistics alone
+// and the columns of sessions a query rejects are never paged in.
+
+static constexpr char ARCHIVE_MAGIC[8] = { 'R', 'Z', 'A', 'R', 'C', 'H', 0, 0 };
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+static constexpr uint32_t ARCHIVE_BLOCK_SIZE = 256;   // Maximum records per block
+
+enum ArchiveColumn : uint8_t {
+    // Record columns, covered by the block statistics
+    COLUMN_TIMESTAMP = 0,
+    COLUMN_LINE_POSITION,
+    COLUMN_ERROR,
+    COLUMN_CORRECTION,
+    COLUMN_SPEED_LEFT,
+    COLUMN_SPEED_RIGHT,
+    COLUMN_STATE,
+    COLUMN_LAP,             // 1..n between finish events, 0 before the first and after the last
+    // Event columns
+    COLUMN_EVENT_TIMESTAMP,
+    COLUMN_EVENT_TYPE,
+    COLUMN_EVENT_DATA,
+    COLUMN_COUNT
+};
+static constexpr uint8_t RECORD_COLUMN_COUNT = COLUMN_LAP + 1;
+
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t sessionCount;
+    uint32_t blockCount;
+    uint32_t recordCount;
+    uint32_t eventCount;
+    uint64_t sessionOffset;
+    uint64_t blockOffset;
+    uint64_t columnOffset[COLUMN_COUNT];
+    uint8_t columnWidth[COLUMN_COUNT];   // Bytes per value
+    uint64_t fileSize;
+};
+
+struct ArchiveSession {
+    char name[48];              // Dump file name, directory removed
+    uint32_t startTime;         // SessionHeader fields
+    DebugMode mode;
+    uint8_t plannedLaps;
+    uint8_t configuredSpeed;
+    uint8_t lapCount;           // Complete laps (finish to finish)
+    float pidKp;
+    float pidKd;
+    float filterAlpha;
+    uint16_t sensorCalibrationData[12];
+    uint32_t recordBegin;       // Rows in the record columns
+    uint32_t recordCount;
+    uint32_t eventBegin;        // Rows in the event columns
+    uint32_t eventCount;
+    uint32_t blockBegin;
+    uint32_t blockCount;
+};
+
+struct ArchiveBlock {
+    uint32_t session;
+    uint32_t begin;             // First record row
+    uint32_t count;
+    uint32_t lap;
+    int32_t minimum[RECORD_COLUMN_COUNT];
+    int32_t maximum[RECORD_COLUMN_COUNT];
+};
+
+// Collects decoded sessions and writes them as one archive file
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(uint32_t blockSize = ARCHIVE_BLOCK_SIZE);
+
+    void add(const char* name, const SessionLog& log);
+    bool write(const char* path) const;
+
+    size_t getSessionCount() const { return sessions.size(); }
+    size_t getRecordCount() const { return timestamp.size(); }
+
+private:
+    void closeBlock(uint32_t begin, uint32_t end);
+
+    uint32_t blockSize;
+    std::vector<ArchiveSession> sessions;
+    std::vector<ArchiveBlock> blocks;
+
+    std::vector<uint32_t> timestamp;
+    std::vector<int16_t> linePosition;
+    std::vector<int16_t> error;
+    std::vector<int16_t> correction;
+    std::vector<uint8_t> speedLeft;
+    std::vector<uint8_t> speedRight;
+    std::vector<uint8_t> state;
+    std::vector<uint8_t> lap;
+
+    std::vector<uint32_t> eventTimestamp;
+    std::vector<uint8_t> eventType;
+    std::vector<uint16_t> eventData;
+};
+
+// Read-only view of an archive file mapped into memory
+class SessionArchive {
+public:
+    SessionArchive() = default;
+    SessionArchive(const SessionArchive&) = delete;
+    SessionArchive& operator=(const SessionArchive&) = delete;
+    ~SessionArchive();
+
+    // Map and validate an archive, returns false on I/O or format errors
+    bool open(const char* path);
+    void close();
+
+    const ArchiveHeader& getHeader() const { return *header; }
+    const ArchiveSession* getSessions() const { return sessions; }
+    const ArchiveBlock* getBlocks() const { return blocks; }
+
+    // Column values, nullptr when T does not match the stored width
+    template<typename T>
+    const T* getColumn(ArchiveColumn column) const {
+        if (header->columnWidth[column] != sizeof(T)) return nullptr;
+        return reinterpret_cast<const T*>(base + header->columnOffset[column]);
+    }
+
+    // Finish line times (ms) of a session from its event columns
+    void getFinishTimes(const ArchiveSession& session, std::vector<uint32_t>& times) const;
+
+private:
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    const ArchiveHeader* header = nullptr;
+    const ArchiveSession* sessions = nullptr;
+    const ArchiveBlock* blocks = nullptr;
+};
+
+#endif // SESSIONARCHIVE_H
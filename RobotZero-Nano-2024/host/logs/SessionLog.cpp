@@ -0,0 +1,159 @@
+#include "SessionLog.h"
+#include "config.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// FlashReader section markers
+static const uint8_t START_MARKER = '$';
+static const uint8_t END_MARKER = '#';
+static const uint8_t MARKER_HEADER = 0x01;
+static const uint8_t MARKER_PERFORMANCE = 0x02;
+static const uint8_t MARKER_EVENT = 0x03;
+static const uint8_t MARKER_LAP = 0x04;
+
+// Logger::calculateChecksum, sum of the bytes before the checksum
+static uint8_t byteSum(const uint8_t* data, size_t size) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < size; i++) sum += data[i];
+    return sum;
+}
+
+static bool readPerformance(const uint8_t* data, PerformanceRecord& record) {
+    memcpy(&record, data, sizeof(record));
+    return record.checksum == byteSum(data, sizeof(record) - 1) && (record.state & ~0x03) == 0;
+}
+
+static bool readEvent(const uint8_t* data, EventRecord& record) {
+    memcpy(&record, data, sizeof(record));
+    return record.checksum == byteSum(data, sizeof(record) - 1) &&
+        record.type >= EventType::SESSION_START && record.type <= EventType::OUTPUT_LIMIT;
+}
+
+bool SessionLog::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t size;
+    while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + size);
+    }
+    fclose(file);
+
+    return parse(data.data(), data.size());
+}
+
+bool SessionLog::parse(const uint8_t* data, size_t size) {
+    records.clear();
+    events.clear();
+    skippedPages = 0;
+
+    const size_t headerEnd = 2 + sizeof(SessionHeader);
+    if (size < headerEnd || data[0] != START_MARKER || data[1] != MARKER_HEADER) return false;
+
+    memcpy(&header, data + 2, sizeof(SessionHeader));
+    if (header.headerChecksum != byteSum(data + 2, sizeof(SessionHeader) - sizeof(uint32_t))) return false;
+
+    // The log area ends on a page boundary, find the page count whose
+    // three truncated copies add up to the dump size
+    const uint8_t* sections = data + headerEnd;
+    const size_t remaining = size - headerEnd;
+    for (size_t pages = 1;; pages++) {
+        size_t logSize = pages * FLASH_PAGE_SIZE - sizeof(SessionHeader);
+        size_t performanceSize = logSize / sizeof(PerformanceRecord) * sizeof(PerformanceRecord);
+        size_t eventSize = logSize / sizeof(EventRecord) * sizeof(EventRecord);
+        size_t lapSize = logSize / sizeof(LapStats) * sizeof(LapStats);
+        size_t expected = 4 + performanceSize + eventSize + lapSize + 4;
+
+        if (expected > remaining) return false;
+        if (expected < remaining) continue;
+
+        const uint8_t* performance = sections + 1;
+        const uint8_t* event = performance + performanceSize + 1;
+        const uint8_t* lap = event + eventSize + 1;
+        if (performance[-1] != MARKER_PERFORMANCE || event[-1] != MARKER_EVENT ||
+            lap[-1] != MARKER_LAP || lap[lapSize] != END_MARKER) {
+            return false;
+        }
+
+        // Same bytes in every copy, the longest misses the fewest at the end
+        const uint8_t* log = performance;
+        size_t copySize = performanceSize;
+        if (eventSize > copySize) {
+            log = event;
+            copySize = eventSize;
+        }
+        if (lapSize > copySize) {
+            log = lap;
+            copySize = lapSize;
+        }
+
+        parseLog(log, copySize);
+        return true;
+    }
+}
+
+void SessionLog::parseLog(const uint8_t* log, size_t size) {
+    // The first block starts on the page after the header
+    size_t position = FLASH_PAGE_SIZE - sizeof(SessionHeader);
+
+    while (position < size) {
+        size_t end = position;
+        PerformanceRecord performance;
+        EventRecord event;
+
+        // A flush writes performance records first, try them first
+        if (size - end >= sizeof(performance) && readPerformance(log + end, performance)) {
+            do {
+                records.push_back(performance);
+                end += sizeof(performance);
+            } while (size - end >= sizeof(performance) && readPerformance(log + end, performance));
+        }
+        else if (size - end >= sizeof(event) && readEvent(log + end, event)) {
+            do {
+                events.push_back(event);
+                end += sizeof(event);
+            } while (size - end >= sizeof(event) && readEvent(log + end, event));
+        }
+        else {
+            skippedPages++;
+        }
+
+        // The next block starts on the following page
+        size_t pages = (end - position + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+        position += (pages > 0 ? pages : 1) * FLASH_PAGE_SIZE;
+    }
+}
+
+void SessionLog::getFinishTimes(std::vector<uint32_t>& times) const {
+    times.clear();
+    for (const EventRecord& event : events) {
+        if (event.type == EventType::LAP_START || event.type == EventType::LAP_END) {
+            times.push_back(event.timestamp);
+        }
+    }
+}
+
+void SessionLog::collectDumps(const std::vector<std::string>& inputs, std::vector<std::string>& paths) {
+    for (const std::string& input : inputs) {
+        DIR* directory = opendir(input.c_str());
+        if (!directory) {
+            paths.push_back(input);
+            continue;
+        }
+
+        std::vector<std::string> found;
+        while (struct dirent* entry = readdir(directory)) {
+            size_t length = strlen(entry->d_name);
+            if (length > 5 && strcmp(entry->d_name + length - 5, ".dump") == 0) {
+                found.push_back(input + "/" + entry->d_name);
+            }
+        }
+        closedir(directory);
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+}
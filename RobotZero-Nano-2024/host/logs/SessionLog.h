@@ -0,0 +1,39 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "DataStructures.h"
+
+// Session log decoded from a FlashReader dump, the bytes the robot sends
+// when the button is pressed after a debug run:
+//   '$' 0x01 header 0x02 log 0x03 log 0x04 log '#' checksum (4 hex digits)
+// The log area is sent three times, once read as each record type. Logger
+// flushes every record type as its own block starting on a flash page, so
+// the blocks are found page by page and told apart by their checksums.
+class SessionLog {
+public:
+    SessionHeader header;
+    std::vector<PerformanceRecord> records;
+    std::vector<EventRecord> events;
+    uint32_t skippedPages = 0;   // Pages without a valid first record
+
+    // Read a dump file, returns false on I/O or format errors
+    bool load(const char* path);
+
+    // Decode a dump held in memory
+    bool parse(const uint8_t* data, size_t size);
+
+    // Timestamps (ms) of the finish line events, laps run between them
+    void getFinishTimes(std::vector<uint32_t>& times) const;
+
+    // Files of the inputs, directories expanded to their sorted *.dump files
+    static void collectDumps(const std::vector<std::string>& inputs, std::vector<std::string>& paths);
+
+private:
+    void parseLog(const uint8_t* log, size_t size);
+};
+
+#endif // SESSIONLOG_H
@@ -0,0 +1,79 @@
+// Marker classifier check on a raw capture.
+//
+// Feeds a capture through setup/loop() and compares what CourseMarkers made
+// of it (finish laps, speed mode toggles, intersections and rejected
+// markers) with the "# expect" line in the capture.
+//
+//   markers <capture.csv>
+//
+// Run the whole corpus with tools/run_markers.py.
+#include <stdio.h>
+#include <string.h>
+#include "CourseMarkers.h"
+#include "FirmwareHarness.h"
+#include "RawCapture.h"
+#include "globals.h"
+
+struct Outcome {
+    int laps;
+    int toggles;
+    int intersections;
+    int rejected;
+};
+
+static bool readExpectation(const char* path, Outcome& expected) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[256];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), file)) {
+        found = sscanf(line, "# expect laps %d toggles %d intersections %d rejected %d",
+            &expected.laps, &expected.toggles, &expected.intersections, &expected.rejected) == 4;
+    }
+
+    fclose(file);
+    return found;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <capture.csv>\n", argv[0]);
+        return 2;
+    }
+
+    const char* path = argv[1];
+    Outcome expected;
+    if (!readExpectation(path, expected)) {
+        fprintf(stderr, "%s: no '# expect laps N toggles N intersections N rejected N' line\n", path);
+        return 2;
+    }
+
+    RawCapture capture;
+    if (!capture.load(path)) {
+        fprintf(stderr, "cannot read capture %s (missing calibration or bad row)\n", path);
+        return 2;
+    }
+
+    FirmwareHarness::begin(capture.sensorMin, capture.sensorMax);
+
+    Outcome actual = { 0, 0, 0, 0 };
+    bool precision = isPrecisionMode;
+    for (const RawCaptureFrame& frame : capture.frames) {
+        FirmwareHarness::step(frame.timestamp, frame.line, frame.markerLeft, frame.markerRight);
+        if (isPrecisionMode != precision) {
+            precision = isPrecisionMode;
+            actual.toggles++;
+        }
+    }
+    actual.laps = lapCount;
+    actual.intersections = CourseMarkers::getIntersectionCount();
+    actual.rejected = CourseMarkers::getRejectedCount();
+
+    bool pass = memcmp(&actual, &expected, sizeof(Outcome)) == 0;
+    printf("%s %s: laps %d/%d toggles %d/%d intersections %d/%d rejected %d/%d\n",
+        pass ? "PASS" : "FAIL", path,
+        actual.laps, expected.laps, actual.toggles, expected.toggles,
+        actual.intersections, expected.intersections, actual.rejected, expected.rejected);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+// Monte Carlo robustness benchmark for the control loop.
+//
+// Runs many closed-loop laps of the host firmware around the default
+// simulated track or a track file. Every lap draws its own sensor noise, per-sensor gain
+// mismatch, ambient offset, motor asymmetry, battery level and sag, and
+// motor command latency. The report gives the lap time distribution and
+// the failure rates (line lost, false finish marker, timeout) for the
+// profile selected by DEBUG_LEVEL.
+//
+//   montecarlo [--laps N] [--jobs N] [--seed N] [--noise C] [--gain F]
+//              [--ambient C] [--asymmetry F] [--battery F] [--sag F]
+//              [--jitter US] [--track file] [--csv results.csv]
+//
+// Firmware state is static, so each lap runs in its own forked process and
+// --jobs laps run at the same time (default: one per core). Needs a POSIX
+// host (Linux, macOS or WSL) for fork().
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "LapSimulator.h"
+#include "config.h"
+
+struct Options {
+    uint32_t laps = 2000;
+    uint32_t jobs = 0;
+    uint32_t seed = 1;
+    float noise = 15.0f;       // ADC counts, standard deviation
+    float gain = 0.15f;        // Per-sensor contrast mismatch, +-fraction
+    float ambient = 60.0f;     // Ambient offset, +-counts
+    float asymmetry = 0.05f;   // Motor gain mismatch, +-fraction
+    float battery = 0.15f;     // Battery level below full, 0..fraction
+    float sag = 0.10f;         // Supply drop at full load, 0..fraction
+    uint32_t jitter = 500;     // Motor command latency, 0..us
+    const char* track = nullptr;
+    const char* csv = nullptr;
+};
+
+struct LapRecord {
+    uint32_t lap;
+    LapSimulator::Result result;
+};
+
+static const uint8_t OUTCOME_COUNT = 4;
+static const char* OUTCOME_NAMES[OUTCOME_COUNT] = { "finished", "line_lost", "false_finish", "timeout" };
+
+static float uniform(std::mt19937& random, float low, float high) {
+    return std::uniform_real_distribution<float>(low, high)(random);
+}
+
+// Variation for one lap, reproducible from the seed and the lap number
+static RobotModel::Variation drawVariation(const Options& options, uint32_t lap) {
+    std::mt19937 random(options.seed * 1000003u + lap);
+    RobotModel::Variation variation;
+    variation.sensorNoise = options.noise;
+    for (uint8_t i = 0; i < 6; i++) {
+        variation.sensorGain[i] = 1.0f + uniform(random, -options.gain, options.gain);
+    }
+    variation.ambientOffset = uniform(random, -options.ambient, options.ambient);
+    float asymmetry = uniform(random, -options.asymmetry, options.asymmetry);
+    variation.motorGainLeft = 1.0f + asymmetry;
+    variation.motorGainRight = 1.0f - asymmetry;
+    variation.batteryLevel = 1.0f - uniform(random, 0.0f, options.battery);
+    variation.batterySag = uniform(random, 0.0f, options.sag);
+    return variation;
+}
+
+static LapSimulator::Result runLap(const Options& options, const Track& track, uint32_t lap) {
+    LapSimulator::Settings settings;
+    settings.latencyJitterUs = options.jitter;
+    return LapSimulator::run(track, drawVariation(options, lap), settings, options.seed + lap);
+}
+
+struct Worker {
+    pid_t pid;
+    int fd;
+    uint32_t lap;
+};
+
+static bool runAll(const Options& options, const Track& track, std::vector<LapRecord>& records) {
+    std::vector<Worker> workers;
+    uint32_t next = 0;
+
+    while (next < options.laps || !workers.empty()) {
+        // Keep every job slot busy
+        while (next < options.laps && workers.size() < options.jobs) {
+            int pipeFd[2];
+            if (pipe(pipeFd) != 0) return false;
+            fflush(stdout);
+
+            pid_t pid = fork();
+            if (pid < 0) return false;
+            if (pid == 0) {
+                close(pipeFd[0]);
+                LapSimulator::Result result = runLap(options, track, next);
+                ssize_t written = write(pipeFd[1], &result, sizeof(result));
+                _exit(written == sizeof(result) ? 0 : 1);
+            }
+            close(pipeFd[1]);
+            workers.push_back({ pid, pipeFd[0], next });
+            next++;
+        }
+
+        int status;
+        pid_t done = wait(&status);
+        if (done < 0) return false;
+
+        for (size_t i = 0; i < workers.size(); i++) {
+            if (workers[i].pid != done) continue;
+            LapRecord record;
+            record.lap = workers[i].lap;
+            if (read(workers[i].fd, &record.result, sizeof(record.result)) != sizeof(record.result)) {
+                fprintf(stderr, "lap %u: worker failed\n", record.lap);
+                return false;
+            }
+            records.push_back(record);
+            close(workers[i].fd);
+            workers.erase(workers.begin() + i);
+            break;
+        }
+
+        if (records.size() % 100 == 0) {
+            fprintf(stderr, "\r%zu/%u laps", records.size(), options.laps);
+        }
+    }
+    fprintf(stderr, "\n");
+    return true;
+}
+
+static float percentile(const std::vector<float>& sorted, float fraction) {
+    size_t index = size_t(fraction * (sorted.size() - 1) + 0.5f);
+    return sorted[index];
+}
+
+static void report(const Options& options, const std::vector<LapRecord>& records, double wallSeconds) {
+    std::vector<float> lapTimes;
+    uint32_t outcomes[OUTCOME_COUNT] = {};
+    for (const LapRecord& record : records) {
+        outcomes[uint8_t(record.result.outcome)]++;
+        if (record.result.outcome == LapSimulator::Outcome::FINISHED) {
+            lapTimes.push_back(record.result.lapTimeUs * 1e-6f);
+        }
+    }
+
+    printf("profile:    %s (DEBUG_LEVEL=%d)\n", DEBUG_LEVEL == 1 ? "ANALYSIS_PROFILE" : "SPEED_PROFILE", DEBUG_LEVEL);
+    printf("track:      %s\n", options.track ? options.track : "default");
+    printf("laps:       %zu in %.1f s on %u jobs\n", records.size(), wallSeconds, options.jobs);
+    printf("variation:  noise %.0f, gain +-%.2f, ambient +-%.0f, asymmetry +-%.2f, battery -%.2f, sag %.2f, jitter %u us\n",
+        options.noise, options.gain, options.ambient, options.asymmetry, options.battery,
+        options.sag, options.jitter);
+
+    for (uint8_t i = 0; i < OUTCOME_COUNT; i++) {
+        printf("%-13s %6u (%.2f%%)\n", OUTCOME_NAMES[i], outcomes[i], 100.0f * outcomes[i] / records.size());
+    }
+
+    if (lapTimes.empty()) return;
+    std::sort(lapTimes.begin(), lapTimes.end());
+
+    double sum = 0.0, squares = 0.0;
+    for (float t : lapTimes) {
+        sum += t;
+        squares += t * t;
+    }
+    double mean = sum / lapTimes.size();
+    double deviation = sqrt(fmax(0.0, squares / lapTimes.size() - mean * mean));
+
+    printf("lap time:   mean %.3f s, stddev %.3f s\n", mean, deviation);
+    printf("            min %.3f  p5 %.3f  p50 %.3f  p95 %.3f  max %.3f\n",
+        lapTimes.front(), percentile(lapTimes, 0.05f), percentile(lapTimes, 0.5f),
+        percentile(lapTimes, 0.95f), lapTimes.back());
+
+    // Text histogram of the finished laps
+    const int BINS = 12;
+    const int WIDTH = 50;
+    float low = lapTimes.front();
+    float span = fmaxf(lapTimes.back() - low, 1e-3f);
+    uint32_t counts[BINS] = {};
+    uint32_t peak = 1;
+    for (float t : lapTimes) {
+        int bin = std::min(BINS - 1, int((t - low) / span * BINS));
+        counts[bin]++;
+        peak = std::max(peak, counts[bin]);
+    }
+    for (int bin = 0; bin < BINS; bin++) {
+        printf("  %6.3f s |%-*.*s %u\n", low + span * bin / BINS, WIDTH,
+            int(counts[bin] * WIDTH / peak), "##################################################", counts[bin]);
+    }
+}
+
+static bool writeCsv(const char* path, std::vector<LapRecord> records) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    std::sort(records.begin(), records.end(),
+        [](const LapRecord& a, const LapRecord& b) { return a.lap < b.lap; });
+    fprintf(file, "lap,outcome,lap_time_us,max_lateral_mm,distance_mm\n");
+    for (const LapRecord& record : records) {
+        fprintf(file, "%u,%s,%u,%.1f,%.0f\n", record.lap, OUTCOME_NAMES[uint8_t(record.result.outcome)],
+            record.result.lapTimeUs, record.result.maxLateral, record.result.distance);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--laps") == 0) options.laps = atoi(value);
+        else if (strcmp(argv[i], "--jobs") == 0) options.jobs = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = atoi(value);
+        else if (strcmp(argv[i], "--noise") == 0) options.noise = atof(value);
+        else if (strcmp(argv[i], "--gain") == 0) options.gain = atof(value);
+        else if (strcmp(argv[i], "--ambient") == 0) options.ambient = atof(value);
+        else if (strcmp(argv[i], "--asymmetry") == 0) options.asymmetry = atof(value);
+        else if (strcmp(argv[i], "--battery") == 0) options.battery = atof(value);
+        else if (strcmp(argv[i], "--sag") == 0) options.sag = atof(value);
+        else if (strcmp(argv[i], "--jitter") == 0) options.jitter = atoi(value);
+        else if (strcmp(argv[i], "--track") == 0) options.track = value;
+        else if (strcmp(argv[i], "--csv") == 0) options.csv = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (options.jobs == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        options.jobs = cores > 0 ? uint32_t(cores) : 1;
+    }
+    if (options.laps == 0) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+
+    // Built once, the forked laps share it
+    Track track = Track::createDefault();
+    if (options.track && !track.load(options.track)) return 1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    std::vector<LapRecord> records;
+    if (!runAll(options, track, records)) {
+        perror("montecarlo");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report(options, records, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+
+    if (options.csv && !writeCsv(options.csv, records)) {
+        fprintf(stderr, "cannot write %s\n", options.csv);
+        return 1;
+    }
+    return 0;
+}
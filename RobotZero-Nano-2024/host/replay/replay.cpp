@@ -0,0 +1,81 @@
+// Feeds a raw sensor capture through the firmware control path and
+// compares the motor commands with the ones recorded on the robot.
+//
+//   replay <capture.csv> [--trace out.csv] [--tolerance N]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "RawCapture.h"
+#include "globals.h"
+
+int main(int argc, char** argv) {
+    const char* capturePath = nullptr;
+    const char* tracePath = nullptr;
+    int tolerance = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atoi(argv[++i]);
+        else capturePath = argv[i];
+    }
+
+    if (!capturePath) {
+        fprintf(stderr, "usage: %s <capture.csv> [--trace out.csv] [--tolerance N]\n", argv[0]);
+        return 2;
+    }
+
+    RawCapture capture;
+    if (!capture.load(capturePath)) {
+        fprintf(stderr, "cannot read capture %s (missing calibration or bad row)\n", capturePath);
+        return 2;
+    }
+    if (capture.lostFrames > 0) {
+        fprintf(stderr, "warning: capture lost %u frames, replay may diverge after gaps\n",
+            capture.lostFrames);
+    }
+
+    FILE* trace = tracePath ? fopen(tracePath, "w") : nullptr;
+    if (trace) {
+        fprintf(trace, "timestamp_us,recorded_left,recorded_right,replay_left,replay_right,speed,precision,laps\n");
+    }
+
+    FirmwareHarness::begin(capture.sensorMin, capture.sensorMax);
+
+    size_t mismatches = 0;
+    size_t firstMismatch = 0;
+    int maxDifference = 0;
+
+    for (size_t i = 0; i < capture.frames.size(); i++) {
+        const RawCaptureFrame& frame = capture.frames[i];
+        FirmwareHarness::step(frame.timestamp, frame.line, frame.markerLeft, frame.markerRight);
+
+        int left = HostHardware::getLeftPower();
+        int right = HostHardware::getRightPower();
+        int difference = max(abs(left - frame.leftPower), abs(right - frame.rightPower));
+
+        if (difference > tolerance) {
+            if (mismatches == 0) firstMismatch = i;
+            mismatches++;
+        }
+        maxDifference = max(maxDifference, difference);
+
+        if (trace) {
+            fprintf(trace, "%u,%d,%d,%d,%d,%d,%d,%d\n", frame.timestamp,
+                frame.leftPower, frame.rightPower, left, right,
+                currentSpeed, isPrecisionMode ? 1 : 0, lapCount);
+        }
+    }
+
+    if (trace) fclose(trace);
+
+    printf("frames: %zu  laps: %d  mismatches: %zu  max difference: %d\n",
+        capture.frames.size(), lapCount, mismatches, maxDifference);
+    if (mismatches > 0) {
+        printf("first mismatch at frame %zu (t=%u us)\n", firstMismatch,
+            capture.frames[firstMismatch].timestamp);
+    }
+
+    return mismatches > 0 ? 1 : 0;
+}
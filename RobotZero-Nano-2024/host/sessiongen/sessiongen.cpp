@@ -0,0 +1,155 @@
+// Simulated season of logged sessions for the log analysis tools.
+//
+// Every session is one run of the host firmware around the simulated
+// track with its own robot variation (battery, motor asymmetry, noise),
+// alternating the analysis and speed profiles. After the run the flash log
+// is sent by FlashReader exactly as the robot does and written to
+// <out>/session_NNNN_<profile>.dump.
+//
+//   sessiongen --out DIR [--sessions N] [--jobs N] [--seed N] [--track file]
+//              [--profile analysis|speed|both]
+//
+// One forked process per session (firmware state is static), needs a
+// POSIX host.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <random>
+#include "FlashReader.h"
+#include "HostHardware.h"
+#include "LapSimulator.h"
+#include "Logger.h"
+#include "config.h"
+
+// Run settings (main.cpp)
+extern DebugMode currentDebugMode;
+
+struct Options {
+    const char* out = nullptr;
+    uint32_t sessions = 200;
+    uint32_t jobs = 0;
+    uint32_t seed = 1;
+    const char* track = nullptr;
+    const char* profile = "both";
+};
+
+static FILE* dumpFile = nullptr;
+
+static void writeDump(uint8_t value) {
+    fputc(value, dumpFile);
+}
+
+static float uniform(std::mt19937& random, float low, float high) {
+    return std::uniform_real_distribution<float>(low, high)(random);
+}
+
+static DebugMode sessionMode(const Options& options, uint32_t session) {
+    if (strcmp(options.profile, "analysis") == 0) return DebugMode::ANALYSIS;
+    if (strcmp(options.profile, "speed") == 0) return DebugMode::SPEED;
+    return (session % 2) ? DebugMode::SPEED : DebugMode::ANALYSIS;
+}
+
+// Runs in the forked child, exit status 0 for a finished lap
+static int runSession(const Options& options, const Track& track, uint32_t session) {
+    std::mt19937 random(options.seed * 1000003u + session);
+    RobotModel::Variation variation;
+    variation.sensorNoise = 10.0f;
+    float asymmetry = uniform(random, -0.03f, 0.03f);
+    variation.motorGainLeft = 1.0f + asymmetry;
+    variation.motorGainRight = 1.0f - asymmetry;
+    variation.batteryLevel = 1.0f - uniform(random, 0.0f, 0.15f);
+    variation.batterySag = uniform(random, 0.0f, 0.10f);
+
+    LapSimulator::Settings settings;
+    settings.latencyJitterUs = 500;
+
+    DebugMode mode = sessionMode(options, session);
+    currentDebugMode = mode;
+    LapSimulator::Result result = LapSimulator::run(track, variation, settings, options.seed + session);
+
+    // Flush what the run left in the log buffers, then send the log
+    Logger::endSession();
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/session_%04u_%s.dump", options.out, session,
+        mode == DebugMode::SPEED ? "speed" : "analysis");
+    dumpFile = fopen(path, "wb");
+    if (!dumpFile) return 2;
+    HostHardware::setSerialSink(writeDump);
+    FlashReader::processCommands();
+    fclose(dumpFile);
+
+    return result.outcome == LapSimulator::Outcome::FINISHED ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--out") == 0) options.out = value;
+        else if (strcmp(argv[i], "--sessions") == 0) options.sessions = atoi(value);
+        else if (strcmp(argv[i], "--jobs") == 0) options.jobs = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = atoi(value);
+        else if (strcmp(argv[i], "--track") == 0) options.track = value;
+        else if (strcmp(argv[i], "--profile") == 0) options.profile = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (!options.out) {
+        fprintf(stderr, "usage: %s --out DIR [--sessions N] [--jobs N] [--seed N] [--track file] "
+            "[--profile analysis|speed|both]\n", argv[0]);
+        return 2;
+    }
+    if (options.jobs == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        options.jobs = cores > 0 ? uint32_t(cores) : 1;
+    }
+    mkdir(options.out, 0777);
+
+    Track track = Track::createDefault();
+    if (options.track && !track.load(options.track)) return 1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    uint32_t next = 0, running = 0, finished = 0, failed = 0;
+    while (next < options.sessions || running > 0) {
+        while (next < options.sessions && running < options.jobs) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("sessiongen");
+                return 1;
+            }
+            if (pid == 0) _exit(runSession(options, track, next));
+            next++;
+            running++;
+        }
+
+        int status;
+        if (wait(&status) < 0) {
+            perror("sessiongen");
+            return 1;
+        }
+        running--;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) finished++;
+        else failed++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%u sessions in %s: %u finished, %u without a full lap (%.1f s)\n",
+        options.sessions, options.out, finished, failed,
+        (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+    return 0;
+}
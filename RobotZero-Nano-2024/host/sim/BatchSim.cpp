@@ -0,0 +1,523 @@
+#include "BatchSim.h"
+#include "config.h"
+#include "LapSimulator.h"
+#include <math.h>
+
+// Speed constants ProfileManager::getSpeedValue() maps to profile fields
+static const int32_t SPEED_CONSTANTS[9] = {
+    SPEED_STOP, SPEED_STARTUP, SPEED_TURN, SPEED_BRAKE, SPEED_CRUISE,
+    SPEED_SLOW, SPEED_FAST, SPEED_BOOST, SPEED_MAX
+};
+
+// Longest walk from the hint when locating a robot on the track
+static const int32_t SEARCH_WINDOW = 40;
+
+BatchSim::BatchSim(const Track& course, uint32_t robots)
+    : track(course), count(robots) {
+    uint32_t points = track.getPointCount();
+    trackX.resize(points);
+    trackY.resize(points);
+    trackCos.resize(points);
+    trackSin.resize(points);
+    for (uint32_t i = 0; i < points; i++) {
+        float heading;
+        track.getPoint(i, trackX[i], trackY[i], heading);
+        trackCos[i] = cosf(heading);
+        trackSin[i] = sinf(heading);
+    }
+
+    for (std::vector<float>* field : { &x, &y, &hx, &hy, &wheelLeft, &wheelRight, &lateral,
+             &alignment, &lastS, &progress, &noise, &ambient, &motorLeft, &motorRight, &battery,
+             &sag }) {
+        field->assign(count, 0.0f);
+    }
+    for (std::vector<int32_t>* field : { &accelerationStep, &brakeStep, &turnSpeed,
+             &turnThreshold, &straightThreshold, &boostDuration, &boostIncrement,
+             &lastValidPosition, &currentSpeed, &isTurning, &isExitingTurn, &boostCountdown,
+             &previousError, &filteredErrorRate, &leftPower, &rightPower, &outputAcceleration,
+             &outputBrake, &leftFiltered, &rightFiltered, &leftDirection, &rightDirection,
+             &leftDeadTime, &rightDeadTime }) {
+        field->assign(count, 0);
+    }
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        gain[i].assign(count, 1.0f);
+        raw[i].assign(count, 0);
+    }
+    for (uint8_t i = 0; i < 9; i++) {
+        speedValue[i].assign(count, SPEED_CONSTANTS[i]);
+    }
+    for (uint8_t i = 0; i < GAIN_SCHEDULE_BUCKETS; i++) {
+        gainKp[i].assign(count, 0);
+        gainKd[i].assign(count, 0);
+        gainFilter[i].assign(count, 0);
+    }
+    hint.assign(count, 0);
+    rng.assign(count, 1);
+    status.assign(count, RUNNING);
+    elapsed.assign(count, 0);
+    lostSteps.assign(count, 0);
+    lapSteps.assign(count, 0);
+    runningSteps.assign(count, 0);
+    errorSum.assign(count, 0);
+}
+
+void BatchSim::setRobot(uint32_t robot, const SpeedProfile& profile, const GainSchedule& gains,
+    const RobotModel::Variation& variation, uint32_t seed) {
+    const uint8_t speeds[9] = {
+        profile.speedStop, profile.speedStartup, profile.speedTurn, profile.speedBrake,
+        profile.speedCruise, profile.speedSlow, profile.speedFast, profile.speedBoost,
+        profile.speedMax
+    };
+    for (uint8_t i = 0; i < 9; i++) speedValue[i][robot] = speeds[i];
+
+    accelerationStep[robot] = profile.accelerationStep;
+    brakeStep[robot] = profile.brakeStep;
+    outputAcceleration[robot] = profile.accelerationStep;
+    outputBrake[robot] = profile.brakeStep;
+    turnSpeed[robot] = profile.turnSpeed;
+    turnThreshold[robot] = profile.turnThreshold;
+    straightThreshold[robot] = profile.straightThreshold;
+    boostDuration[robot] = profile.boostDuration;
+    boostIncrement[robot] = profile.boostIncrement;
+    for (uint8_t i = 0; i < GAIN_SCHEDULE_BUCKETS; i++) {
+        gainKp[i][robot] = gains.point[i].kp;
+        gainKd[i][robot] = gains.point[i].kd;
+        gainFilter[i][robot] = gains.point[i].filter;
+    }
+
+    noise[robot] = variation.sensorNoise;
+    ambient[robot] = variation.ambientOffset;
+    motorLeft[robot] = variation.motorGainLeft;
+    motorRight[robot] = variation.motorGainRight;
+    battery[robot] = variation.batteryLevel;
+    sag[robot] = variation.batterySag;
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) gain[i][robot] = variation.sensorGain[i];
+    rng[robot] = seed ? seed : 1;
+}
+
+void BatchSim::setOutputLimits(uint32_t robot, uint8_t accelerationStep, uint8_t brakeStep) {
+    outputAcceleration[robot] = accelerationStep;
+    outputBrake[robot] = brakeStep;
+}
+
+SpeedProfile BatchSim::firmwareProfile(const SpeedProfile& speeds) {
+    SpeedProfile profile = speeds;
+    profile.accelerationStep = ACCELERATION_STEP;
+    profile.brakeStep = BRAKE_STEP;
+    profile.turnSpeed = TURN_SPEED;
+    profile.turnThreshold = TURN_THRESHOLD;
+    profile.straightThreshold = STRAIGHT_THRESHOLD;
+    profile.boostDuration = BOOST_DURATION;
+    profile.boostIncrement = BOOST_INCREMENT;
+    return profile;
+}
+
+void BatchSim::reset(float s) {
+    float px, py, heading;
+    track.getPose(s, px, py, heading);
+
+    for (uint32_t i = 0; i < count; i++) {
+        // Sensor bar on the line, axle behind it
+        hx[i] = cosf(heading);
+        hy[i] = sinf(heading);
+        x[i] = px - RobotModel::SENSOR_OFFSET_MM * hx[i];
+        y[i] = py - RobotModel::SENSOR_OFFSET_MM * hy[i];
+        wheelLeft[i] = wheelRight[i] = 0.0f;
+        hint[i] = uint32_t(s / track.getSpacing()) % track.getPointCount();
+        lastS[i] = s;
+        progress[i] = 0.0f;
+
+        // Same start as startRun(): mapped BASE_FAST and cleared state
+        int32_t speed = BASE_FAST;
+        for (uint8_t k = 0; k < 9; k++) {
+            if (BASE_FAST == SPEED_CONSTANTS[k]) speed = speedValue[k][i];
+        }
+        currentSpeed[i] = speed;
+        lastValidPosition[i] = 0;
+        isTurning[i] = isExitingTurn[i] = boostCountdown[i] = 0;
+        previousError[i] = filteredErrorRate[i] = 0;
+        leftPower[i] = rightPower[i] = 0;
+        leftFiltered[i] = rightFiltered[i] = 0;
+        leftDirection[i] = rightDirection[i] = 0;
+        leftDeadTime[i] = rightDeadTime[i] = 0;
+        status[i] = RUNNING;
+        elapsed[i] = lostSteps[i] = lapSteps[i] = 0;
+        runningSteps[i] = errorSum[i] = 0;
+    }
+}
+
+float BatchSim::getMeanError(uint32_t robot) const {
+    return runningSteps[robot] ? float(errorSum[robot]) / runningSteps[robot] : 0.0f;
+}
+
+void BatchSim::run(uint32_t begin, uint32_t end, uint32_t steps) {
+    for (uint32_t step = 0; step < steps; step++) {
+        locate(begin, end);
+        sense(begin, end);
+        control(begin, end);
+        move(begin, end);
+        judge(begin, end);
+    }
+}
+
+// Closest track point to each sensor bar (scalar, walks the polyline)
+void BatchSim::locate(uint32_t begin, uint32_t end) {
+    int32_t points = int32_t(trackX.size());
+    float length = track.getLength();
+    float spacing = track.getSpacing();
+
+    for (uint32_t i = begin; i < end; i++) {
+        float bx = x[i] + RobotModel::SENSOR_OFFSET_MM * hx[i];
+        float by = y[i] + RobotModel::SENSOR_OFFSET_MM * hy[i];
+
+        int32_t best = int32_t(hint[i]);
+        float dx = bx - trackX[best], dy = by - trackY[best];
+        float bestDistance = dx * dx + dy * dy;
+        for (int32_t direction = -1; direction <= 1; direction += 2) {
+            for (int32_t walked = 0; walked < SEARCH_WINDOW; walked++) {
+                int32_t index = (best + direction + points) % points;
+                dx = bx - trackX[index];
+                dy = by - trackY[index];
+                float distance = dx * dx + dy * dy;
+                if (distance >= bestDistance) break;
+                best = index;
+                bestDistance = distance;
+            }
+        }
+        hint[i] = uint32_t(best);
+
+        dx = bx - trackX[best];
+        dy = by - trackY[best];
+        float tc = trackCos[best], ts = trackSin[best];
+        lateral[i] = dx * ts - dy * tc;
+        alignment[i] = hx[i] * tc + hy[i] * ts;
+
+        // Unwrapped distance along the track
+        float s = best * spacing + dx * tc + dy * ts;
+        float ds = s - lastS[i];
+        if (ds > length * 0.5f) ds -= length;
+        if (ds < -length * 0.5f) ds += length;
+        progress[i] += ds;
+        lastS[i] = s;
+    }
+}
+
+// Raw ADC values for the six line sensors
+void BatchSim::sense(uint32_t begin, uint32_t end) {
+    const float contrast = RobotModel::SENSOR_MAX - RobotModel::SENSOR_MIN;
+    const float spread = 1.0f / RobotModel::SENSOR_SPREAD_MM;
+    const float* __restrict lat = lateral.data();
+    const float* __restrict align = alignment.data();
+    const float* __restrict sigma = noise.data();
+    const float* __restrict offset = ambient.data();
+    uint32_t* __restrict state = rng.data();
+
+    for (uint8_t k = 0; k < NUM_SENSORES; k++) {
+        const float position = RobotModel::SENSOR_POSITION_MM[k];
+        const float* __restrict sensorGain = gain[k].data();
+        int32_t* __restrict out = raw[k].data();
+
+#pragma GCC ivdep
+        for (uint32_t i = begin; i < end; i++) {
+            // Sensor bar is square to the robot, sensors spread by the heading error
+            float d = (lat[i] + position * align[i]) * spread;
+            float d2 = d * d;
+            float coverage = 1.0f / (1.0f + d2 + 0.5f * d2 * d2);  // ~exp(-d^2), no libm call
+
+            // Triangular noise from two xorshift draws, unit variance
+            uint32_t r = state[i];
+            r ^= r << 13;
+            r ^= r >> 17;
+            r ^= r << 5;
+            float u1 = float(r & 0xFFFF) * (1.0f / 65536.0f);
+            float u2 = float(r >> 16) * (1.0f / 65536.0f);
+            state[i] = r;
+
+            float value = RobotModel::SENSOR_MAX - coverage * sensorGain[i] * contrast +
+                offset[i] + sigma[i] * 2.4494897f * (u1 + u2 - 1.0f);
+            value = value < 0.0f ? 0.0f : value;
+            value = value > 1023.0f ? 1023.0f : value;
+            out[i] = int32_t(value);
+        }
+    }
+}
+
+// MotorDriver::limitWheel and updateWheel for one wheel, arithmetic selects
+// keep the control loop free of branches
+static inline int32_t limitOutput(int32_t power, int32_t target, int32_t accelerationStep,
+    int32_t brakeStep, int32_t& filtered, int32_t& direction, int32_t& deadTime) {
+    // int16_t in the firmware, never outside +-255 << 7
+    filtered += ((target << 7) - filtered) >> MOTOR_OUTPUT_FILTER_SHIFT;
+    target = (filtered + 64) >> 7;
+
+    int32_t targetSign = (target > 0) - (target < 0);
+    int32_t powerSign = (power > 0) - (power < 0);
+    int32_t reversing = (powerSign * targetSign) < 0;
+    int32_t holding = (powerSign == 0) & (targetSign != 0) & (deadTime > 0) & (targetSign != direction);
+    target -= (reversing | holding) * target;
+
+    int32_t absPower = power * powerSign;
+    int32_t absTarget = target < 0 ? -target : target;
+    int32_t step = absTarget > absPower ? accelerationStep : brakeStep;
+    int32_t difference = target - power;
+    int32_t absDifference = difference < 0 ? -difference : difference;
+    int32_t output = absDifference <= step ? target : power + (target > power ? step : -step);
+
+    int32_t outputSign = (output > 0) - (output < 0);
+    int32_t moving = outputSign != 0;
+    int32_t counted = deadTime - (deadTime > 0);
+    direction += moving * (outputSign - direction);
+    deadTime = counted + moving * (MOTOR_REVERSE_DEAD_TIME - counted);
+    return output;
+}
+
+// Firmware control path, one control period
+void BatchSim::control(uint32_t begin, uint32_t end) {
+    // Calibration and readings in sensor counts of the acquisition mode
+    const float minimum = RobotModel::SENSOR_MIN >> SENSOR_ADC_SHIFT;
+    const float range = (RobotModel::SENSOR_MAX >> SENSOR_ADC_SHIFT) - (RobotModel::SENSOR_MIN >> SENSOR_ADC_SHIFT);
+    const int32_t* __restrict s0 = raw[0].data();
+    const int32_t* __restrict s1 = raw[1].data();
+    const int32_t* __restrict s2 = raw[2].data();
+    const int32_t* __restrict s3 = raw[3].data();
+    const int32_t* __restrict s4 = raw[4].data();
+    const int32_t* __restrict s5 = raw[5].data();
+    int32_t* __restrict lastValid = lastValidPosition.data();
+    int32_t* __restrict speedState = currentSpeed.data();
+    int32_t* __restrict turning = isTurning.data();
+    int32_t* __restrict exiting = isExitingTurn.data();
+    int32_t* __restrict boost = boostCountdown.data();
+    int32_t* __restrict previous = previousError.data();
+    int32_t* __restrict filtered = filteredErrorRate.data();
+    int32_t* __restrict left = leftPower.data();
+    int32_t* __restrict right = rightPower.data();
+    int32_t* __restrict leftMean = leftFiltered.data();
+    int32_t* __restrict rightMean = rightFiltered.data();
+    int32_t* __restrict leftSign = leftDirection.data();
+    int32_t* __restrict rightSign = rightDirection.data();
+    int32_t* __restrict leftHold = leftDeadTime.data();
+    int32_t* __restrict rightHold = rightDeadTime.data();
+    const int32_t* __restrict outputAccel = outputAcceleration.data();
+    const int32_t* __restrict outputBrakeStep = outputBrake.data();
+    const int32_t* __restrict accel = accelerationStep.data();
+    const int32_t* __restrict brake = brakeStep.data();
+    const int32_t* __restrict turnValue = turnSpeed.data();
+    const int32_t* __restrict turnLimit = turnThreshold.data();
+    const int32_t* __restrict straightLimit = straightThreshold.data();
+    const int32_t* __restrict boostSteps = boostDuration.data();
+    const int32_t* __restrict boostValue = boostIncrement.data();
+    const int32_t* __restrict map0 = speedValue[0].data();
+    const int32_t* __restrict map1 = speedValue[1].data();
+    const int32_t* __restrict map2 = speedValue[2].data();
+    const int32_t* __restrict map3 = speedValue[3].data();
+    const int32_t* __restrict map4 = speedValue[4].data();
+    const int32_t* __restrict map5 = speedValue[5].data();
+    const int32_t* __restrict map6 = speedValue[6].data();
+    const int32_t* __restrict map7 = speedValue[7].data();
+    const int32_t* __restrict map8 = speedValue[8].data();
+    const int32_t* __restrict kpTable[GAIN_SCHEDULE_BUCKETS];
+    const int32_t* __restrict kdTable[GAIN_SCHEDULE_BUCKETS];
+    const int32_t* __restrict filterTable[GAIN_SCHEDULE_BUCKETS];
+    for (uint8_t k = 0; k < GAIN_SCHEDULE_BUCKETS; k++) {
+        kpTable[k] = gainKp[k].data();
+        kdTable[k] = gainKd[k].data();
+        filterTable[k] = gainFilter[k].data();
+    }
+
+#pragma GCC ivdep
+    for (uint32_t i = begin; i < end; i++) {
+        // Sensors::readSensors: clamp to calibration, map to 100 (line) .. 0.
+        // The integer map() division is done in float, exact for these ranges.
+        int32_t p[NUM_SENSORES] = { s0[i], s1[i], s2[i], s3[i], s4[i], s5[i] };
+        int32_t sum = 0;
+        for (uint8_t k = 0; k < NUM_SENSORES; k++) {
+            float v = float(p[k] >> SENSOR_ADC_SHIFT);
+            v = v < minimum ? minimum : v;
+            v = v > minimum + range ? minimum + range : v;
+            p[k] = int32_t((v - minimum) * -100.0f / range) + 100;
+            sum += p[k];
+        }
+
+        // Sensors::calculateLinePosition, same evaluation order
+        float avg = SENSOR_WEIGHT_S1 * float(p[0]) + SENSOR_WEIGHT_S2 * float(p[1]) +
+            SENSOR_WEIGHT_S3 * float(p[2]) + SENSOR_WEIGHT_S4 * float(p[3]) +
+            SENSOR_WEIGHT_S5 * float(p[4]) + SENSOR_WEIGHT_S6 * float(p[5]);
+        float divisor = float(sum);
+        float ratio = 100.0f * avg / (divisor < 1.0f ? 1.0f : divisor);
+        ratio = ratio < -100.0f ? -100.0f : ratio;
+        ratio = ratio > 100.0f ? 100.0f : ratio;
+        int32_t lostPosition = lastValid[i] < 0 ? -100 : 100;
+        int32_t error = (sum > SENSOR_THRESHOLD) ? int32_t(ratio) : lostPosition;
+        lastValid[i] = error;
+
+        // Every field is loaded up front so the selects below need no branches
+        int32_t turnLimitValue = turnLimit[i], straightLimitValue = straightLimit[i];
+        int32_t turnSpeedValue = turnValue[i], wasTurning = turning[i];
+        int32_t wasExiting = exiting[i], boostLeft = boost[i];
+        int32_t speed = speedState[i], accelValue = accel[i], brakeValue = brake[i];
+        int32_t boostStepsValue = boostSteps[i], boostIncrementValue = boostValue[i];
+        int32_t speeds[9] = { map0[i], map1[i], map2[i], map3[i], map4[i],
+            map5[i], map6[i], map7[i], map8[i] };
+
+        // CourseMarkers::speedControl with the profile's control fields
+        int32_t absError = error < 0 ? -error : error;
+        absError = absError > SPEED_CURVE_MAX_ERROR ? SPEED_CURVE_MAX_ERROR : absError;
+        int32_t curve = absError > turnLimitValue;
+        int32_t straight = (curve ^ 1) & (absError < straightLimitValue);
+        int32_t enterBoost = straight & (wasTurning != 0);
+
+        int32_t exitingNow = (curve ^ 1) & (enterBoost | wasExiting);
+        int32_t boostNow = enterBoost ? boostStepsValue : boostLeft;
+        int32_t turningNow = curve | (wasTurning & (straight ^ 1));
+
+        float span = float(turnLimitValue > straightLimitValue ? turnLimitValue - straightLimitValue : 1);
+        int32_t linear = BASE_FAST + int32_t(float((absError - straightLimitValue) *
+            (turnSpeedValue - BASE_FAST)) / span);
+        int32_t target = straight ? BASE_FAST : linear;
+
+        int32_t boosting = (curve ^ 1) & exitingNow & (boostNow > 0);
+        int32_t boosted = target + boostIncrementValue;
+        target = boosting ? (boosted < 255 ? boosted : 255) : target;
+        boostNow -= boosting;
+
+        int32_t stepSize = target > speed ? accelValue : brakeValue;
+        int32_t difference = target - speed;
+        int32_t absDifference = difference < 0 ? -difference : difference;
+        int32_t stepped = absDifference <= stepSize ? target : speed + (target > speed ? stepSize : -stepSize);
+        stepped = stepped < turnSpeedValue ? turnSpeedValue : stepped;
+        stepped = stepped > BASE_FAST ? BASE_FAST : stepped;
+        int32_t requested = curve ? turnSpeedValue : stepped;
+
+        turning[i] = turningNow;
+        exiting[i] = exitingNow;
+        boost[i] = boostNow;
+
+        // ProfileManager::getSpeedValue
+        int32_t mapped = requested > speeds[8] ? speeds[8] : (requested < 0 ? 0 : requested);
+        for (uint8_t k = 0; k < 9; k++) {
+            // Arithmetic select, a ternary chain here becomes a switch
+            mapped += (requested == SPEED_CONSTANTS[k]) * (speeds[k] - mapped);
+        }
+        speedState[i] = mapped;
+
+        // PidController::interpolateGains, bucket picked by arithmetic select
+        int32_t bucket = mapped >> GAIN_SCHEDULE_SHIFT;
+        int32_t weight = mapped & ((1 << GAIN_SCHEDULE_SHIFT) - 1);
+        int32_t kpLow = 0, kpHigh = 0, kdLow = 0, kdHigh = 0, filterLow = 0, filterHigh = 0;
+        for (uint8_t k = 0; k + 1 < GAIN_SCHEDULE_BUCKETS; k++) {
+            int32_t select = bucket == k;
+            kpLow += select * kpTable[k][i];
+            kpHigh += select * kpTable[k + 1][i];
+            kdLow += select * kdTable[k][i];
+            kdHigh += select * kdTable[k + 1][i];
+            filterLow += select * filterTable[k][i];
+            filterHigh += select * filterTable[k + 1][i];
+        }
+        int32_t kp = kpLow + ((kpHigh - kpLow) * weight >> GAIN_SCHEDULE_SHIFT);
+        int32_t kd = kdLow + ((kdHigh - kdLow) * weight >> GAIN_SCHEDULE_SHIFT);
+        int32_t filter = filterLow + ((filterHigh - filterLow) * weight >> GAIN_SCHEDULE_SHIFT);
+
+        // PidController::update at the nominal period (dt scale exactly 1)
+        const int32_t filterOne = 1 << GAIN_FILTER_FRACTION_BITS;
+        int32_t errorChange = error - previous[i];
+        int32_t rate = (filter * errorChange + (filterOne - filter) * filtered[i]) / filterOne;
+        filtered[i] = rate;
+        int32_t total = (kp * error + kd * rate * (1 << (GAIN_KP_FRACTION_BITS - GAIN_KD_FRACTION_BITS))) /
+            (1 << GAIN_KP_FRACTION_BITS);
+        int32_t correction = total < -255 ? -255 : (total > 255 ? 255 : total);
+        previous[i] = error;
+
+        int32_t leftValue = mapped + correction;
+        int32_t rightValue = mapped - correction;
+        leftValue = leftValue < -255 ? -255 : (leftValue > 255 ? 255 : leftValue);
+        rightValue = rightValue < -255 ? -255 : (rightValue > 255 ? 255 : rightValue);
+
+        // MotorDriver::setMotorsPower output stage
+        left[i] = limitOutput(left[i], leftValue, outputAccel[i], outputBrakeStep[i],
+            leftMean[i], leftSign[i], leftHold[i]);
+        right[i] = limitOutput(right[i], rightValue, outputAccel[i], outputBrakeStep[i],
+            rightMean[i], rightSign[i], rightHold[i]);
+    }
+}
+
+// Motors and differential-drive kinematics, same model as RobotModel::step
+void BatchSim::move(uint32_t begin, uint32_t end) {
+    const float dt = STEP_SECONDS;
+    const float response = dt / (RobotModel::MOTOR_TIME_CONSTANT_S + dt);
+    const float scale = RobotModel::MAX_SPEED_MM_S / 255.0f;
+    float* __restrict px = x.data();
+    float* __restrict py = y.data();
+    float* __restrict cx = hx.data();
+    float* __restrict cy = hy.data();
+    float* __restrict vl = wheelLeft.data();
+    float* __restrict vr = wheelRight.data();
+    const int32_t* __restrict left = leftPower.data();
+    const int32_t* __restrict right = rightPower.data();
+    const float* __restrict gainLeft = motorLeft.data();
+    const float* __restrict gainRight = motorRight.data();
+    const float* __restrict level = battery.data();
+    const float* __restrict drop = sag.data();
+
+#pragma GCC ivdep
+    for (uint32_t i = begin; i < end; i++) {
+        float l = float(left[i]);
+        float r = float(right[i]);
+        float load = ((l < 0 ? -l : l) + (r < 0 ? -r : r)) * (1.0f / 510.0f);
+        float supply = level[i] * (1.0f - drop[i] * load);
+
+        vl[i] += (l * scale * supply * gainLeft[i] - vl[i]) * response;
+        vr[i] += (r * scale * supply * gainRight[i] - vr[i]) * response;
+
+        float speed = (vl[i] + vr[i]) * 0.5f;
+        float angle = (vr[i] - vl[i]) * (1.0f / RobotModel::WHEEL_BASE_MM) * dt;
+
+        // Move along the mid-step heading, rotations by series expansion
+        float half = angle * 0.5f;
+        float ch = 1.0f - half * half * 0.5f;
+        float sh = half - half * half * half * (1.0f / 6.0f);
+        px[i] += speed * dt * (cx[i] * ch - cy[i] * sh);
+        py[i] += speed * dt * (cy[i] * ch + cx[i] * sh);
+
+        float c = 1.0f - angle * angle * 0.5f;
+        float s = angle - angle * angle * angle * (1.0f / 6.0f);
+        float nx = cx[i] * c - cy[i] * s;
+        float ny = cy[i] * c + cx[i] * s;
+        float norm = 1.0f / sqrtf(nx * nx + ny * ny);
+        cx[i] = nx * norm;
+        cy[i] = ny * norm;
+    }
+}
+
+// Record finished laps and lost lines
+void BatchSim::judge(uint32_t begin, uint32_t end) {
+    const float length = track.getLength();
+    const float* __restrict lat = lateral.data();
+    const float* __restrict done = progress.data();
+    uint8_t* __restrict state = status.data();
+    uint32_t* __restrict time = elapsed.data();
+    uint32_t* __restrict lost = lostSteps.data();
+    uint32_t* __restrict lap = lapSteps.data();
+    uint32_t* __restrict active = runningSteps.data();
+    uint32_t* __restrict errors = errorSum.data();
+    const int32_t* __restrict error = lastValidPosition.data();
+
+#pragma GCC ivdep
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t now = time[i] + 1;
+        uint8_t current = state[i];
+        uint32_t lostBefore = lost[i];
+        uint32_t lapBefore = lap[i];
+        uint32_t lostNow = (fabsf(lat[i]) > LapSimulator::LINE_LOST_MM) * (lostBefore + 1);
+        uint32_t isLost = lostNow >= LINE_LOST_STEPS;
+        uint32_t isFinished = (isLost ^ 1) & (done[i] >= length);
+        uint32_t running = current == RUNNING;
+
+        // Arithmetic selects keep the loop branch free
+        time[i] = now;
+        lost[i] = lostBefore + running * (lostNow - lostBefore);
+        lap[i] = lapBefore + (running & isFinished) * (now - lapBefore);
+        active[i] += running;
+        errors[i] += running * uint32_t(error[i] < 0 ? -error[i] : error[i]);
+        state[i] = uint8_t(current + running * (isLost * LINE_LOST + isFinished * FINISHED));
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef BATCHSIM_H
+#define BATCHSIM_H
+
+#include <stdint.h>
+#include <vector>
+#include "config.h"
+#include "DataStructures.h"
+#include "GainSchedule.h"
+#include "RobotModel.h"
+#include "Track.h"
+
+// Steps many simulated robots at once for parameter sweeps.
+//
+// State is kept as structure of arrays, one array per field with one entry
+// per robot, so the sensor, control and kinematics kernels are plain loops
+// over robots that the compiler vectorizes. The control kernel mirrors the
+// firmware path (Sensors::readSensors/calculateLinePosition,
+// CourseMarkers::speedControl, ProfileManager::getSpeedValue,
+// PidController::update with its gain schedule and the MotorDriver output
+// stage) at the nominal control period.
+//
+// Differences from the firmware: every SpeedProfile field is used, where
+// speedControl() reads the config.h constants for the control fields, and
+// markers are not simulated. A lap ends after one track length.
+class BatchSim {
+public:
+    enum Status : uint8_t {
+        RUNNING,
+        FINISHED,
+        LINE_LOST
+    };
+
+    BatchSim(const Track& track, uint32_t count);
+
+    // Per-robot parameters, call before reset(). The profile's own PID
+    // gains are unused, the firmware takes them from the gain schedule.
+    void setRobot(uint32_t robot, const SpeedProfile& profile, const GainSchedule& gains,
+        const RobotModel::Variation& variation, uint32_t seed);
+
+    // SpeedProfile whose control fields match the firmware's config.h constants
+    static SpeedProfile firmwareProfile(const SpeedProfile& speeds);
+
+    // Output stage steps, setRobot() takes the profile's acceleration and
+    // brake steps. The firmware's output stage uses the active profile even
+    // where firmwareProfile() puts the constants in for speedControl().
+    void setOutputLimits(uint32_t robot, uint8_t accelerationStep, uint8_t brakeStep);
+
+    // Put every robot on the line at arc length s
+    void reset(float s);
+
+    // Advance robots [begin, end) by the given number of control periods.
+    // Ranges are independent, so threads may run disjoint ranges.
+    void run(uint32_t begin, uint32_t end, uint32_t steps);
+
+    uint32_t getCount() const { return count; }
+    Status getStatus(uint32_t robot) const { return Status(status[robot]); }
+    uint32_t getLapSteps(uint32_t robot) const { return lapSteps[robot]; }
+
+    // Mean |line error| over the steps run since reset()
+    float getMeanError(uint32_t robot) const;
+
+    // Inputs and outputs of the last step, for comparison with the firmware
+    int16_t getRawSensor(uint32_t robot, uint8_t sensor) const { return int16_t(raw[sensor][robot]); }
+    int16_t getLeftPower(uint32_t robot) const { return int16_t(leftPower[robot]); }
+    int16_t getRightPower(uint32_t robot) const { return int16_t(rightPower[robot]); }
+    int16_t getSpeed(uint32_t robot) const { return int16_t(currentSpeed[robot]); }
+
+    static constexpr float STEP_SECONDS = TASK_PERIOD_CONTROL_US * 1e-6f;
+    static constexpr uint32_t LINE_LOST_STEPS = 300;
+
+private:
+    const Track& track;
+    uint32_t count;
+
+    // Track polyline
+    std::vector<float> trackX, trackY, trackCos, trackSin;
+
+    // Pose, heading as a unit vector, wheel speeds (mm/s)
+    std::vector<float> x, y, hx, hy, wheelLeft, wheelRight;
+
+    // Position relative to the track
+    std::vector<uint32_t> hint;
+    std::vector<float> lateral, alignment, lastS, progress;
+
+    // Variation
+    std::vector<float> noise, ambient, motorLeft, motorRight, battery, sag;
+    std::vector<float> gain[NUM_SENSORES];
+    std::vector<uint32_t> rng;
+
+    // Profile
+    std::vector<int32_t> speedValue[9];
+    std::vector<int32_t> accelerationStep, brakeStep, turnSpeed, turnThreshold,
+        straightThreshold, boostDuration, boostIncrement;
+    std::vector<int32_t> gainKp[GAIN_SCHEDULE_BUCKETS], gainKd[GAIN_SCHEDULE_BUCKETS],
+        gainFilter[GAIN_SCHEDULE_BUCKETS];
+
+    // Controller state, same meaning as the firmware statics
+    std::vector<int32_t> raw[NUM_SENSORES];
+    std::vector<int32_t> lastValidPosition, currentSpeed, isTurning, isExitingTurn,
+        boostCountdown, previousError, filteredErrorRate;
+    std::vector<int32_t> leftPower, rightPower;
+
+    // MotorDriver output stage
+    std::vector<int32_t> outputAcceleration, outputBrake;
+    std::vector<int32_t> leftFiltered, rightFiltered, leftDirection, rightDirection,
+        leftDeadTime, rightDeadTime;
+
+    // Outcome
+    std::vector<uint8_t> status;
+    std::vector<uint32_t> elapsed, lostSteps, lapSteps, runningSteps, errorSum;
+
+    void locate(uint32_t begin, uint32_t end);
+    void sense(uint32_t begin, uint32_t end);
+    void control(uint32_t begin, uint32_t end);
+    void move(uint32_t begin, uint32_t end);
+    void judge(uint32_t begin, uint32_t end);
+};
+
+#endif // BATCHSIM_H
@@ -0,0 +1,81 @@
+#include "LapSimulator.h"
+#include "FirmwareHarness.h"
+#include "HostHardware.h"
+#include "globals.h"
+#include <math.h>
+#include <random>
+
+LapSimulator::Result LapSimulator::run(const Track& track, const RobotModel::Variation& variation,
+    const Settings& settings, uint32_t seed) {
+    RobotModel robot(track, variation, seed);
+    std::mt19937 random(seed ^ 0x9E3779B9u);
+    std::uniform_int_distribution<uint32_t> jitter(0, settings.latencyJitterUs);
+
+    int16_t sensorMin[6], sensorMax[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        sensorMin[i] = RobotModel::SENSOR_MIN;
+        sensorMax[i] = RobotModel::SENSOR_MAX;
+    }
+    FirmwareHarness::begin(sensorMin, sensorMax);
+    robot.place(track.getLength() + settings.startOffset);
+
+    Result result = { Outcome::TIMEOUT, 0, 0.0f, 0.0f };
+    int16_t appliedLeft = 0, appliedRight = 0;
+    int16_t pendingLeft = 0, pendingRight = 0;
+    uint32_t applyAt = 0;
+    uint32_t lostSince = 0;
+    uint32_t firstFinish = 0;
+    float firstFinishDistance = 0.0f;
+    bool lost = false;
+    float dt = settings.physicsStepUs * 1e-6f;
+
+    for (uint32_t now = settings.physicsStepUs; now < settings.timeLimitUs; now += settings.physicsStepUs) {
+        RobotModel::Readings readings;
+        robot.read(readings);
+        FirmwareHarness::step(now, readings.line, readings.markerLeft, readings.markerRight);
+
+        // New motor commands reach the wheels after the loop latency
+        int16_t left = HostHardware::getLeftPower();
+        int16_t right = HostHardware::getRightPower();
+        if (left != pendingLeft || right != pendingRight) {
+            pendingLeft = left;
+            pendingRight = right;
+            applyAt = now + jitter(random);
+        }
+        if ((int32_t)(now - applyAt) >= 0) {
+            appliedLeft = pendingLeft;
+            appliedRight = pendingRight;
+        }
+        robot.step(dt, appliedLeft, appliedRight);
+
+        float offset = fabsf(robot.getProjection().lateral);
+        if (offset > result.maxLateral) result.maxLateral = offset;
+
+        // Off the line for too long
+        if (offset > LINE_LOST_MM) {
+            if (!lost) lostSince = now;
+            lost = true;
+            if (now - lostSince >= LINE_LOST_TIMEOUT_US) {
+                result.outcome = Outcome::LINE_LOST;
+                break;
+            }
+        }
+        else {
+            lost = false;
+        }
+
+        if (lapCount == 1 && firstFinish == 0) {
+            firstFinish = now;
+            firstFinishDistance = robot.getDistance();
+        }
+        else if (lapCount >= 2) {
+            bool fullLap = robot.getDistance() - firstFinishDistance >= track.getLength() * MIN_LAP_FRACTION;
+            result.outcome = fullLap ? Outcome::FINISHED : Outcome::FALSE_FINISH;
+            result.lapTimeUs = now - firstFinish;
+            break;
+        }
+    }
+
+    result.distance = robot.getDistance();
+    return result;
+}
@@ -0,0 +1,44 @@
+#ifndef LAPSIMULATOR_H
+#define LAPSIMULATOR_H
+
+#include <stdint.h>
+#include "RobotModel.h"
+#include "Track.h"
+
+// Closed-loop lap of the real firmware around a simulated track.
+// Uses FirmwareHarness, so only one lap can run per process.
+class LapSimulator {
+public:
+    enum class Outcome : uint8_t {
+        FINISHED,     // Two finish markers seen
+        LINE_LOST,    // Sensor bar off the line for too long
+        FALSE_FINISH, // Second finish counted well before a full lap
+        TIMEOUT       // No finish within the time limit
+    };
+
+    struct Settings {
+        uint32_t physicsStepUs = 100;     // Model and loop() call period
+        uint32_t latencyJitterUs = 0;     // Random motor command delay, 0..N
+        uint32_t timeLimitUs = 60000000;
+        float startOffset = -150.0f;      // Start this far before the finish line
+    };
+
+    struct Result {
+        Outcome outcome;
+        uint32_t lapTimeUs;       // Between the first and second finish marker
+        float maxLateral;         // Largest |offset| of the sensor bar (mm)
+        float distance;           // Distance driven (mm)
+    };
+
+    static Result run(const Track& track, const RobotModel::Variation& variation,
+        const Settings& settings, uint32_t seed);
+
+    // Sensor bar offset that counts as off the line, and for how long
+    static constexpr float LINE_LOST_MM = 45.0f;
+    static constexpr uint32_t LINE_LOST_TIMEOUT_US = 300000;
+
+    // Shortest distance between finish markers that counts as a lap
+    static constexpr float MIN_LAP_FRACTION = 0.9f;
+};
+
+#endif // LAPSIMULATOR_H
@@ -0,0 +1,92 @@
+#include "RobotModel.h"
+#include <math.h>
+
+constexpr float RobotModel::SENSOR_POSITION_MM[6];
+
+RobotModel::RobotModel(const Track& course, const Variation& runVariation, uint32_t seed)
+    : track(course), variation(runVariation), random(seed), noise(0.0f, 1.0f) {
+}
+
+void RobotModel::place(float s, float lateral) {
+    float cx, cy;
+    track.getPose(s, cx, cy, heading);
+
+    // Put the sensor bar, not the axle, at s
+    x = cx + lateral * sinf(heading) - SENSOR_OFFSET_MM * cosf(heading);
+    y = cy - lateral * cosf(heading) - SENSOR_OFFSET_MM * sinf(heading);
+    speedLeft = speedRight = 0.0f;
+    distance = 0.0f;
+
+    float px, py;
+    sensorPoint(0.0f, px, py);
+    projection = track.project(px, py, uint32_t(s / 5.0f));
+}
+
+void RobotModel::step(float dt, int16_t leftPower, int16_t rightPower) {
+    // Supply drops with the load on the motors
+    float load = (fabsf(leftPower) + fabsf(rightPower)) / 510.0f;
+    float supply = variation.batteryLevel * (1.0f - variation.batterySag * load);
+
+    float targetLeft = leftPower / 255.0f * MAX_SPEED_MM_S * supply * variation.motorGainLeft;
+    float targetRight = rightPower / 255.0f * MAX_SPEED_MM_S * supply * variation.motorGainRight;
+    float response = dt / (MOTOR_TIME_CONSTANT_S + dt);
+    speedLeft += (targetLeft - speedLeft) * response;
+    speedRight += (targetRight - speedRight) * response;
+
+    float speed = (speedLeft + speedRight) * 0.5f;
+    float turnRate = (speedRight - speedLeft) / WHEEL_BASE_MM;
+    float midHeading = heading + turnRate * dt * 0.5f;
+    x += speed * dt * cosf(midHeading);
+    y += speed * dt * sinf(midHeading);
+    heading += turnRate * dt;
+    distance += speed * dt;
+
+    float px, py;
+    sensorPoint(0.0f, px, py);
+    projection = track.project(px, py, projection.index);
+}
+
+void RobotModel::read(Readings& readings) {
+    // Every sensor point goes through the track's grid index, so crossings
+    // and sharp corners read whichever line is actually under the sensor
+    Track::Projection point;
+    for (uint8_t i = 0; i < 6; i++) {
+        float px, py;
+        sensorPoint(SENSOR_POSITION_MM[i], px, py);
+        float coverage = 0.0f;
+        if (track.locate(px, py, point)) {
+            float lateral = point.lateral / SENSOR_SPREAD_MM;
+            coverage = expf(-lateral * lateral);
+        }
+        readings.line[i] = reflectance(coverage, variation.sensorGain[i]);
+    }
+
+    // Marker sensors sit next to the outer line sensors and also see a
+    // crossing line
+    float px, py;
+    sensorPoint(-Track::MARKER_LATERAL_MM, px, py);
+    readings.markerLeft = reflectance(isDark(px, py) ? 1.0f : 0.0f, 1.0f);
+
+    sensorPoint(Track::MARKER_LATERAL_MM, px, py);
+    readings.markerRight = reflectance(isDark(px, py) ? 1.0f : 0.0f, 1.0f);
+}
+
+bool RobotModel::isDark(float px, float py) const {
+    Track::Projection point;
+    if (!track.locate(px, py, point)) return false;
+    return fabsf(point.lateral) <= Track::LINE_HALF_WIDTH_MM || track.isOnMarker(point.s, point.lateral);
+}
+
+void RobotModel::sensorPoint(float lateral, float& px, float& py) const {
+    px = x + SENSOR_OFFSET_MM * cosf(heading) + lateral * sinf(heading);
+    py = y + SENSOR_OFFSET_MM * sinf(heading) - lateral * cosf(heading);
+}
+
+int16_t RobotModel::reflectance(float coverage, float gain) {
+    // Dark line reads low, white floor reads high
+    float value = SENSOR_MAX - coverage * gain * (SENSOR_MAX - SENSOR_MIN) +
+        variation.ambientOffset + variation.sensorNoise * noise(random);
+    if (value < 0) value = 0;
+    if (value > 1023) value = 1023;
+    return int16_t(value);
+}
@@ -0,0 +1,73 @@
+#ifndef ROBOTMODEL_H
+#define ROBOTMODEL_H
+
+#include <stdint.h>
+#include <random>
+#include "Track.h"
+
+// Physical model of the robot for closed-loop host simulations:
+// differential-drive kinematics with first-order motors and a synthesized
+// reflectance reading for each line and marker sensor.
+class RobotModel {
+public:
+    // Per-run imperfections, all neutral by default
+    struct Variation {
+        float sensorNoise = 0.0f;        // ADC noise standard deviation (counts)
+        float sensorGain[6] = { 1, 1, 1, 1, 1, 1 };  // Line contrast per sensor
+        float ambientOffset = 0.0f;      // Added to every reading (counts)
+        float motorGainLeft = 1.0f;      // Motor asymmetry
+        float motorGainRight = 1.0f;
+        float batteryLevel = 1.0f;       // Supply relative to a full battery
+        float batterySag = 0.0f;         // Supply drop at full load on both motors
+    };
+
+    struct Readings {
+        int16_t line[6];
+        int16_t markerLeft;
+        int16_t markerRight;
+    };
+
+    RobotModel(const Track& track, const Variation& variation, uint32_t seed);
+
+    // Place the robot on the centre line at arc length s
+    void place(float s, float lateral = 0.0f);
+
+    // Advance the motors and pose by dt seconds with the given PWM commands
+    void step(float dt, int16_t leftPower, int16_t rightPower);
+
+    // Raw ADC values at the current pose
+    void read(Readings& readings);
+
+    // Centre of the sensor bar relative to the track
+    const Track::Projection& getProjection() const { return projection; }
+    float getDistance() const { return distance; }
+
+    // Calibration the firmware is given (nominal sensors)
+    static const int16_t SENSOR_MIN = 100;
+    static const int16_t SENSOR_MAX = 900;
+
+    // Geometry (mm) and motor constants
+    static constexpr float WHEEL_BASE_MM = 100.0f;
+    static constexpr float SENSOR_OFFSET_MM = 60.0f;   // Sensor bar ahead of the axle
+    static constexpr float MAX_SPEED_MM_S = 1500.0f;   // Wheel speed at PWM 255, full battery
+    static constexpr float MOTOR_TIME_CONSTANT_S = 0.03f;
+    static constexpr float SENSOR_POSITION_MM[6] = { -30.0f, -15.0f, -8.0f, 8.0f, 15.0f, 30.0f };
+    static constexpr float SENSOR_SPREAD_MM = 12.0f;
+
+private:
+    const Track& track;
+    Variation variation;
+    std::mt19937 random;
+    std::normal_distribution<float> noise;
+
+    float x = 0.0f, y = 0.0f, heading = 0.0f;
+    float speedLeft = 0.0f, speedRight = 0.0f;
+    float distance = 0.0f;
+    Track::Projection projection = {};
+
+    void sensorPoint(float lateral, float& px, float& py) const;
+    bool isDark(float px, float py) const;
+    int16_t reflectance(float coverage, float gain);
+};
+
+#endif // ROBOTMODEL_H
@@ -0,0 +1,342 @@
+#include "Track.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const float PI_F = 3.14159265f;
+
+// Longest walk from the hint when projecting
+static const int32_t SEARCH_WINDOW = 40;
+
+// Grid cells per polyline point before cells grow past GRID_CELL_MM
+static const float MAX_CELLS_PER_POINT = 4.0f;
+
+static const uint32_t NO_POINT = 0xFFFFFFFF;
+
+// Position after travelling distance along a piece with constant curvature
+static void travel(float x, float y, float heading, float curvature, float distance,
+    float& endX, float& endY) {
+    if (curvature == 0.0f) {
+        endX = x + distance * cosf(heading);
+        endY = y + distance * sinf(heading);
+    }
+    else {
+        float endHeading = heading + curvature * distance;
+        endX = x + (sinf(endHeading) - sinf(heading)) / curvature;
+        endY = y - (cosf(endHeading) - cosf(heading)) / curvature;
+    }
+}
+
+void Track::addPiece(float pieceLength, float curvature) {
+    pieces.push_back({ pieceLength, curvature, endX, endY, endHeading });
+    travel(endX, endY, endHeading, curvature, pieceLength, endX, endY);
+    endHeading += curvature * pieceLength;
+}
+
+void Track::addStraight(float segmentLength) {
+    addPiece(segmentLength, 0.0f);
+}
+
+void Track::addArc(float radius, float degrees) {
+    float angle = degrees * PI_F / 180.0f;
+    addPiece(radius * fabsf(angle), (angle >= 0 ? 1.0f : -1.0f) / radius);
+}
+
+void Track::addTurn(float degrees) {
+    endHeading += degrees * PI_F / 180.0f;
+}
+
+void Track::addLineTo(float x, float y) {
+    float dx = x - endX;
+    float dy = y - endY;
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance <= 0.0f) return;
+
+    // Corner by the smallest angle, headings stay continuous
+    float turn = atan2f(dy, dx) - endHeading;
+    turn -= 2.0f * PI_F * floorf((turn + PI_F) / (2.0f * PI_F));
+    endHeading += turn;
+    addStraight(distance);
+}
+
+void Track::addMarker(float start, float markerLength, bool right) {
+    markers.push_back({ start, markerLength, right });
+}
+
+void Track::build(float pointSpacing) {
+    spacing = pointSpacing;
+    pointX.clear();
+    pointY.clear();
+    pointHeading.clear();
+
+    length = 0.0f;
+    for (const Piece& piece : pieces) length += piece.length;
+
+    uint32_t count = uint32_t(length / spacing);
+    size_t current = 0;
+    float pieceStart = 0.0f;
+
+    // Sample each piece from its exact start pose, corners included
+    for (uint32_t i = 0; i < count; i++) {
+        float s = i * spacing;
+        while (current + 1 < pieces.size() && s >= pieceStart + pieces[current].length) {
+            pieceStart += pieces[current].length;
+            current++;
+        }
+        const Piece& piece = pieces[current];
+        float along = s - pieceStart;
+        float x, y;
+        travel(piece.startX, piece.startY, piece.startHeading, piece.curvature, along, x, y);
+        pointX.push_back(x);
+        pointY.push_back(y);
+        pointHeading.push_back(piece.startHeading + piece.curvature * along);
+    }
+
+    buildIndex();
+}
+
+void Track::buildIndex() {
+    cellStart.clear();
+    cellRuns.clear();
+    columns = rows = 0;
+    if (pointX.empty()) return;
+
+    float minX = pointX[0], maxX = pointX[0], minY = pointY[0], maxY = pointY[0];
+    for (size_t i = 1; i < pointX.size(); i++) {
+        minX = fminf(minX, pointX[i]);
+        maxX = fmaxf(maxX, pointX[i]);
+        minY = fminf(minY, pointY[i]);
+        maxY = fmaxf(maxY, pointY[i]);
+    }
+    gridX = minX - GRID_REACH_MM;
+    gridY = minY - GRID_REACH_MM;
+    float width = maxX - minX + 2.0f * GRID_REACH_MM;
+    float height = maxY - minY + 2.0f * GRID_REACH_MM;
+
+    // Coarser cells on sprawling tracks keep memory proportional to the line
+    float limit = pointX.size() * MAX_CELLS_PER_POINT;
+    cellSize = GRID_CELL_MM;
+    if (width * height > limit * cellSize * cellSize) cellSize = sqrtf(width * height / limit);
+    columns = uint32_t(width / cellSize) + 1;
+    rows = uint32_t(height / cellSize) + 1;
+    uint32_t cells = columns * rows;
+
+    // Pass 0 counts the runs of consecutive points per cell, pass 1 fills them
+    std::vector<uint32_t> lastPoint(cells, NO_POINT);
+    std::vector<uint32_t> fill;
+    cellStart.assign(cells + 1, 0);
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < pointX.size(); i++) {
+            uint32_t left = uint32_t((pointX[i] - GRID_REACH_MM - gridX) / cellSize);
+            uint32_t right = uint32_t((pointX[i] + GRID_REACH_MM - gridX) / cellSize);
+            uint32_t bottom = uint32_t((pointY[i] - GRID_REACH_MM - gridY) / cellSize);
+            uint32_t top = uint32_t((pointY[i] + GRID_REACH_MM - gridY) / cellSize);
+
+            for (uint32_t row = bottom; row <= top && row < rows; row++) {
+                for (uint32_t column = left; column <= right && column < columns; column++) {
+                    // Skip the corners of the square the reach circle misses
+                    float dx = fmaxf(0.0f, fmaxf(gridX + column * cellSize - pointX[i],
+                        pointX[i] - gridX - (column + 1) * cellSize));
+                    float dy = fmaxf(0.0f, fmaxf(gridY + row * cellSize - pointY[i],
+                        pointY[i] - gridY - (row + 1) * cellSize));
+                    if (dx * dx + dy * dy > GRID_REACH_MM * GRID_REACH_MM) continue;
+
+                    uint32_t cell = row * columns + column;
+                    bool continues = lastPoint[cell] != NO_POINT && lastPoint[cell] + 1 == i;
+                    lastPoint[cell] = i;
+
+                    if (pass == 0) {
+                        if (!continues) cellStart[cell + 1]++;
+                    }
+                    else if (!continues) {
+                        cellRuns[fill[cell]++] = { i, i };
+                    }
+                    else {
+                        cellRuns[fill[cell] - 1].last = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (uint32_t cell = 0; cell < cells; cell++) cellStart[cell + 1] += cellStart[cell];
+            cellRuns.resize(cellStart[cells]);
+            fill.assign(cellStart.begin(), cellStart.end() - 1);
+            lastPoint.assign(cells, NO_POINT);
+        }
+    }
+}
+
+bool Track::load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open track %s\n", path);
+        return false;
+    }
+
+    *this = Track();
+    char text[128];
+    int lineNumber = 0;
+    bool ok = true;
+    float pointSpacing = 5.0f;
+
+    while (ok && fgets(text, sizeof(text), file)) {
+        lineNumber++;
+        char command[16] = "";
+        char side[8] = "";
+        float a, b;
+
+        if (sscanf(text, "%15s", command) != 1 || command[0] == '#') continue;
+
+        if (strcmp(command, "spacing") == 0 && sscanf(text, "%*s %f", &a) == 1 && a > 0) {
+            pointSpacing = a;
+        }
+        else if (strcmp(command, "straight") == 0 && sscanf(text, "%*s %f", &a) == 1 && a > 0) {
+            addStraight(a);
+        }
+        else if (strcmp(command, "arc") == 0 && sscanf(text, "%*s %f %f", &a, &b) == 2 && a > 0) {
+            addArc(a, b);
+        }
+        else if (strcmp(command, "turn") == 0 && sscanf(text, "%*s %f", &a) == 1) {
+            addTurn(a);
+        }
+        else if (strcmp(command, "line") == 0 && sscanf(text, "%*s %f %f", &a, &b) == 2) {
+            addLineTo(a, b);
+        }
+        else if (strcmp(command, "marker") == 0 &&
+            sscanf(text, "%*s %7s %f %f", side, &a, &b) == 3 && b > 0) {
+            bool left = strcmp(side, "L") == 0 || strcmp(side, "LR") == 0;
+            bool right = strcmp(side, "R") == 0 || strcmp(side, "LR") == 0;
+            if (left) addMarker(a, b, false);
+            if (right) addMarker(a, b, true);
+            ok = left || right;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, lineNumber, text);
+    }
+    fclose(file);
+
+    if (ok && pieces.empty()) {
+        fprintf(stderr, "%s: no track pieces\n", path);
+        ok = false;
+    }
+    if (!ok) return false;
+
+    float gap = sqrtf(endX * endX + endY * endY);
+    if (gap > pointSpacing) fprintf(stderr, "%s: track does not close, %.0f mm gap\n", path, gap);
+    build(pointSpacing);
+    return true;
+}
+
+float Track::squaredDistance(int32_t index, float x, float y) const {
+    float dx = x - pointX[index];
+    float dy = y - pointY[index];
+    return dx * dx + dy * dy;
+}
+
+float Track::getLength() const {
+    return length;
+}
+
+void Track::getPoint(uint32_t index, float& x, float& y, float& heading) const {
+    x = pointX[index];
+    y = pointY[index];
+    heading = pointHeading[index];
+}
+
+void Track::getPose(float s, float& x, float& y, float& heading) const {
+    s = fmodf(s, length);
+    if (s < 0) s += length;
+    uint32_t index = uint32_t(s / spacing) % pointX.size();
+    float rest = s - index * spacing;
+    heading = pointHeading[index];
+    x = pointX[index] + rest * cosf(heading);
+    y = pointY[index] + rest * sinf(heading);
+}
+
+Track::Projection Track::project(float x, float y, uint32_t hint) const {
+    int32_t count = int32_t(pointX.size());
+    int32_t best = int32_t(hint % count);
+    float bestDistance = squaredDistance(best, x, y);
+
+    // Walk downhill from the hint, the closest point is near it
+    for (int32_t direction = -1; direction <= 1; direction += 2) {
+        for (int32_t steps = 0; steps < SEARCH_WINDOW; steps++) {
+            int32_t index = (best + direction + count) % count;
+            float distance = squaredDistance(index, x, y);
+            if (distance >= bestDistance) break;
+            best = index;
+            bestDistance = distance;
+        }
+    }
+    return projectFrom(best, x, y);
+}
+
+bool Track::locate(float x, float y, Projection& projection) const {
+    float column = (x - gridX) / cellSize;
+    float row = (y - gridY) / cellSize;
+    if (column < 0 || row < 0 || column >= columns || row >= rows) return false;
+
+    // Scan the runs, they hold every point within reach of the cell
+    uint32_t cell = uint32_t(row) * columns + uint32_t(column);
+    int32_t best = -1;
+    float bestDistance = GRID_REACH_MM * GRID_REACH_MM;
+    for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+        for (uint32_t index = cellRuns[k].first; index <= cellRuns[k].last; index++) {
+            float distance = squaredDistance(int32_t(index), x, y);
+            if (distance < bestDistance) {
+                best = int32_t(index);
+                bestDistance = distance;
+            }
+        }
+    }
+    if (best < 0) return false;
+
+    projection = projectFrom(best, x, y);
+    return true;
+}
+
+Track::Projection Track::projectFrom(int32_t best, float x, float y) const {
+    // Split the offset into along-track and lateral parts
+    float heading = pointHeading[best];
+    float dx = x - pointX[best];
+    float dy = y - pointY[best];
+    float along = dx * cosf(heading) + dy * sinf(heading);
+    float lateral = dx * sinf(heading) - dy * cosf(heading);
+
+    Projection projection;
+    projection.s = fmodf(best * spacing + along + length, length);
+    projection.lateral = lateral;
+    projection.index = uint32_t(best);
+    return projection;
+}
+
+bool Track::isOnMarker(float s, float lateral) const {
+    for (const Marker& marker : markers) {
+        float into = fmodf(s - marker.start + length, length);
+        if (into >= marker.length) continue;
+
+        float centre = marker.right ? MARKER_LATERAL_MM : -MARKER_LATERAL_MM;
+        if (fabsf(lateral - centre) <= MARKER_HALF_WIDTH_MM) return true;
+    }
+    return false;
+}
+
+Track Track::createDefault() {
+    Track track;
+    for (int half = 0; half < 2; half++) {
+        track.addStraight(600.0f);
+        track.addArc(300.0f, 45.0f);
+        track.addArc(300.0f, -90.0f);
+        track.addArc(300.0f, 45.0f);
+        track.addStraight(600.0f);
+        track.addArc(350.0f, 180.0f);
+    }
+    track.addMarker(0.0f, 25.0f, false);
+    track.build();
+    return track;
+}
@@ -0,0 +1,121 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <stdint.h>
+#include <vector>
+
+// Closed line-follower course for host simulations.
+//
+// The centre line is built from straights, arcs, corners and polyline
+// points and sampled into a polyline. Coordinates are in mm, lateral
+// offsets are positive to the right of the direction of travel.
+//
+// Track files (see host/sim/tracks/) hold one piece per line:
+//   spacing <mm>                  polyline sample spacing, default 5
+//   straight <mm>
+//   arc <radius> <degrees>        + turns left
+//   turn <degrees>                sharp corner, + turns left
+//   line <x> <y>                  corner and straight to an absolute point
+//   marker <L|R|LR> <s> <mm>      pad(s) starting at arc length s
+//   # comment
+// L pads are finish/start lines, R pads speed mode changes and LR pads
+// intersections, as CourseMarkers reads them.
+class Track {
+public:
+    struct Marker {
+        float start;     // Arc length where the pad begins
+        float length;    // Pad length along the track
+        bool right;      // Right side (speed mode) or left side (finish line)
+    };
+
+    struct Projection {
+        float s;          // Arc length of the closest centre-line point
+        float lateral;    // Signed distance from the centre line
+        uint32_t index;   // Polyline index, use as the next search hint
+    };
+
+    // Course description, call build() after the last segment
+    void addStraight(float length);
+    void addArc(float radius, float degrees);  // + turns left
+    void addTurn(float degrees);
+    void addLineTo(float x, float y);
+    void addMarker(float start, float length, bool right);
+    void build(float spacing = 5.0f);
+
+    // Parse a track file and build it, returns false and prints the line on errors
+    bool load(const char* path);
+
+    float getLength() const;
+
+    // Sampled centre line, for code that walks the polyline itself
+    uint32_t getPointCount() const { return uint32_t(pointX.size()); }
+    float getSpacing() const { return spacing; }
+    void getPoint(uint32_t index, float& x, float& y, float& heading) const;
+
+    // Position and heading (rad) of the centre line at arc length s
+    void getPose(float s, float& x, float& y, float& heading) const;
+
+    // Closest centre-line point, searching around the hint index
+    Projection project(float x, float y, uint32_t hint) const;
+
+    // Closest centre-line point through the grid index, no hint needed.
+    // False when the line is further than GRID_REACH_MM away.
+    bool locate(float x, float y, Projection& projection) const;
+
+    // Index size, for benchmarks
+    uint32_t getCellCount() const { return columns * rows; }
+    uint32_t getIndexRuns() const { return uint32_t(cellRuns.size()); }
+
+    // True when (s, lateral) lies on a marker pad
+    bool isOnMarker(float s, float lateral) const;
+
+    // Stadium with a chicane on both straights and finish markers at s = 0
+    static Track createDefault();
+
+    static constexpr float MARKER_LATERAL_MM = 45.0f;    // Pad centre distance from the line
+    static constexpr float MARKER_HALF_WIDTH_MM = 12.0f;
+    static constexpr float LINE_HALF_WIDTH_MM = 9.5f;
+
+    // Furthest sensor point the index answers for, covers the marker pads
+    static constexpr float GRID_REACH_MM = 60.0f;
+    static constexpr float GRID_CELL_MM = 20.0f;
+
+private:
+    struct Run {
+        uint32_t first;    // Consecutive polyline points
+        uint32_t last;
+    };
+
+    struct Piece {
+        float length;
+        float curvature;   // 1/radius, 0 for straights
+        float startX;
+        float startY;
+        float startHeading;
+    };
+
+    std::vector<Piece> pieces;
+    std::vector<Marker> markers;
+    std::vector<float> pointX;
+    std::vector<float> pointY;
+    std::vector<float> pointHeading;
+    float spacing = 5.0f;
+    float length = 0.0f;
+
+    // Pose where the next piece starts
+    float endX = 0.0f, endY = 0.0f, endHeading = 0.0f;
+
+    // Uniform grid, each cell lists the runs of polyline points within
+    // GRID_REACH_MM of some spot in the cell, one run per pass of the line
+    std::vector<uint32_t> cellStart;
+    std::vector<Run> cellRuns;
+    float gridX = 0.0f, gridY = 0.0f, cellSize = GRID_CELL_MM;
+    uint32_t columns = 0, rows = 0;
+
+    void addPiece(float pieceLength, float curvature);
+    void buildIndex();
+    float squaredDistance(int32_t index, float x, float y) const;
+    Projection projectFrom(int32_t index, float x, float y) const;
+};
+
+#endif // TRACK_H
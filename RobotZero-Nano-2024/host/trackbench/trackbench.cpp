@@ -0,0 +1,203 @@
+// Track loader and grid index benchmark.
+//
+//   trackbench [--segments N] [--seed N] [--queries N] [--keep file]
+//   trackbench --track file [--queries N]
+//
+// Without --track, writes a random course of --segments pieces (straights,
+// arcs and corners, closed by a polyline point) to a file and loads it back
+// through Track::load(). Reports the load and index build time, then times
+// Track::locate() on random sensor points within reach of the line against
+// the hinted Track::project() and a brute-force scan of every polyline
+// point, and counts the points where locate() disagrees with brute force.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Track.h"
+
+struct Options {
+    uint32_t segments = 20000;
+    uint32_t seed = 1;
+    uint32_t queries = 1000000;
+    const char* track = nullptr;
+    const char* keep = nullptr;
+};
+
+struct Query {
+    float x;
+    float y;
+    uint32_t hint;
+};
+
+// Brute force is linear in the track size, check a sample only
+static const uint32_t BRUTE_FORCE_QUERIES = 2000;
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static bool writeRandomTrack(const char* path, uint32_t segments, uint32_t seed) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    fprintf(file, "# Random course, %u segments, seed %u\n", segments, seed);
+    for (uint32_t i = 0; i < segments; i++) {
+        float pick = unit(random);
+        float sign = unit(random) < 0.5f ? -1.0f : 1.0f;
+        if (pick < 0.45f) {
+            fprintf(file, "straight %.1f\n", 20.0f + 280.0f * unit(random));
+        }
+        else if (pick < 0.9f) {
+            fprintf(file, "arc %.1f %.1f\n", 80.0f + 920.0f * unit(random), sign * (10.0f + 140.0f * unit(random)));
+        }
+        else {
+            fprintf(file, "turn %.1f\n", sign * (20.0f + 70.0f * unit(random)));
+            fprintf(file, "straight %.1f\n", 50.0f + 250.0f * unit(random));
+        }
+        if (i % 500 == 0) fprintf(file, "marker %s %.0f 25\n", i % 1000 ? "R" : "L", i * 150.0f);
+    }
+    fprintf(file, "line 0 0\n");
+    fclose(file);
+    return true;
+}
+
+// Random sensor points within reach of the line, with the tracking hint
+static std::vector<Query> drawQueries(const Track& track, uint32_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> along(0.0f, track.getLength());
+    std::uniform_real_distribution<float> across(-0.9f * Track::GRID_REACH_MM, 0.9f * Track::GRID_REACH_MM);
+
+    std::vector<Query> queries(count);
+    for (Query& query : queries) {
+        float s = along(random);
+        float lateral = across(random);
+        float x, y, heading;
+        track.getPose(s, x, y, heading);
+        query.x = x + lateral * sinf(heading);
+        query.y = y - lateral * cosf(heading);
+        query.hint = uint32_t(s / track.getSpacing());
+    }
+    return queries;
+}
+
+static float nearestDistance(const Track& track, float x, float y) {
+    float best = INFINITY;
+    for (uint32_t i = 0; i < track.getPointCount(); i++) {
+        float px, py, heading;
+        track.getPoint(i, px, py, heading);
+        best = fminf(best, (x - px) * (x - px) + (y - py) * (y - py));
+    }
+    return sqrtf(best);
+}
+
+static float pointDistance(const Track& track, uint32_t index, float x, float y) {
+    float px, py, heading;
+    track.getPoint(index, px, py, heading);
+    return sqrtf((x - px) * (x - px) + (y - py) * (y - py));
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--segments") == 0) options.segments = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) options.seed = atoi(value);
+        else if (strcmp(argv[i], "--queries") == 0) options.queries = atoi(value);
+        else if (strcmp(argv[i], "--track") == 0) options.track = value;
+        else if (strcmp(argv[i], "--keep") == 0) options.keep = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if (options.queries == 0) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+
+    char generated[] = "/tmp/trackbench-XXXXXX";
+    const char* path = options.track;
+    if (!path) {
+        path = options.keep;
+        if (!path) {
+            int fd = mkstemp(generated);
+            if (fd < 0) {
+                perror("trackbench");
+                return 1;
+            }
+            fclose(fdopen(fd, "w"));
+            path = generated;
+        }
+        if (!writeRandomTrack(path, options.segments, options.seed)) {
+            fprintf(stderr, "cannot write %s\n", path);
+            return 1;
+        }
+    }
+
+    Track track;
+    double start = seconds();
+    bool loaded = track.load(path);
+    double loadTime = seconds() - start;
+    if (!options.track && !options.keep) remove(generated);
+    if (!loaded) return 1;
+
+    printf("track:       %s, %.1f m, %u points\n", options.track ? path : "random",
+        track.getLength() * 1e-3f, track.getPointCount());
+    printf("load:        %.1f ms (parse, sampling and index)\n", loadTime * 1e3);
+    printf("index:       %u cells, %u runs, %.1f MB\n", track.getCellCount(), track.getIndexRuns(),
+        (track.getCellCount() * 4.0 + track.getIndexRuns() * 8.0) / (1 << 20));
+
+    std::vector<Query> queries = drawQueries(track, options.queries, options.seed + 1);
+
+    // locate() through the grid
+    std::vector<Track::Projection> located(queries.size());
+    std::vector<bool> found(queries.size());
+    start = seconds();
+    for (size_t i = 0; i < queries.size(); i++) {
+        found[i] = track.locate(queries[i].x, queries[i].y, located[i]);
+    }
+    double locateTime = seconds() - start;
+
+    // project() from the tracking hint, what a robot following the line uses
+    float checksum = 0.0f;
+    start = seconds();
+    for (const Query& query : queries) {
+        checksum += track.project(query.x, query.y, query.hint).lateral;
+    }
+    double projectTime = seconds() - start;
+
+    // Brute force on a sample, also the reference for locate()
+    uint32_t sample = std::min<uint32_t>(BRUTE_FORCE_QUERIES, options.queries);
+    uint32_t mismatches = 0;
+    start = seconds();
+    for (uint32_t i = 0; i < sample; i++) {
+        float nearest = nearestDistance(track, queries[i].x, queries[i].y);
+        bool expected = nearest <= Track::GRID_REACH_MM;
+        if (found[i] != expected) {
+            mismatches++;
+        }
+        else if (found[i] && pointDistance(track, located[i].index, queries[i].x, queries[i].y) > nearest + 0.01f) {
+            mismatches++;
+        }
+    }
+    double bruteTime = seconds() - start;
+
+    printf("locate:      %.0f ns/query (grid, no hint)\n", locateTime / queries.size() * 1e9);
+    printf("project:     %.0f ns/query (hinted walk, checksum %.0f)\n", projectTime / queries.size() * 1e9, checksum);
+    printf("brute force: %.0f ns/query\n", bruteTime / sample * 1e9);
+    printf("check:       %u of %u sampled queries differ from brute force\n", mismatches, sample);
+    return mismatches ? 1 : 0;
+}
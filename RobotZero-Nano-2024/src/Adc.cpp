@@ -0,0 +1,38 @@
+#include "Adc.h"
+#include "config.h"
+
+#ifdef __AVR__
+
+// ADPS2:0 values for clk/16 and clk/128
+static constexpr uint8_t PRESCALER_BITS = (ADC_PRESCALER == 16) ? 0x04 : 0x07;
+
+void Adc::initialize() {
+  ADCSRA = (ADCSRA & ~0x07) | PRESCALER_BITS;
+}
+
+int16_t Adc::readLine(uint8_t pin) {
+  if (SENSOR_ADC_BITS == 10) {
+    return analogRead(pin);
+  }
+
+  // AVcc reference, left adjusted, channel from the Arduino pin number
+  ADMUX = _BV(REFS0) | _BV(ADLAR) | ((pin - A0) & 0x07);
+  ADCSRA |= _BV(ADSC);
+  while (ADCSRA & _BV(ADSC)) {
+  }
+
+  // The high byte holds the 8 most significant bits
+  return ADCH;
+}
+
+#else
+
+// Host builds: analogRead returns 10-bit counts, drop the low bits like ADCH
+void Adc::initialize() {
+}
+
+int16_t Adc::readLine(uint8_t pin) {
+  return analogRead(pin) >> SENSOR_ADC_SHIFT;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef ADC_H
+#define ADC_H
+
+#include <Arduino.h>
+
+// Line sensor acquisition in the SENSOR_ADC_BITS mode.
+// The fast mode raises the ADC clock to clk/16 and reads only the high byte
+// of a left-adjusted result. analogRead keeps working for the other inputs,
+// it clears the left adjustment on every call.
+class Adc {
+public:
+    // Set the ADC clock for the acquisition mode (call once in setup)
+    static void initialize();
+
+    // One line sensor sample in sensor counts (0..SENSOR_MAX_VALUE)
+    static int16_t readLine(uint8_t pin);
+};
+
+#endif // ADC_H
@@ -0,0 +1,70 @@
+#ifndef BRAKEPROFILE_H
+#define BRAKEPROFILE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Braking of the stop sequence for one speed bin
+struct BrakeStep {
+    uint8_t power;          // Reverse PWM
+    uint16_t distanceMm;    // Distance to standstill
+    uint16_t durationMs;    // Time to standstill
+};
+
+static constexpr uint8_t BRAKE_PROFILE_SIZE = 256 / BRAKE_PROFILE_STEP + 1;
+
+// Braking indexed by speed / BRAKE_PROFILE_STEP (speeds in PWM units),
+// generated at compile time from the motor model in config.h
+struct BrakeProfile {
+    BrakeStep steps[BRAKE_PROFILE_SIZE];
+};
+
+static_assert(256 % BRAKE_PROFILE_STEP == 0, "Speed bins must end at PWM 256");
+static_assert(STOP_BRAKE_MIN_POWER > 0 && STOP_BRAKE_MIN_POWER <= STOP_BRAKE_MAX_POWER,
+    "Brake power range is empty");
+
+// Natural logarithm for x >= 1 (halving, then the atanh series)
+constexpr float brakeLog(float x) {
+    float result = 0.0f;
+    while (x > 2.0f) {
+        x *= 0.5f;
+        result += 0.693147181f;
+    }
+    float y = (x - 1.0f) / (x + 1.0f);
+    float term = y;
+    for (uint8_t n = 1; n < 20; n += 2) {
+        result += 2.0f * term / n;
+        term *= y * y;
+    }
+    return result;
+}
+
+// Reverse power P drives the model speed from v towards -P:
+// standstill after tau * ln(1 + v / P), having covered tau * (v - P * ln(1 + v / P))
+constexpr float brakeDuration(uint8_t speed, uint8_t power) {
+    return MOTOR_MODEL_TIME_CONSTANT * brakeLog(1.0f + (float)speed / power);
+}
+
+constexpr float brakeDistance(uint8_t speed, uint8_t power) {
+    return MOTOR_MODEL_TIME_CONSTANT * 0.001f * MOTOR_MODEL_MAX_SPEED / 255.0f *
+        (speed - power * brakeLog(1.0f + (float)speed / power));
+}
+
+// Gentlest power that stops within STOP_BRAKE_DISTANCE_MM, full power
+// when none does
+constexpr BrakeProfile makeBrakeProfile() {
+    BrakeProfile profile{};
+    for (uint8_t i = 1; i < BRAKE_PROFILE_SIZE; i++) {
+        uint8_t speed = (i * BRAKE_PROFILE_STEP > 255) ? 255 : i * BRAKE_PROFILE_STEP;
+        uint8_t power = STOP_BRAKE_MIN_POWER;
+        while (power < STOP_BRAKE_MAX_POWER && brakeDistance(speed, power) > STOP_BRAKE_DISTANCE_MM) {
+            power++;
+        }
+        profile.steps[i].power = power;
+        profile.steps[i].distanceMm = (uint16_t)(brakeDistance(speed, power) + 0.999f);
+        profile.steps[i].durationMs = (uint16_t)(brakeDuration(speed, power) + 0.5f);
+    }
+    return profile;
+}
+
+#endif // BRAKEPROFILE_H
@@ -0,0 +1,54 @@
+#include "CalibrationStore.h"
+#include <EEPROM.h>
+#include <util/crc16.h>
+
+void CalibrationStore::save(const int16_t* sensorMin, const int16_t* sensorMax) {
+    CalibrationData data;
+    data.version = CALIBRATION_VERSION;
+    data.adcBits = SENSOR_ADC_BITS;
+
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        data.sensorMin[i] = sensorMin[i];
+        data.sensorMax[i] = sensorMax[i];
+    }
+    data.crc = calculateCrc(data);
+
+    // EEPROM.put only rewrites cells that changed
+    EEPROM.put(EEPROM_CALIBRATION_ADDRESS, data);
+}
+
+bool CalibrationStore::load(int16_t* sensorMin, int16_t* sensorMax) {
+    CalibrationData data;
+    EEPROM.get(EEPROM_CALIBRATION_ADDRESS, data);
+
+    if (data.version != CALIBRATION_VERSION) return false;
+    if (data.adcBits != SENSOR_ADC_BITS) return false;  // Taken in the other acquisition mode
+    if (data.crc != calculateCrc(data)) return false;
+
+    // Reject ranges that would break the sensor normalization
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        if (data.sensorMin[i] < SENSOR_MIN_VALUE || data.sensorMax[i] > SENSOR_MAX_VALUE) return false;
+        if (data.sensorMax[i] - data.sensorMin[i] < CALIBRATION_MIN_RANGE) return false;
+    }
+
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        sensorMin[i] = data.sensorMin[i];
+        sensorMax[i] = data.sensorMax[i];
+    }
+    return true;
+}
+
+void CalibrationStore::clear() {
+    EEPROM.update(EEPROM_CALIBRATION_ADDRESS, 0xFF);
+}
+
+uint16_t CalibrationStore::calculateCrc(const CalibrationData& data) {
+    uint16_t crc = 0xFFFF;
+    const uint8_t* bytes = (const uint8_t*)&data;
+
+    for (uint16_t i = 0; i < sizeof(CalibrationData) - sizeof(uint16_t); i++) {
+        crc = _crc16_update(crc, bytes[i]);
+    }
+
+    return crc;
+}
@@ -0,0 +1,31 @@
+#ifndef CALIBRATIONSTORE_H
+#define CALIBRATIONSTORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Calibration block stored in EEPROM
+struct CalibrationData {
+    uint8_t version;                    // Layout version (CALIBRATION_VERSION)
+    uint8_t adcBits;                    // SENSOR_ADC_BITS the values were taken with
+    int16_t sensorMin[NUM_SENSORES];    // Minimum reading per line sensor
+    int16_t sensorMax[NUM_SENSORES];    // Maximum reading per line sensor
+    uint16_t crc;                       // CRC16 over all previous fields
+};
+
+class CalibrationStore {
+public:
+    // Save calibration values (sensor counts) to EEPROM
+    static void save(const int16_t* sensorMin, const int16_t* sensorMax);
+
+    // Load calibration values, returns false if missing or corrupted
+    static bool load(int16_t* sensorMin, int16_t* sensorMax);
+
+    // Invalidate stored calibration
+    static void clear();
+
+private:
+    static uint16_t calculateCrc(const CalibrationData& data);
+};
+
+#endif // CALIBRATIONSTORE_H
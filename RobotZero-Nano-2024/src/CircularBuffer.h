@@ -3,8 +3,6 @@
 
 #include <Arduino.h>
 
-#if DEBUG_LEVEL > 0
-
 template<typename T, uint8_t SIZE>
 class CircularBuffer {
 public:
@@ -135,5 +133,4 @@ private:
     uint8_t count;        // Number of items
 };
 
-#endif // DEBUG_LEVEL > 0
 #endif // CIRCULARBUFFER_H
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "Console.h"
+#include "globals.h"
+#include "Logger.h"
+#include "PidController.h"
+#include "ProfileManager.h"
+#include "Scheduler.h"
+#include "Telemetry.h"
+
+#if DEBUG_LEVEL > 0
+
+// Static member initialization
+char Console::line[CONSOLE_LINE_SIZE];
+uint8_t Console::lineLength = 0;
+bool Console::overflow = false;
+char Console::reply[REPLY_SIZE + 1];
+uint8_t Console::replyLength = 0;
+char Console::listing = 0;
+uint8_t Console::listIndex = 0;
+
+bool Console::process() {
+    // Finish the last reply before taking the next command
+    if (!flushReply()) return true;
+
+    // Returns right away when nothing was received
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+
+        if (c == '\r' || c == '\n') {
+            if (overflow) {
+                append("? line too long");
+            }
+            else if (lineLength > 0) {
+                line[lineLength] = '\0';
+                execute();
+            }
+            lineLength = 0;
+            overflow = false;
+
+            // Further commands wait in the RX buffer until the reply is out
+            if (!flushReply()) return true;
+        }
+        else if (lineLength < CONSOLE_LINE_SIZE - 1) {
+            line[lineLength++] = c;
+        }
+        else {
+            overflow = true;
+        }
+    }
+
+    return true;
+}
+
+void Console::execute() {
+    char* command = strtok(line, " ");
+    char* name = strtok(nullptr, " ");
+    char* value = strtok(nullptr, " ");
+
+    if (command == nullptr) return;
+    if (command[1] != '\0') {
+        append("? ");
+        append(command);
+        return;
+    }
+
+    switch (command[0]) {
+    case '?':
+        listing = '?';
+        listIndex = 0;
+        break;
+
+    case 'g': {
+        int8_t index = name ? ProfileManager::findField(name) : -1;
+        if (index < 0) {
+            append("? ");
+            append(name ? name : "field");
+        }
+        else {
+            appendField(index);
+        }
+        break;
+    }
+
+    case 's':
+        setField(name, value);
+        break;
+
+    case 't':
+        listing = 't';
+        listIndex = 0;
+        break;
+
+    case 'r':
+        if (!isRobotStopped) {
+            append("? running");
+            break;
+        }
+        restartRun();
+        append("run");
+        break;
+
+    case 'x':
+        // The control task stops the motors and closes the log session
+        isRobotStopped = true;
+        append("stop");
+        break;
+
+    default:
+        append("? ");
+        append(command);
+        break;
+    }
+}
+
+void Console::setField(const char* name, const char* value) {
+    int8_t index = name ? ProfileManager::findField(name) : -1;
+    if (index < 0) {
+        append("? ");
+        append(name ? name : "field");
+        return;
+    }
+
+    char* end = nullptr;
+    float number = value ? (float)strtod(value, &end) : 0.0f;
+    if (value == nullptr || end == value || *end != '\0') {
+        append("? value");
+        return;
+    }
+    if (!ProfileManager::setField(index, number)) {
+        append("? range");
+        return;
+    }
+
+    // Gains take effect through a new schedule
+    if (ProfileManager::getFieldType(index) == ProfileFieldType::GAIN) {
+        const SpeedProfile* profile = ProfileManager::getActiveProfile();
+        PidController::tune(makeGainSchedule(profile->kProportional,
+            profile->kDerivative, profile->filterCoefficient));
+    }
+
+    appendField(index);
+}
+
+void Console::nextListItem() {
+    if (listing == '?') {
+        if (listIndex < ProfileManager::getFieldCount()) {
+            appendField(listIndex++);
+        }
+        else {
+            listing = 0;
+        }
+        return;
+    }
+
+    // Per task: index, last and longest run (us), overruns, late releases
+    const Task* task = Scheduler::getTask(listIndex);
+    if (task != nullptr) {
+        append("t");
+        appendNumber(listIndex++);
+        append(" ");
+        appendNumber(task->lastTimeUs);
+        append(" ");
+        appendNumber(task->maxTimeUs);
+        append(" ");
+        appendNumber(task->overruns);
+        append(" ");
+        appendNumber(task->lateReleases);
+    }
+    else {
+        append("loop ");
+        appendNumber(Scheduler::getLoopRate());
+        append(" drop ");
+        appendNumber(Telemetry::getDroppedFrames());
+        listing = 0;
+    }
+}
+
+bool Console::flushReply() {
+    while (true) {
+        if (replyLength > 0) {
+            if (!Telemetry::sendText(reply)) return false;
+            replyLength = 0;
+            reply[0] = '\0';
+        }
+        if (listing == 0) return true;
+        nextListItem();
+    }
+}
+
+void Console::append(const char* text) {
+    while (*text != '\0' && replyLength < REPLY_SIZE) {
+        reply[replyLength++] = *text++;
+    }
+    reply[replyLength] = '\0';
+}
+
+void Console::appendNumber(uint32_t value) {
+    char digits[11];
+    uint8_t count = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    char text[11];
+    for (uint8_t i = 0; i < count; i++) {
+        text[i] = digits[count - 1 - i];
+    }
+    text[count] = '\0';
+    append(text);
+}
+
+void Console::appendField(uint8_t index) {
+    char name[ProfileManager::FIELD_NAME_SIZE];
+    ProfileManager::getFieldName(index, name);
+    append(name);
+    append("=");
+
+    float value = ProfileManager::getField(index);
+    if (ProfileManager::getFieldType(index) == ProfileFieldType::BYTE) {
+        appendNumber((uint8_t)value);
+        return;
+    }
+
+    // Gains with three decimals, printf has no float support on AVR
+    uint32_t thousandths = (uint32_t)(value * 1000.0f + 0.5f);
+    appendNumber(thousandths / 1000);
+    append(".");
+    uint16_t fraction = thousandths % 1000;
+    if (fraction < 100) append("0");
+    if (fraction < 10) append("0");
+    appendNumber(fraction);
+}
+
+#endif // DEBUG_LEVEL > 0
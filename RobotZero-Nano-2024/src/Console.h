@@ -0,0 +1,52 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if DEBUG_LEVEL > 0
+
+// Serial command console for live tuning.
+// Commands are text lines read from the core's interrupt-fed RX buffer,
+// replies go out as CONSOLE telemetry frames, one line each:
+//   ?                  list the profile fields with their values
+//   g <field>          read a profile field
+//   s <field> <value>  write a profile field (RAM copy, lost at reset)
+//   t                  task statistics, loop rate and dropped frames
+//   r                  start a run when stopped
+//   x                  stop the robot
+// Errors are answered with "? <reason>". tools/robot_console.py is the
+// interactive client.
+class Console {
+public:
+    // Read pending commands and send replies (console task)
+    static bool process();
+
+private:
+    static const uint8_t REPLY_SIZE = sizeof(ConsoleFrame::text);
+
+    static char line[CONSOLE_LINE_SIZE];
+    static uint8_t lineLength;
+    static bool overflow;          // Line longer than the buffer, answered at its end
+
+    static char reply[REPLY_SIZE + 1];
+    static uint8_t replyLength;
+
+    // Multi-line reply ('?' or 't', 0 = none), continued as the TX ring drains
+    static char listing;
+    static uint8_t listIndex;
+
+    // Internal methods
+    static void execute();
+    static void setField(const char* name, const char* value);
+    static void nextListItem();
+    static bool flushReply();
+
+    // Reply formatting, truncated to REPLY_SIZE
+    static void append(const char* text);
+    static void appendNumber(uint32_t value);
+    static void appendField(uint8_t index);
+};
+
+#endif // DEBUG_LEVEL > 0
+#endif // CONSOLE_H
@@ -1,80 +1,108 @@
 #include "CourseMarkers.h"
+#include "CircularBuffer.h"
 #include "config.h"
 #include "debug.h"
 #include "globals.h"
-#include "MotorsDrivers.h"
+#include "LedPattern.h"
+#include "SpeedCurve.h"
+#include "StopController.h"
 
 #if DEBUG_LEVEL > 0
 #include "FlashManager.h"
+#include "Logger.h"
 #endif
 
+// Edges waiting for classification
+static CircularBuffer<MarkerEdge, MARKER_EDGE_QUEUE_SIZE> edgeQueue;
+
+// Target speed per |error|, normal and precision mode
+static const SpeedCurve NORMAL_CURVE PROGMEM = makeSpeedCurve(BASE_FAST);
+static const SpeedCurve PRECISION_CURVE PROGMEM = makeSpeedCurve(SPEED_SLOW);
+
 // Static member initialization
 int CourseMarkers::speed = 0;
-int CourseMarkers::lastMarkerState = 0;
-int CourseMarkers::previousMarkerState = 0;
-int CourseMarkers::oldMarkerState = 0;
-int CourseMarkers::currentMarkerState = 0;
-int16_t CourseMarkers::leftMarkerDetected = 0;
-int16_t CourseMarkers::rightMarkerDetected = 0;
+uint8_t CourseMarkers::activeMarkers = 0;
+int16_t CourseMarkers::darkest[2] = { 0, 0 };
+uint8_t CourseMarkers::edgeMarkers = 0;
+uint32_t CourseMarkers::pulseStart[2] = { 0, 0 };
+uint8_t CourseMarkers::patternMarkers = 0;
+uint8_t CourseMarkers::patternConfidence[2] = { 0, 0 };
+uint32_t CourseMarkers::patternEnd = 0;
+uint32_t CourseMarkers::patternWindow = 0;
+uint8_t CourseMarkers::lastConfidence = 0;
+uint16_t CourseMarkers::intersectionCount = 0;
+uint16_t CourseMarkers::rejectedCount = 0;
 bool CourseMarkers::isTurning = false;
 bool CourseMarkers::isExitingTurn = false;
 uint8_t CourseMarkers::boostCountdown = 0;
-Timer CourseMarkers::stopTimer;
-Timer CourseMarkers::slowdownTimer;
-uint32_t CourseMarkers::lastReadTime = 0;
+int16_t CourseMarkers::rawLeft = 0;
+int16_t CourseMarkers::rawRight = 0;
 
 void CourseMarkers::readCourseMarkers() {
-  // Check if enough time has passed since last read
-  uint32_t currentTime = millis();
-  if (currentTime - lastReadTime < MARKER_READ_INTERVAL) {
+  // Called by the marker task at TASK_PERIOD_MARKERS_US
+  uint32_t currentTime = micros();
+  int16_t left = analogRead(PIN_MARKER_LEFT);
+  int16_t right = analogRead(PIN_MARKER_RIGHT);
+  rawLeft = left;
+  rawRight = right;
+
+  // Hysteresis: enter below the detection threshold, leave above the release threshold
+  uint8_t markers = activeMarkers;
+  if (left <= MARKER_DETECTION_THRESHOLD) markers |= MARKER_LEFT;
+  else if (left >= MARKER_RELEASE_THRESHOLD) markers &= ~MARKER_LEFT;
+  if (right <= MARKER_DETECTION_THRESHOLD) markers |= MARKER_RIGHT;
+  else if (right >= MARKER_RELEASE_THRESHOLD) markers &= ~MARKER_RIGHT;
+
+  // Depth of the active pulses, starts over on every rising edge
+  uint8_t changed = markers ^ activeMarkers;
+  if (markers & MARKER_LEFT) darkest[1] = (changed & MARKER_LEFT) ? left : min(darkest[1], left);
+  if (markers & MARKER_RIGHT) darkest[0] = (changed & MARKER_RIGHT) ? right : min(darkest[0], right);
+
+  if (changed == 0) {
     return;
   }
-  lastReadTime = currentTime;
 
-  // Read markers with immediate threshold check to avoid extra variables
-  bool leftDetected = analogRead(PIN_MARKER_LEFT) <= MARKER_DETECTION_THRESHOLD;
-  bool rightDetected = analogRead(PIN_MARKER_RIGHT) <= MARKER_DETECTION_THRESHOLD;
+  if (changed & MARKER_LEFT) pushEdge(MARKER_LEFT, markers & MARKER_LEFT, currentTime, darkest[1]);
+  if (changed & MARKER_RIGHT) pushEdge(MARKER_RIGHT, markers & MARKER_RIGHT, currentTime, darkest[0]);
+  activeMarkers = markers;
 
-  // Direct state calculation without intermediate steps
-  currentMarkerState = (leftDetected << 1) | rightDetected;
+  // Marker feedback on the status LED
+  if (markers != 0) LedPattern::play(LED_CHANNEL_MARKER, LED_PATTERN_ON);
+  else LedPattern::stop(LED_CHANNEL_MARKER);
+}
 
-  // Update LED only if markers detected
-  digitalWrite(PIN_STATUS_LED, leftDetected || rightDetected);
+void CourseMarkers::pushEdge(uint8_t channel, bool rising, uint32_t timestamp, int16_t darkest) {
+  MarkerEdge edge;
+  edge.timestamp = timestamp;
+  edge.channel = channel;
+  edge.rising = rising;
+  edge.darkest = darkest;
 
-  DEBUG_PRINT("Marker State: ");
-  DEBUG_PRINTLN_VAL(currentMarkerState);
+  // Queue is drained every loop, an overflow only drops the newest edge
+  edgeQueue.push(edge);
 }
 
 int CourseMarkers::speedControl(int error) {
-  // Track situation detection with optimized comparisons
-  bool curve_detected = abs(error) > TURN_THRESHOLD;
+  uint8_t absError = min(abs(error), (int)SPEED_CURVE_MAX_ERROR);
 
   // Early return for curves to reduce processing time
-  if (curve_detected) {
+  if (absError > TURN_THRESHOLD) {
     isTurning = true;
     isExitingTurn = false;
     return TURN_SPEED;
   }
 
-  bool straight_detected = abs(error) < STRAIGHT_THRESHOLD;
-  int target_speed;
-
-  if (straight_detected) {
+  if (absError < STRAIGHT_THRESHOLD) {
     if (isTurning) {
       isExitingTurn = true;
       boostCountdown = BOOST_DURATION;
     }
     isTurning = false;
-    target_speed = isPrecisionMode ? SPEED_SLOW : BASE_FAST;
-  }
-  else {
-    target_speed = map(abs(error),
-      STRAIGHT_THRESHOLD,
-      TURN_THRESHOLD,
-      (isPrecisionMode ? SPEED_SLOW : BASE_FAST),
-      TURN_SPEED);
   }
 
+  const SpeedCurve& curve = isPrecisionMode ? PRECISION_CURVE : NORMAL_CURVE;
+  int target_speed = pgm_read_byte(&curve.speed[absError]);
+
   // Apply boost with bounds checking
   if (isExitingTurn && boostCountdown > 0 && !isPrecisionMode) {
     target_speed = min(255, target_speed + BOOST_INCREMENT);
@@ -96,50 +124,122 @@ int CourseMarkers::speedControl(int error) {
 void CourseMarkers::processMarkerSignals() {
   readCourseMarkers();
 
-  // Only process state changes
-  if (lastMarkerState == currentMarkerState) {
+  MarkerEdge edge;
+  while (edgeQueue.pop(edge)) {
+    processEdge(edge);
+  }
+
+  // Pattern is complete once both channels stayed clear for its window
+  if (patternMarkers != 0 && edgeMarkers == 0 &&
+    (uint32_t)(micros() - patternEnd) >= patternWindow) {
+    classifyPattern();
+  }
+}
+
+void CourseMarkers::processEdge(const MarkerEdge& edge) {
+  uint8_t index = (edge.channel == MARKER_LEFT) ? 1 : 0;
+
+  if (edge.rising) {
+    edgeMarkers |= edge.channel;
+    pulseStart[index] = edge.timestamp;
+    return;
+  }
+
+  edgeMarkers &= ~edge.channel;
+
+  // Pulse ended: keep it only if MARKER_MIN_PULSE_SAMPLES samples saw it
+  uint32_t duration = edge.timestamp - pulseStart[index];
+  if (duration < MARKER_MIN_PULSE_US) {
     return;
   }
 
-  // State machine for marker processing
-  switch (currentMarkerState) {
-  case 0: // No markers
-    if (lastMarkerState == 2 && previousMarkerState == 0) {
+  uint8_t confidence = pulseConfidence(duration, edge.darkest);
+  if (confidence > patternConfidence[index]) {
+    patternConfidence[index] = confidence;
+  }
+  patternMarkers |= edge.channel;
+  patternEnd = edge.timestamp;
+
+  // A skewed crossing reaches the other sensor within a few pulse lengths at
+  // any speed, so the window scales with the pulse that just ended
+  patternWindow = constrain(duration * MARKER_COINCIDENCE_RATIO,
+    (uint32_t)MARKER_WINDOW_MIN_US, (uint32_t)MARKER_WINDOW_MAX_US);
+}
+
+uint8_t CourseMarkers::pulseConfidence(uint32_t duration, int16_t darkest) {
+  // Pulses riding along a line for too long are not pads
+  if (duration > MARKER_MAX_PULSE_US) {
+    return 0;
+  }
+
+  // Duration: graded per marker task sample, 100 from MARKER_FULL_PULSE_SAMPLES
+  uint32_t samples = (duration + TASK_PERIOD_MARKERS_US / 2) / TASK_PERIOD_MARKERS_US;
+  uint32_t durationScore = min(samples * 100 / MARKER_FULL_PULSE_SAMPLES, (uint32_t)100);
+
+  // Depth: 0 at the detection threshold, 100 from MARKER_FULL_DEPTH
+  int16_t depth = constrain(MARKER_DETECTION_THRESHOLD - darkest, 0,
+    MARKER_DETECTION_THRESHOLD - MARKER_FULL_DEPTH);
+  uint8_t depthScore = (uint8_t)(depth * 100 / (MARKER_DETECTION_THRESHOLD - MARKER_FULL_DEPTH));
+
+  return min((uint8_t)durationScore, depthScore);
+}
+
+void CourseMarkers::classifyPattern() {
+  // Pulses on both sides inside one window are a crossing, whatever their order
+  if (patternMarkers == (MARKER_LEFT | MARKER_RIGHT)) {
+    handleIntersection();
+  }
+  else {
+    uint8_t index = (patternMarkers == MARKER_LEFT) ? 1 : 0;
+    lastConfidence = patternConfidence[index];
+
+    if (lastConfidence < MARKER_MIN_CONFIDENCE) {
+      rejectedCount++;   // Reported by getRejectedCount(), not printed mid-run
+    }
+    // Left pads are the start/finish line, right pads toggle the speed mode
+    else if (patternMarkers == MARKER_LEFT) {
       handleFinishLine();
     }
-    else if (lastMarkerState == 1 && previousMarkerState == 0) {
+    else {
       handleSpeedMode();
     }
-    else if (lastMarkerState == 3 || previousMarkerState == 3 || oldMarkerState == 3) {
-      handleIntersection();
-    }
-    break;
   }
 
-  // Update state history
-  oldMarkerState = previousMarkerState;
-  previousMarkerState = lastMarkerState;
-  lastMarkerState = currentMarkerState;
+  patternMarkers = 0;
+  patternConfidence[0] = 0;
+  patternConfidence[1] = 0;
+}
 
-  // Handle stopping sequence
-  if (isStopSequenceActive && !isRobotStopped) {
-    if (!slowdownTimer.Expired() && currentSpeed > SPEED_BRAKE) {
-      currentSpeed = SPEED_BRAKE;
-    }
-    else if (stopTimer.Expired()) {
-      currentSpeed = 0;
-      MotorDriver::setMotorsPower(0, 0);
-      isRobotStopped = true;
-    }
-  }
+int16_t CourseMarkers::getRawLeft() {
+  return rawLeft;
+}
+
+int16_t CourseMarkers::getRawRight() {
+  return rawRight;
+}
+
+uint8_t CourseMarkers::getLastConfidence() {
+  return lastConfidence;
+}
+
+uint16_t CourseMarkers::getIntersectionCount() {
+  return intersectionCount;
+}
+
+uint16_t CourseMarkers::getRejectedCount() {
+  return rejectedCount;
 }
 
 void CourseMarkers::handleFinishLine() {
   lapCount++;
+#if DEBUG_LEVEL > 0
+  // Lap boundaries for the host analysis tools
+  Logger::logEvent(lapCount == 1 ? EventType::LAP_START : EventType::LAP_END, lapCount);
+#endif
   if (lapCount == 2 && !isStopSequenceActive) {
     isStopSequenceActive = true;
-    slowdownTimer.Start(50);
-    stopTimer.Start(STOP_DELAY);
+    // The line was crossed where its pulse ended
+    StopController::start(micros() - patternEnd);
 #if DEBUG_LEVEL > 0
     FlashManager::setLogReady();
 #endif
@@ -156,5 +256,6 @@ void CourseMarkers::handleSpeedMode() {
 }
 
 void CourseMarkers::handleIntersection() {
+  intersectionCount++;
   DEBUG_PRINTLN("Intersection detected");
 }
\ No newline at end of file
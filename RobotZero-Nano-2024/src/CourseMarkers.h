@@ -1,35 +1,57 @@
 #ifndef COURSEMARKERS_H
 #define COURSEMARKERS_H
 
-#include "Timer.h"
 #include <Arduino.h>
 
+// Timestamped transition of a single marker sensor
+struct MarkerEdge {
+    uint32_t timestamp;  // micros() of the marker task sample that saw the edge
+    uint8_t channel;     // MARKER_LEFT or MARKER_RIGHT bit
+    bool rising;         // true when the marker starts, false when it ends
+    int16_t darkest;     // Lowest reading during the pulse (falling edges only)
+};
+
 class CourseMarkers {
 private:
-    // Timing control
-    static uint32_t lastReadTime;
-    static const uint16_t MARKER_READ_INTERVAL = 2;  // Read interval in ms
+    // Channel bits (same encoding as the left/right marker state)
+    static const uint8_t MARKER_RIGHT = 0x01;
+    static const uint8_t MARKER_LEFT = 0x02;
+
+    // Last raw readings
+    static int16_t rawLeft;
+    static int16_t rawRight;
+
+    // Edge detector state
+    static uint8_t activeMarkers;        // Channels currently over a marker (sampler)
+    static int16_t darkest[2];           // Lowest reading of the active pulse (sampler)
+    static uint8_t edgeMarkers;          // Channels currently over a marker (edge queue)
+    static uint32_t pulseStart[2];       // Rising edge time per channel
+
+    // Pattern state, pulses closer than the co-occurrence window form one pattern
+    static uint8_t patternMarkers;       // Channels with a valid pulse in this pattern
+    static uint8_t patternConfidence[2]; // Best pulse confidence per channel (0-100)
+    static uint32_t patternEnd;          // Falling edge time of the last valid pulse
+    static uint32_t patternWindow;       // Quiet time that closes the pattern
+
+    // Classifier statistics
+    static uint8_t lastConfidence;
+    static uint16_t intersectionCount;
+    static uint16_t rejectedCount;
 
     // State variables
     static int speed;
-    static int lastMarkerState;
-    static int previousMarkerState;
-    static int oldMarkerState;
-    static int currentMarkerState;
-    static int16_t leftMarkerDetected;   // Changed to int16_t for analog read
-    static int16_t rightMarkerDetected;  // Changed to int16_t for analog read
 
     // Speed control variables
     static bool isTurning;
     static bool isExitingTurn;
     static uint8_t boostCountdown;
 
-    // Timers
-    static Timer stopTimer;
-    static Timer slowdownTimer;
-
     // Internal methods
     static void readCourseMarkers();
+    static void pushEdge(uint8_t channel, bool rising, uint32_t timestamp, int16_t darkest);
+    static void processEdge(const MarkerEdge& edge);
+    static uint8_t pulseConfidence(uint32_t duration, int16_t darkest);
+    static void classifyPattern();
     static void handleFinishLine();
     static void handleSpeedMode();
     static void handleIntersection();
@@ -38,6 +60,15 @@ public:
     // Public methods
     static void processMarkerSignals();
     static int speedControl(int error);
+
+    // Last raw marker readings (record and replay)
+    static int16_t getRawLeft();
+    static int16_t getRawRight();
+
+    // Classifier results
+    static uint8_t getLastConfidence();     // Confidence of the last single marker
+    static uint16_t getIntersectionCount();
+    static uint16_t getRejectedCount();     // Single markers ignored for low confidence
 };
 
-#endif // COURSEMARKERS_H
\ No newline at end of file
+#endif // COURSEMARKERS_H
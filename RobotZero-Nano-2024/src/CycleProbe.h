@@ -0,0 +1,33 @@
+#ifndef CYCLEPROBE_H
+#define CYCLEPROBE_H
+
+#include <Arduino.h>
+
+// Cycle probes for the simulator benchmark (host/cyclebench).
+// A CYCLE_BENCH build writes the probe id to GPIOR0 when a measured section
+// starts and to GPIOR1 when it ends; the simulator timestamps both writes
+// with its cycle counter. Each write is one OUT instruction, the empty probe
+// measures that overhead. Every other build compiles the probes away.
+enum CycleProbeId : uint8_t {
+    CYCLE_PROBE_EMPTY = 1,          // Begin immediately followed by end
+    CYCLE_PROBE_LOOP,               // loop(), one scheduler dispatch
+    CYCLE_PROBE_CONTROL,            // controlTask
+    CYCLE_PROBE_LINE_POSITION,      // Sensors::calculateLinePosition
+    CYCLE_PROBE_SPEED_CONTROL,      // CourseMarkers::speedControl
+    CYCLE_PROBE_PID,                // PidController::update
+    CYCLE_PROBE_MOTORS,             // MotorDriver::setMotorsPower
+    CYCLE_PROBE_LOG_PERFORMANCE,    // Logger::logPerformance
+    CYCLE_PROBE_COUNT
+};
+
+#if defined(CYCLE_BENCH) && defined(__AVR__)
+// The memory clobber keeps the compiler from moving loads and stores
+// across the probe
+#define CYCLE_PROBE_BEGIN(id) do { GPIOR0 = (id); asm volatile("" ::: "memory"); } while (0)
+#define CYCLE_PROBE_END(id) do { asm volatile("" ::: "memory"); GPIOR1 = (id); } while (0)
+#else
+#define CYCLE_PROBE_BEGIN(id) ((void)0)
+#define CYCLE_PROBE_END(id) ((void)0)
+#endif
+
+#endif // CYCLEPROBE_H
@@ -43,38 +43,44 @@ struct SpeedProfile {
 // Log event types
 enum class EventType : uint8_t {
     SESSION_START = 0x01,
-    LAP_START = 0x02,
-    LAP_END = 0x03,
+    LAP_START = 0x02,       // First finish line crossing, data = lapCount
+    LAP_END = 0x03,         // Later crossings, each ends the lap since the previous one
     CURVE_ENTER = 0x04,
     CURVE_EXIT = 0x05,
     MODE_CHANGE = 0x06,
     SPEED_CHANGE = 0x07,
     ERROR_DETECTED = 0x08,
-    SESSION_END = 0x09
+    SESSION_END = 0x09,
+    LOOP_RATE = 0x0A,       // loop() calls per second, saturated at 65535
+    NOISE_FLOOR = 0x0B,     // Sensor in bits 15..12, reading noise in 1/16 ADC counts
+    BRAKE_START = 0x0C,     // Stop planned, reverse power in the high byte, model speed (PWM) low
+    OUTPUT_LIMIT = 0x0D     // MotorLimit in bits 15..13, right wheel in bit 12, share of control periods in 1/1000
 };
 
+// Log records are packed so host tools read the AVR layout
+
 // Event record structure (8 bytes)
-struct EventRecord {
+struct __attribute__((packed)) EventRecord {
     uint32_t timestamp;    // Time since start
     EventType type;        // Event type
     uint16_t data;        // Event specific data
     uint8_t checksum;     // Data validation
 };
 
-// Performance record structure (12 bytes)
-struct PerformanceRecord {
+// Performance record structure (14 bytes)
+struct __attribute__((packed)) PerformanceRecord {
     uint32_t timestamp;     // Time since start
     int16_t linePosition;   // Current line position
     int16_t error;         // Current error
     int16_t correction;    // Applied correction
-    uint8_t speedLeft;     // Left motor speed
-    uint8_t speedRight;    // Right motor speed
+    uint8_t speedLeft;     // Left motor command, reverse logged as 0
+    uint8_t speedRight;    // Right motor command, reverse logged as 0
     uint8_t state;         // Robot state flags
     uint8_t checksum;      // Data validation
 };
 
-// Session header structure (32 bytes)
-struct SessionHeader {
+// Session header structure (47 bytes)
+struct __attribute__((packed)) SessionHeader {
     uint32_t startTime;          // Session start timestamp
     DebugMode mode;             // Operating mode
     uint8_t plannedLaps;        // Number of laps to run
@@ -82,12 +88,12 @@ struct SessionHeader {
     float pidKp;                // PID proportional constant
     float pidKd;                // PID derivative constant
     float filterAlpha;          // Error filter coefficient
-    uint16_t sensorCalibrationData[6]; // Calibration values
+    uint16_t sensorCalibrationData[12]; // Calibration min[0..5] then max[0..5]
     uint32_t headerChecksum;    // Header validation
 };
 
-// Lap statistics structure (16 bytes)
-struct LapStats {
+// Lap statistics structure (18 bytes)
+struct __attribute__((packed)) LapStats {
     uint32_t startTime;      // Lap start time
     uint32_t duration;       // Lap duration
     uint16_t curves;         // Number of curves
@@ -97,5 +103,59 @@ struct LapStats {
     uint8_t checksum;        // Data validation
 };
 
+// Telemetry frame types (first byte of every frame)
+enum class TelemetryType : uint8_t {
+    CONTROL = 0x01,       // TelemetryFrame
+    RAW_SENSORS = 0x02,   // RawSensorFrame
+    CALIBRATION = 0x03,   // CalibrationFrame
+    CONSOLE = 0x04        // ConsoleFrame
+};
+
+// Wire formats are packed so host builds share the AVR layout
+
+// Live telemetry frame payload (16 bytes, COBS framed on the wire)
+struct __attribute__((packed)) TelemetryFrame {
+    TelemetryType type;     // TelemetryType::CONTROL
+    uint8_t sequence;       // Wraps at 255, gaps mean dropped frames
+    uint16_t timestamp;     // Low 16 bits of millis()
+    uint8_t speed;          // Current base speed
+    int16_t error;          // Line error
+    int16_t correction;     // PID correction
+    int16_t leftPower;      // Left motor command
+    int16_t rightPower;     // Right motor command
+    uint8_t state;          // Robot state flags (same bits as PerformanceRecord)
+    uint16_t crc;           // CRC16 (MODBUS) over all previous fields
+};
+
+// Raw ADC frame for record and replay (28 bytes)
+struct __attribute__((packed)) RawSensorFrame {
+    TelemetryType type;     // TelemetryType::RAW_SENSORS
+    uint8_t sequence;       // Shared with the other frame types
+    uint32_t timestamp;     // micros() at the start of the loop iteration
+    int16_t line[6];        // Raw line sensor readings, left edge first
+    int16_t markerLeft;     // Last raw left marker reading
+    int16_t markerRight;    // Last raw right marker reading
+    int16_t leftPower;      // Left motor command
+    int16_t rightPower;     // Right motor command
+    uint16_t crc;           // CRC16 (MODBUS) over all previous fields
+};
+
+// Calibration sent once at run start in raw capture mode (28 bytes)
+struct __attribute__((packed)) CalibrationFrame {
+    TelemetryType type;     // TelemetryType::CALIBRATION
+    uint8_t sequence;       // Shared with the other frame types
+    int16_t sensorMin[6];   // Calibration minimum per line sensor
+    int16_t sensorMax[6];   // Calibration maximum per line sensor
+    uint16_t crc;           // CRC16 (MODBUS) over all previous fields
+};
+
+// Serial console reply, one line of text (28 bytes)
+struct __attribute__((packed)) ConsoleFrame {
+    TelemetryType type;     // TelemetryType::CONSOLE
+    uint8_t sequence;       // Shared with the other frame types
+    char text[24];          // ASCII reply, NUL padded
+    uint16_t crc;           // CRC16 (MODBUS) over all previous fields
+};
+
 #endif // DEBUG_LEVEL > 0
 #endif // DATASTRUCTURES_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef GAINSCHEDULE_H
+#define GAINSCHEDULE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// PID gains per base speed bucket, stored in PROGMEM.
+// Replaces the fixed 0.85 correction factor above speed 200.
+struct GainPoint {
+    uint16_t kp;      // Q8
+    uint16_t kd;      // Q4
+    uint16_t filter;  // Q8, 256 = no filtering
+};
+
+struct GainSchedule {
+    GainPoint point[GAIN_SCHEDULE_BUCKETS];
+};
+
+static_assert(((GAIN_SCHEDULE_BUCKETS - 1) << GAIN_SCHEDULE_SHIFT) >= 255,
+    "Gain schedule must cover every speed");
+static_assert(GAIN_KD_FRACTION_BITS <= GAIN_KP_FRACTION_BITS, "Kd is aligned to Kp by a left shift");
+
+// Rounded fixed point value, saturated to the field
+constexpr uint16_t gainToFixed(float value, uint8_t fractionBits) {
+    return (value * (1 << fractionBits) >= 65535.0f) ? 65535 :
+        (value <= 0.0f) ? 0 : uint16_t(value * (1 << fractionBits) + 0.5f);
+}
+
+// Profile gains shaped by GAIN_SCHEDULE_SCALE, same filter in every bucket
+constexpr GainSchedule makeGainSchedule(float kp, float kd, float filter) {
+    GainSchedule schedule{};
+    for (uint8_t i = 0; i < GAIN_SCHEDULE_BUCKETS; i++) {
+        schedule.point[i].kp = gainToFixed(kp * GAIN_SCHEDULE_SCALE[i], GAIN_KP_FRACTION_BITS);
+        schedule.point[i].kd = gainToFixed(kd * GAIN_SCHEDULE_SCALE[i], GAIN_KD_FRACTION_BITS);
+        schedule.point[i].filter = gainToFixed(filter, GAIN_FILTER_FRACTION_BITS);
+    }
+    return schedule;
+}
+
+#endif // GAINSCHEDULE_H
@@ -1,46 +1,146 @@
 #include "LedPattern.h"
-#include "config.h"
-#include <Arduino.h>
 
-Timer LedPattern::patternTimer;
-bool LedPattern::isPatternActive = false;
-uint8_t LedPattern::patternState = 0;
-uint32_t LedPattern::patternStartTime = 0;
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#endif
+
+// Indexed by LedPatternId
+static const LedSequence SEQUENCES[LED_PATTERN_COUNT] PROGMEM = {
+    // LED_PATTERN_ON, stepped only to refresh the pin
+    makeLedSequence(255, true, "1"),
+    // LED_PATTERN_TRANSMISSION, 3 s of 1 s blinks then 3 s of 300 ms blinks
+    makeLedSequence(LED_STEP_TICKS_FAST, true,
+        "0000000000" "1111111111" "0000000000"
+        "111000" "111000" "111000" "111000" "111000"),
+    // LED_PATTERN_ERROR_CALIBRATION
+    makeLedSequence(LED_STEP_TICKS_SLOW, false, "1010000000"),
+    // LED_PATTERN_ERROR_FLASH
+    makeLedSequence(LED_STEP_TICKS_SLOW, true, "1010100000"),
+    // LED_PATTERN_PROFILE_ANALYSIS
+    makeLedSequence(LED_STEP_TICKS_FAST, false, "11000"),
+    // LED_PATTERN_PROFILE_SPEED
+    makeLedSequence(LED_STEP_TICKS_FAST, false, "110110000"),
+};
+
+// Static member initialization
+volatile uint8_t LedPattern::channelPatterns[LED_CHANNEL_COUNT] = { NONE, NONE, NONE, NONE };
+volatile uint8_t LedPattern::activeChannel = NONE;
+volatile uint8_t LedPattern::stepIndex = 0;
+volatile uint8_t LedPattern::stepTicks = 0;
+volatile uint8_t* LedPattern::ledPort = nullptr;
+uint8_t LedPattern::ledMask = 0;
+
+#ifdef __AVR__
+// Timer0 keeps running millis(), the compare A match adds a second
+// interrupt per overflow period without touching its configuration
+ISR(TIMER0_COMPA_vect) {
+    LedPattern::tick();
+}
+#endif
 
 void LedPattern::initialize() {
+    uint8_t oldSREG = SREG;
+    cli();
+
     pinMode(PIN_STATUS_LED, OUTPUT);
-}
+#ifdef __AVR__
+    ledPort = portOutputRegister(digitalPinToPort(PIN_STATUS_LED));
+    ledMask = digitalPinToBitMask(PIN_STATUS_LED);
+#endif
 
-void LedPattern::startTransmissionPattern() {
-    isPatternActive = true;
-    patternState = 0;
-    patternStartTime = millis();
-    patternTimer.Start(1000); // Start with slow blink
+    for (uint8_t i = 0; i < LED_CHANNEL_COUNT; i++) {
+        channelPatterns[i] = NONE;
+    }
+    activeChannel = NONE;
+    writeLed(false);
+
+#ifdef __AVR__
+    OCR0A = LED_TIMER_COMPARE;
+    TIFR0 = _BV(OCF0A);
+    TIMSK0 |= _BV(OCIE0A);
+#endif
+
+    SREG = oldSREG;
 }
 
-void LedPattern::stopPattern() {
-    isPatternActive = false;
-    digitalWrite(PIN_STATUS_LED, LOW);
+void LedPattern::play(LedChannel channel, LedPatternId pattern) {
+    uint8_t oldSREG = SREG;
+    cli();
+
+    if (channelPatterns[channel] != pattern) {
+        channelPatterns[channel] = pattern;
+        // A new pattern on the owning channel starts from its first step
+        if (activeChannel == channel) {
+            activeChannel = NONE;
+        }
+        arbitrate();
+    }
+
+    SREG = oldSREG;
 }
 
-void LedPattern::process() {
-    if (!isPatternActive) return;
+void LedPattern::stop(LedChannel channel) {
+    uint8_t oldSREG = SREG;
+    cli();
 
-    uint32_t elapsed = millis() - patternStartTime;
+    if (channelPatterns[channel] != NONE) {
+        channelPatterns[channel] = NONE;
+        arbitrate();
+    }
 
-    // Switch pattern every 3 seconds
-    if (elapsed >= 3000 && patternState == 0) {
-        patternState = 1;
-        patternTimer.Start(300);  // Switch to fast blink
+    SREG = oldSREG;
+}
+
+void LedPattern::tick() {
+    if (activeChannel == NONE) return;
+    if (--stepTicks != 0) return;
+
+    const LedSequence* sequence = &SEQUENCES[channelPatterns[activeChannel]];
+    if (++stepIndex >= pgm_read_byte(&sequence->length)) {
+        if (!pgm_read_byte(&sequence->repeat)) {
+            // One-shot done, the LED goes to the next busy channel
+            channelPatterns[activeChannel] = NONE;
+            arbitrate();
+            return;
+        }
+        stepIndex = 0;
     }
-    else if (elapsed >= 6000) {
-        patternState = 0;
-        patternTimer.Start(1000); // Back to slow blink
-        patternStartTime = millis();
+    showStep();
+}
+
+void LedPattern::arbitrate() {
+    uint8_t channel = 0;
+    while (channel < LED_CHANNEL_COUNT && channelPatterns[channel] == NONE) {
+        channel++;
     }
 
-    if (patternTimer.Expired()) {
-        digitalWrite(PIN_STATUS_LED, !digitalRead(PIN_STATUS_LED));
-        patternTimer.Start(patternState == 0 ? 1000 : 300);
+    if (channel == LED_CHANNEL_COUNT) {
+        activeChannel = NONE;
+        writeLed(false);
+        return;
     }
-}
\ No newline at end of file
+
+    // Owner unchanged, its sequence carries on
+    if (channel == activeChannel) return;
+
+    activeChannel = channel;
+    stepIndex = 0;
+    showStep();
+}
+
+void LedPattern::showStep() {
+    const LedSequence* sequence = &SEQUENCES[channelPatterns[activeChannel]];
+    stepTicks = pgm_read_byte(&sequence->stepTicks);
+    uint8_t bits = pgm_read_byte(&sequence->bits[stepIndex >> 3]);
+    writeLed(bits & (0x80 >> (stepIndex & 7)));
+}
+
+void LedPattern::writeLed(bool on) {
+#ifdef __AVR__
+    // Read-modify-write is safe here, interrupts are off
+    if (on) *ledPort |= ledMask;
+    else *ledPort &= ~ledMask;
+#else
+    digitalWrite(PIN_STATUS_LED, on ? HIGH : LOW);
+#endif
+}
@@ -1,20 +1,82 @@
 #ifndef LEDPATTERN_H
 #define LEDPATTERN_H
 
-#include "Timer.h"
+#include <Arduino.h>
+#include "config.h"
 
+// Users of the status LED, highest priority first
+enum LedChannel : uint8_t {
+    LED_CHANNEL_ERROR = 0,      // Error codes
+    LED_CHANNEL_TRANSMISSION,   // Log transmission in progress
+    LED_CHANNEL_MARKER,         // Course marker under a sensor
+    LED_CHANNEL_STATUS,         // Setup progress
+    LED_CHANNEL_COUNT
+};
+
+// Sequences in the PROGMEM table of LedPattern.cpp
+enum LedPatternId : uint8_t {
+    LED_PATTERN_ON = 0,             // Steady on
+    LED_PATTERN_TRANSMISSION,       // Slow then fast blink
+    LED_PATTERN_ERROR_CALIBRATION,  // Two flashes, once: no stored calibration
+    LED_PATTERN_ERROR_FLASH,        // Three flashes, repeated: log write failed
+    LED_PATTERN_PROFILE_ANALYSIS,   // One flash, once: analysis profile selected
+    LED_PATTERN_PROFILE_SPEED,      // Two flashes, once: speed profile selected
+    LED_PATTERN_COUNT
+};
+
+// One LED state per step, MSB of bits[0] first
+struct LedSequence {
+    uint8_t stepTicks;      // Timer ticks per step
+    uint8_t length;         // Steps in the sequence
+    bool repeat;            // Loop, or release the channel after the last step
+    uint8_t bits[LED_SEQUENCE_MAX_STEPS / 8];
+};
+
+// Sequence from a string of '1' (on) and '0' (off) steps, built at compile time
+constexpr LedSequence makeLedSequence(uint8_t stepTicks, bool repeat, const char* steps) {
+    LedSequence sequence{};
+    sequence.stepTicks = stepTicks;
+    sequence.repeat = repeat;
+    while (steps[sequence.length] != '\0' && sequence.length < LED_SEQUENCE_MAX_STEPS) {
+        if (steps[sequence.length] == '1') {
+            sequence.bits[sequence.length >> 3] |= 0x80 >> (sequence.length & 7);
+        }
+        sequence.length++;
+    }
+    return sequence;
+}
+
+// Status LED pattern engine.
+// Each channel holds the pattern it wants shown; the highest priority busy
+// channel owns the LED and the others wait their turn. The sequence is
+// stepped by the Timer0 compare A interrupt, so patterns cost no loop time;
+// play() and stop() only update the arbitration.
 class LedPattern {
 public:
+    // LED pin and Timer0 compare interrupt
     static void initialize();
-    static void startTransmissionPattern();
-    static void stopPattern();
-    static void process();
+
+    // Show a pattern on a channel, no effect if it is already shown there
+    static void play(LedChannel channel, LedPatternId pattern);
+    static void stop(LedChannel channel);
+
+    // One step tick, from the Timer0 compare A interrupt
+    static void tick();
 
 private:
-    static Timer patternTimer;
-    static bool isPatternActive;
-    static uint8_t patternState;  // 0 = slow blink, 1 = fast blink
-    static uint32_t patternStartTime;
+    static constexpr uint8_t NONE = 0xFF;
+
+    static volatile uint8_t channelPatterns[LED_CHANNEL_COUNT];  // NONE when idle
+    static volatile uint8_t activeChannel;  // Channel owning the LED
+    static volatile uint8_t stepIndex;
+    static volatile uint8_t stepTicks;      // Ticks left in the current step
+    static volatile uint8_t* ledPort;
+    static uint8_t ledMask;
+
+    // Both run with interrupts disabled
+    static void arbitrate();
+    static void showStep();
+    static void writeLed(bool on);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,9 @@
 #include "CircularBuffer.h"
 #include "Sensors.h"
 #include "ProfileManager.h"  // Added include for ProfileManager
+#include "Scheduler.h"
+#include "LedPattern.h"
+#include "MotorsDrivers.h"
 
 #if DEBUG_LEVEL > 0
 
@@ -10,6 +13,16 @@ static constexpr uint8_t PERFORMANCE_BUFFER_SIZE = 32;
 static constexpr uint8_t EVENT_BUFFER_SIZE = 16;
 static constexpr uint8_t STATS_BUFFER_SIZE = 8;
 
+// A record taken by logPerformance must reach the buffer before the next one
+static_assert(TASK_PERIOD_LOG_SAMPLE_US <= LOG_SAMPLE_MIN_INTERVAL * 1000UL,
+    "Record hand-off slower than the shortest sample interval");
+static_assert(LOG_SAMPLE_MIN_INTERVAL <= LOG_SAMPLE_MAX_INTERVAL, "Sample interval range is empty");
+
+// At the highest record rate the buffer must outlast two flush periods, the
+// flush waits for a straight and records pushed into a full buffer are lost
+static_assert(PERFORMANCE_BUFFER_SIZE * LOG_SAMPLE_MIN_INTERVAL * 1000UL >= 2 * LOG_FLUSH_INTERVAL_US,
+    "Performance buffer fills between flushes");
+
 // Buffers for different record types
 static CircularBuffer<PerformanceRecord, PERFORMANCE_BUFFER_SIZE> performanceBuffer;
 static CircularBuffer<EventRecord, EVENT_BUFFER_SIZE> eventBuffer;
@@ -21,8 +34,9 @@ bool Logger::loggingActive = false;
 uint32_t Logger::sessionStartTime = 0;
 uint8_t Logger::currentLap = 0;
 uint16_t Logger::curveCount = 0;
-uint32_t Logger::lastSampleTime = 0;
-uint32_t Logger::lastFlushTime = 0;
+bool Logger::hasPendingRecord = false;
+PerformanceRecord Logger::latestRecord;
+PerformanceRecord Logger::sampledRecord;
 float Logger::totalDeviation = 0;
 uint32_t Logger::sampleCount = 0;
 uint8_t Logger::maxSpeed = 0;
@@ -64,26 +78,29 @@ bool Logger::startSession(DebugMode mode, uint8_t plannedLaps) {
     header.startTime = millis();
     header.mode = mode;
     header.plannedLaps = plannedLaps;
+    header.configuredSpeed = ProfileManager::getSpeedValue(BASE_FAST);
     header.pidKp = ProfileManager::getKP(K_PROPORTIONAL_DEFAULT);
     header.pidKd = ProfileManager::getKD(K_DERIVATIVE_DEFAULT);
     header.filterAlpha = ProfileManager::getFilterCoefficient(FILTER_COEFFICIENT_DEFAULT);
 
     // Store calibration values
-    for (uint8_t i = 0; i < 6; i++) {
-        // TODO: Get actual calibration values from Sensors class
-        header.sensorCalibrationData[i] = 0;
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        header.sensorCalibrationData[i] = Sensors::getSensorMin(i);
+        header.sensorCalibrationData[NUM_SENSORES + i] = Sensors::getSensorMax(i);
     }
 
     header.headerChecksum = calculateChecksum(&header, sizeof(SessionHeader) - sizeof(uint32_t));
 
     if (!FlashManager::writeBlock(&header, sizeof(SessionHeader))) {
+        LedPattern::play(LED_CHANNEL_ERROR, LED_PATTERN_ERROR_FLASH);
         return false;
     }
 
     sessionStartTime = header.startTime;
     loggingActive = true;
-    lastSampleTime = sessionStartTime;
-    lastFlushTime = sessionStartTime;
+    hasPendingRecord = false;
+    // Sample intervals count from the session start
+    sampledRecord.timestamp = 0;
 
     // Log session start event
     logEvent(EventType::SESSION_START);
@@ -94,27 +111,74 @@ bool Logger::startSession(DebugMode mode, uint8_t plannedLaps) {
 void Logger::endSession() {
     if (!loggingActive) return;
 
+    // Loop rate shows the time left by the control path (acquisition mode)
+    logEvent(EventType::LOOP_RATE, min(Scheduler::getLoopRate(), (uint32_t)UINT16_MAX));
+
+    // Effective line sensor noise with the oversampling used in this run
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        uint16_t noise = min((uint16_t)(Sensors::getNoiseFloor(i) * 16.0f + 0.5f), (uint16_t)0x0FFF);
+        logEvent(EventType::NOISE_FLOOR, ((uint16_t)i << 12) | noise);
+    }
+
+    // How often the output stage held each wheel back
+    uint32_t periods = max(MotorDriver::getOutputPeriods(), (uint32_t)1);
+    for (uint8_t limit = 0; limit < MOTOR_LIMIT_COUNT; limit++) {
+        for (uint8_t wheel = 0; wheel < MOTOR_WHEEL_COUNT; wheel++) {
+            uint16_t share = MotorDriver::getLimitCount((MotorLimit)limit, (MotorWheel)wheel) * 1000 / periods;
+            logEvent(EventType::OUTPUT_LIMIT, ((uint16_t)limit << 13) | ((uint16_t)wheel << 12) | share);
+        }
+    }
+
     // Log session end event
     logEvent(EventType::SESSION_END);
 
-    // Force flush of remaining data
-    flushBuffers();
+    // Force flush of remaining data, the run is over so the line
+    // position does not matter (lap events would be lost in a curve)
+    flushBuffers(true);
 
     loggingActive = false;
 }
 
 void Logger::logPerformance(int16_t linePosition, int16_t error, int16_t correction,
-    uint8_t leftSpeed, uint8_t rightSpeed, uint8_t state) {
-    if (!loggingActive || !shouldSample()) return;
+    int16_t leftSpeed, int16_t rightSpeed, uint8_t state) {
+    if (!loggingActive) return;
 
-    PerformanceRecord record;
-    record.timestamp = millis() - sessionStartTime;
-    record.linePosition = linePosition;
-    record.error = error;
-    record.correction = correction;
-    record.speedLeft = leftSpeed;
-    record.speedRight = rightSpeed;
-    record.state = state;
+    // Only keep the values, the sampling task decides what is recorded
+    latestRecord.timestamp = millis() - sessionStartTime;
+    latestRecord.linePosition = linePosition;
+    latestRecord.error = error;
+    latestRecord.correction = correction;
+    // Forward speed only, host tools integrate it into distance
+    latestRecord.speedLeft = constrain(leftSpeed, 0, 255);
+    latestRecord.speedRight = constrain(rightSpeed, 0, 255);
+    latestRecord.state = state;
+
+    // Records go where the values move, with a floor and a ceiling on the rate
+    uint32_t elapsed = latestRecord.timestamp - sampledRecord.timestamp;
+    if (elapsed >= LOG_SAMPLE_MAX_INTERVAL ||
+        (elapsed >= LOG_SAMPLE_MIN_INTERVAL && hasChanged())) {
+        sampledRecord = latestRecord;
+        hasPendingRecord = true;
+    }
+}
+
+bool Logger::hasChanged() {
+    // Centred on the line there is only the PID dither to see
+    if (abs(latestRecord.error) < LOG_ERROR_DEADBAND && abs(sampledRecord.error) < LOG_ERROR_DEADBAND) {
+        return false;
+    }
+
+    return abs(latestRecord.error - sampledRecord.error) >= LOG_DELTA_ERROR ||
+        abs(latestRecord.correction - sampledRecord.correction) >= LOG_DELTA_CORRECTION ||
+        abs(latestRecord.speedLeft - sampledRecord.speedLeft) >= LOG_DELTA_MOTOR ||
+        abs(latestRecord.speedRight - sampledRecord.speedRight) >= LOG_DELTA_MOTOR;
+}
+
+void Logger::sample() {
+    if (!loggingActive || !hasPendingRecord) return;
+    hasPendingRecord = false;
+
+    PerformanceRecord record = sampledRecord;
     record.checksum = calculateChecksum(&record, sizeof(PerformanceRecord) - sizeof(uint8_t));
 
     // Update statistics
@@ -168,31 +232,32 @@ void Logger::getSessionStats(uint32_t& duration, uint8_t& completedLaps,
     avgDeviation = sampleCount > 0 ? totalDeviation / sampleCount : 0;
 }
 
-void Logger::process() {
-    if (!loggingActive) return;
+bool Logger::process() {
+    if (!loggingActive) return true;
 
-    // Check if it's time to flush buffers
-    uint32_t currentTime = millis();
-    if (currentTime - lastFlushTime >= 1000) { // Flush every second or when in straight line
-        if (abs(Sensors::calculateLinePosition()) < STRAIGHT_THRESHOLD) {
-            flushBuffers();
-            lastFlushTime = currentTime;
-        }
+    // Flush only in a straight line
+    if (abs(latestRecord.linePosition) >= STRAIGHT_THRESHOLD) {
+        return false;
     }
+
+    flushBuffers();
+    return true;
 }
 
-void Logger::flushBuffers() {
+void Logger::flushBuffers(bool force) {
     // Only flush if we can write
-    if (!FlashManager::canWrite(Sensors::calculateLinePosition())) {
+    if (!force && !FlashManager::canWrite(latestRecord.linePosition)) {
         return;
     }
 
+    bool written = true;
+
     // Write performance records
     if (!performanceBuffer.isEmpty()) {
         uint8_t count = performanceBuffer.getCount();
         PerformanceRecord records[count];
         performanceBuffer.popMultiple(records, count);
-        FlashManager::writeBlock(records, count * sizeof(PerformanceRecord));
+        written &= FlashManager::writeBlock(records, count * sizeof(PerformanceRecord));
     }
 
     // Write event records
@@ -200,7 +265,7 @@ void Logger::flushBuffers() {
         uint8_t count = eventBuffer.getCount();
         EventRecord records[count];
         eventBuffer.popMultiple(records, count);
-        FlashManager::writeBlock(records, count * sizeof(EventRecord));
+        written &= FlashManager::writeBlock(records, count * sizeof(EventRecord));
     }
 
     // Write lap stats
@@ -208,29 +273,13 @@ void Logger::flushBuffers() {
         uint8_t count = statsBuffer.getCount();
         LapStats records[count];
         statsBuffer.popMultiple(records, count);
-        FlashManager::writeBlock(records, count * sizeof(LapStats));
-    }
-}
-
-bool Logger::shouldSample() {
-    uint32_t currentTime = millis();
-    int16_t position = Sensors::calculateLinePosition();
-    uint32_t sampleInterval;
-
-    // Adjust sample rate based on position
-    if (abs(position) > TURN_THRESHOLD) {
-        sampleInterval = SAMPLE_RATE_CURVE;  // Higher rate in curves
-    }
-    else {
-        sampleInterval = SAMPLE_RATE_STRAIGHT;  // Lower rate in straight lines
+        written &= FlashManager::writeBlock(records, count * sizeof(LapStats));
     }
 
-    if (currentTime - lastSampleTime >= sampleInterval) {
-        lastSampleTime = currentTime;
-        return true;
+    // Records were lost (flash full or write error)
+    if (!written) {
+        LedPattern::play(LED_CHANNEL_ERROR, LED_PATTERN_ERROR_FLASH);
     }
-
-    return false;
 }
 
 uint8_t Logger::calculateChecksum(const void* data, uint16_t size) {
@@ -19,10 +19,15 @@ public:
     // End current session
     static void endSession();
 
-    // Log a performance record
+    // Update the latest control values and take a record when they moved
+    // by a LOG_DELTA_ since the last one (call every control cycle)
     static void logPerformance(int16_t linePosition, int16_t error,
-        int16_t correction, uint8_t leftSpeed,
-        uint8_t rightSpeed, uint8_t state);
+        int16_t correction, int16_t leftSpeed,
+        int16_t rightSpeed, uint8_t state);
+
+    // Move the record taken by logPerformance to the buffer
+    // (call every TASK_PERIOD_LOG_SAMPLE_US)
+    static void sample();
 
 // Log an event
     static void logEvent(EventType type, uint16_t data = 0);
@@ -37,8 +42,9 @@ public:
     static void getSessionStats(uint32_t& duration, uint8_t& completedLaps,
         uint16_t& totalCurves, float& avgDeviation);
 
-// Process pending operations (call in main loop)
-    static void process();
+// Flush buffers, returns false while waiting for a straight section
+    // (call every LOG_FLUSH_INTERVAL_US)
+    static bool process();
 
 private:
     static bool isInitialized;
@@ -46,15 +52,16 @@ private:
     static uint32_t sessionStartTime;
     static uint8_t currentLap;
     static uint16_t curveCount;
-    static uint32_t lastSampleTime;
-    static uint32_t lastFlushTime;
+    static bool hasPendingRecord;       // sampledRecord not yet buffered
+    static PerformanceRecord latestRecord;
+    static PerformanceRecord sampledRecord; // Last record taken
 
     // Internal methods
     static void writeSessionHeader();
-    static void flushBuffers();
-    static bool shouldSample();
+    static void flushBuffers(bool force = false);  // force: write even off a straight
     static uint8_t calculateChecksum(const void* data, uint16_t size);
     static void updateStats(const PerformanceRecord& record);
+    static bool hasChanged();   // latestRecord moved away from sampledRecord, off the line centre
 
     // Running statistics
     static float totalDeviation;
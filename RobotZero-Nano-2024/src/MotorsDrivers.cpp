@@ -2,6 +2,20 @@
 #include "MotorsDrivers.h"
 #include "config.h"
 
+#if DEBUG_LEVEL > 0
+#include "ProfileManager.h"
+#endif
+
+// First-order lag of the motor model over one control period (12 fraction bits)
+static constexpr int32_t SPEED_MODEL_GAIN = 4096L * TASK_PERIOD_CONTROL_US /
+  (MOTOR_MODEL_TIME_CONSTANT * 1000L + TASK_PERIOD_CONTROL_US);
+
+// Static member initialization
+MotorDriver::WheelOutput MotorDriver::wheels[MOTOR_WHEEL_COUNT] = {};
+uint32_t MotorDriver::limitCounts[MOTOR_LIMIT_COUNT][MOTOR_WHEEL_COUNT] = {};
+uint32_t MotorDriver::outputPeriods = 0;
+int32_t MotorDriver::speedEstimate = 0;
+
 void MotorDriver::initializeMotorDriver() {
   pinMode(PIN_MOTOR_LEFT_FWD, OUTPUT);
   pinMode(PIN_MOTOR_LEFT_REV, OUTPUT);
@@ -9,6 +23,17 @@ void MotorDriver::initializeMotorDriver() {
   pinMode(PIN_MOTOR_RIGHT_FWD, OUTPUT);
   pinMode(PIN_MOTOR_RIGHT_REV, OUTPUT);
   pinMode(PIN_MOTOR_RIGHT_PWM, OUTPUT);
+
+#ifdef __AVR__
+  // The right PWM pin is on Timer1, which TimeBase runs in 8-bit fast PWM at
+  // clk/8 (7.8 kHz). The left one is on Timer2: same mode and prescaler, so
+  // both wheels get the same carrier for the same duty
+  static_assert(PIN_MOTOR_LEFT_PWM == 3 && PIN_MOTOR_RIGHT_PWM == 10,
+    "PWM carriers are matched for Timer2 (pin 3) and Timer1 (pin 10)");
+  TCCR2A = (TCCR2A & (_BV(COM2A1) | _BV(COM2A0) | _BV(COM2B1) | _BV(COM2B0))) |
+    _BV(WGM21) | _BV(WGM20);
+  TCCR2B = _BV(CS21);
+#endif
 }
 
 void MotorDriver::setLeftMotorPower(int value) {
@@ -46,6 +71,112 @@ void MotorDriver::setRightMotorPower(int value) {
 }
 
 void MotorDriver::setMotorsPower(int left, int right) {
+#if DEBUG_LEVEL > 0
+  uint8_t accelerationStep = ProfileManager::getAccelerationStep();
+  uint8_t brakeStep = ProfileManager::getBrakeStep();
+#else
+  uint8_t accelerationStep = ACCELERATION_STEP;
+  uint8_t brakeStep = BRAKE_STEP;
+#endif
+
+  updateWheel(MOTOR_WHEEL_LEFT, limitWheel(MOTOR_WHEEL_LEFT, left, accelerationStep, brakeStep));
+  updateWheel(MOTOR_WHEEL_RIGHT, limitWheel(MOTOR_WHEEL_RIGHT, right, accelerationStep, brakeStep));
+  outputPeriods++;
+  applyOutputs();
+}
+
+void MotorDriver::stopMotors() {
+  wheels[MOTOR_WHEEL_LEFT].filtered = 0;
+  wheels[MOTOR_WHEEL_RIGHT].filtered = 0;
+  updateWheel(MOTOR_WHEEL_LEFT, 0);
+  updateWheel(MOTOR_WHEEL_RIGHT, 0);
+  applyOutputs();
+}
+
+int MotorDriver::getLeftOutput() {
+  return wheels[MOTOR_WHEEL_LEFT].power;
+}
+
+int MotorDriver::getRightOutput() {
+  return wheels[MOTOR_WHEEL_RIGHT].power;
+}
+
+void MotorDriver::resetOutputStage() {
+  for (uint8_t wheel = 0; wheel < MOTOR_WHEEL_COUNT; wheel++) {
+    wheels[wheel].filtered = 0;
+    wheels[wheel].power = 0;
+    wheels[wheel].direction = 0;
+    wheels[wheel].deadTime = 0;
+    for (uint8_t limit = 0; limit < MOTOR_LIMIT_COUNT; limit++) {
+      limitCounts[limit][wheel] = 0;
+    }
+  }
+  outputPeriods = 0;
+  speedEstimate = 0;
+}
+
+uint32_t MotorDriver::getLimitCount(MotorLimit limit, MotorWheel wheel) {
+  return limitCounts[limit][wheel];
+}
+
+uint32_t MotorDriver::getOutputPeriods() {
+  return outputPeriods;
+}
+
+int MotorDriver::getSpeedEstimate() {
+  return (speedEstimate + 2048) >> 12;
+}
+
+int16_t MotorDriver::limitWheel(MotorWheel index, int target, uint8_t accelerationStep,
+  uint8_t brakeStep) {
+  WheelOutput& wheel = wheels[index];
+  int16_t power = wheel.power;
+
+  // Filtered in place, the limits below act on the mean command
+  int32_t command = (int32_t)constrain(target, -255, 255) << 7;
+  wheel.filtered += (command - wheel.filtered) >> MOTOR_OUTPUT_FILTER_SHIFT;
+  target = (wheel.filtered + 64) >> 7;
+
+  // A reversal brakes to zero first, then waits out the dead time there
+  if ((power > 0 && target < 0) || (power < 0 && target > 0)) {
+    target = 0;
+  }
+  else if (power == 0 && target != 0 && wheel.deadTime > 0 &&
+    (target > 0 ? 1 : -1) != wheel.direction) {
+    limitCounts[MOTOR_LIMIT_DEAD_TIME][index]++;
+    return 0;
+  }
+
+  // Away from zero is acceleration, towards it braking
+  bool accelerating = abs(target) > abs(power);
+  int16_t step = accelerating ? accelerationStep : brakeStep;
+  if (abs(target - power) <= step) {
+    return target;
+  }
+
+  limitCounts[accelerating ? MOTOR_LIMIT_ACCELERATION : MOTOR_LIMIT_BRAKE][index]++;
+  return (target > power) ? power + step : power - step;
+}
+
+void MotorDriver::updateWheel(MotorWheel index, int16_t power) {
+  WheelOutput& wheel = wheels[index];
+  if (power != 0) {
+    wheel.direction = (power > 0) ? 1 : -1;
+    wheel.deadTime = MOTOR_REVERSE_DEAD_TIME;
+  }
+  else if (wheel.deadTime > 0) {
+    wheel.deadTime--;
+  }
+  wheel.power = power;
+}
+
+void MotorDriver::applyOutputs() {
+  int16_t left = wheels[MOTOR_WHEEL_LEFT].power;
+  int16_t right = wheels[MOTOR_WHEEL_RIGHT].power;
   setLeftMotorPower(left);
   setRightMotorPower(right);
-}
\ No newline at end of file
+
+  // Robot speed is the mean of both wheels
+  int32_t command = (int32_t)(left + right) << 11;
+  speedEstimate += (command - speedEstimate) * SPEED_MODEL_GAIN >> 12;
+}
@@ -1,6 +1,22 @@
 #ifndef MOTORDRIVER_H
 #define MOTORDRIVER_H
 
+#include <Arduino.h>
+
+// Output stage limits, as counted by MotorDriver
+enum MotorLimit : uint8_t {
+    MOTOR_LIMIT_ACCELERATION = 0,   // PWM rise cut to the acceleration step
+    MOTOR_LIMIT_BRAKE,              // PWM fall cut to the brake step
+    MOTOR_LIMIT_DEAD_TIME,          // Reversal held at zero
+    MOTOR_LIMIT_COUNT
+};
+
+enum MotorWheel : uint8_t {
+    MOTOR_WHEEL_LEFT = 0,
+    MOTOR_WHEEL_RIGHT,
+    MOTOR_WHEEL_COUNT
+};
+
 class MotorDriver {
 public:
     // Initialize motor driver pins
@@ -9,11 +25,49 @@ public:
     // Control left motor
     static void setLeftMotorPower(int value);
 
-    // Control right motor  
+    // Control right motor
     static void setRightMotorPower(int value);
 
-    // Control both motors
+    // Control both motors through the output stage (command filter, slew
+    // limits and reverse dead-time), once per control period
     static void setMotorsPower(int left, int right);
+
+    // Cut both motors at once, bypassing the slew limits
+    static void stopMotors();
+
+    // PWM last applied by the output stage
+    static int getLeftOutput();
+    static int getRightOutput();
+
+    // Output stage from standstill, limit counters cleared (run start)
+    static void resetOutputStage();
+
+    // Control periods since resetOutputStage() a limit held a wheel back,
+    // and control periods counted
+    static uint32_t getLimitCount(MotorLimit limit, MotorWheel wheel);
+    static uint32_t getOutputPeriods();
+
+    // Forward speed of the motor model (config.h) driven by the outputs
+    // of setMotorsPower, in PWM units
+    static int getSpeedEstimate();
+
+private:
+    struct WheelOutput {
+        int16_t filtered;   // Filtered command, 7 fraction bits
+        int16_t power;      // Last applied PWM
+        int8_t direction;   // Sign of the last non-zero PWM
+        uint8_t deadTime;   // Control periods left before a reversal
+    };
+
+    static WheelOutput wheels[MOTOR_WHEEL_COUNT];
+    static uint32_t limitCounts[MOTOR_LIMIT_COUNT][MOTOR_WHEEL_COUNT];
+    static uint32_t outputPeriods;
+    static int32_t speedEstimate;   // PWM units, 12 fraction bits
+
+    static int16_t limitWheel(MotorWheel wheel, int target, uint8_t accelerationStep,
+        uint8_t brakeStep);
+    static void updateWheel(MotorWheel wheel, int16_t power);
+    static void applyOutputs();
 };
 
 #endif // MOTORDRIVER_H
\ No newline at end of file
@@ -1,100 +1,159 @@
 #include <Arduino.h>
 #include "Peripherals.h"
 #include "config.h"
-#include "debug.h"
+#include "globals.h"
 #include "LedPattern.h"
+#include "Scheduler.h"
 
-#if DEBUG_LEVEL > 0
-#include "FlashManager.h"
-#include "FlashReader.h"
+#ifdef __AVR__
+#include <avr/interrupt.h>
 #endif
 
+static_assert(PIN_START_BUTTON >= 8 && PIN_START_BUTTON <= 13, "PCINT0_vect only covers port B");
+static_assert(DEBOUNCE_DELAY <= UINT8_MAX, "Debounce ticks are counted in a byte");
+
 // Static member initialization
-Peripherals::ButtonState Peripherals::buttonState = WAITING_PRESS;
-Timer Peripherals::debounceTimer;
-bool Peripherals::lastButtonState = LOW;
+volatile uint8_t Peripherals::buttonState = BUTTON_IDLE;
+volatile uint8_t Peripherals::events = 0;
+volatile bool Peripherals::buttonLevel = false;
+volatile uint8_t Peripherals::debounceTicks = 0;
+volatile uint16_t Peripherals::gestureTicks = 0;
+
+#ifdef __AVR__
+ISR(PCINT0_vect) {
+  Peripherals::pinChanged();
+}
+
+ISR(TIMER0_COMPB_vect) {
+  Peripherals::tick();
+}
+#endif
 
 void Peripherals::initialize() {
+  uint8_t oldSREG = SREG;
+  cli();
+
   pinMode(PIN_START_BUTTON, INPUT);
-  buttonState = WAITING_PRESS;
-#if DEBUG_LEVEL > 0
   LedPattern::initialize();
+
+  // Held at boot to force a calibration, no gesture until released
+  buttonLevel = digitalRead(PIN_START_BUTTON) == HIGH;
+  buttonState = buttonLevel ? BUTTON_HELD : BUTTON_IDLE;
+  events = 0;
+  debounceTicks = 0;
+
+#ifdef __AVR__
+  OCR0B = BUTTON_TIMER_COMPARE;
+  PCIFR = _BV(digitalPinToPCICRbit(PIN_START_BUTTON));
+  *digitalPinToPCMSK(PIN_START_BUTTON) |= _BV(digitalPinToPCMSKbit(PIN_START_BUTTON));
+  *digitalPinToPCICR(PIN_START_BUTTON) |= _BV(digitalPinToPCICRbit(PIN_START_BUTTON));
 #endif
+
+  SREG = oldSREG;
 }
 
-void Peripherals::waitForButtonPress() {
-  buttonState = WAITING_PRESS;
+uint8_t Peripherals::takeEvents() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint8_t pending = events;
+  events = 0;
+  SREG = oldSREG;
+  return pending;
+}
 
-#if DEBUG_LEVEL > 0
-// In debug mode, check if there's a log ready to be transmitted
-  if (FlashManager::isLogReady()) {
-    bool currentState = digitalRead(PIN_START_BUTTON);
+void Peripherals::pinChanged() {
+  // Ignore the bounce, the level is read once it had DEBOUNCE_DELAY to settle
+#ifdef __AVR__
+  *digitalPinToPCMSK(PIN_START_BUTTON) &= ~_BV(digitalPinToPCMSKbit(PIN_START_BUTTON));
+#endif
+  debounceTicks = DEBOUNCE_DELAY;
+  setTickEnabled(true);
+}
 
-    if (currentState != lastButtonState) {
-      debounceTimer.Start(DEBOUNCE_DELAY);
-      if (currentState == HIGH) {
-        buttonState = DEBOUNCING_PRESS;
-      }
+void Peripherals::tick() {
+  if (debounceTicks != 0 && --debounceTicks == 0) {
+    // Listen for edges again before reading, a change after the read
+    // starts a new debounce
+#ifdef __AVR__
+    PCIFR = _BV(digitalPinToPCICRbit(PIN_START_BUTTON));
+    *digitalPinToPCMSK(PIN_START_BUTTON) |= _BV(digitalPinToPCMSKbit(PIN_START_BUTTON));
+#endif
+    bool level = digitalRead(PIN_START_BUTTON) == HIGH;
+    if (level != buttonLevel) {
+      buttonLevel = level;
+      if (level) pressed();
+      else released();
     }
+  }
+
+  switch (buttonState) {
+  case BUTTON_PRESSED:
+    if (++gestureTicks >= LONG_PRESS_TIME) {
+      buttonState = BUTTON_HELD;
+      report(BUTTON_EVENT_LONG);
+    }
+    break;
 
-    if (debounceTimer.Expired() && buttonState == DEBOUNCING_PRESS) {
-        // Start log transmission
-      LedPattern::startTransmissionPattern();
-      FlashReader::processCommands();
-      LedPattern::stopPattern();
-      return;
+  case BUTTON_RELEASED:
+    if (++gestureTicks >= DOUBLE_PRESS_GAP) {
+      buttonState = BUTTON_IDLE;
+      report(BUTTON_EVENT_SHORT);
     }
-    lastButtonState = currentState;
-    return;
+    break;
+
+  default:
+    break;
   }
-#else
-// In normal mode, clear the log ready flag
-  FlashManager::clearLogReady();
-#endif
 
-// Normal button operation for calibration/start
-  while (buttonState != BUTTON_HANDLED) {
-    bool currentState = digitalRead(PIN_START_BUTTON);
+  // Nothing left to time, the next edge enables the tick again
+  if (debounceTicks == 0 && buttonState != BUTTON_PRESSED && buttonState != BUTTON_RELEASED) {
+    setTickEnabled(false);
+  }
+}
 
-    if (currentState != lastButtonState) {
-      debounceTimer.Start(DEBOUNCE_DELAY);
+void Peripherals::pressed() {
+  report(BUTTON_EVENT_PRESS);
+  gestureTicks = 0;
+  buttonState = (buttonState == BUTTON_RELEASED) ? BUTTON_SECOND_PRESS : BUTTON_PRESSED;
+}
 
-      if (currentState == HIGH) {
-        buttonState = DEBOUNCING_PRESS;
-      }
-      else {
-        buttonState = DEBOUNCING_RELEASE;
-      }
-    }
+void Peripherals::released() {
+  gestureTicks = 0;
 
-    if (debounceTimer.Expired()) {
-      switch (buttonState) {
-      case DEBOUNCING_PRESS:
-        if (currentState == HIGH) {
-          buttonState = WAITING_RELEASE;
-        }
-        else {
-          buttonState = WAITING_PRESS;
-        }
-        break;
-
-      case DEBOUNCING_RELEASE:
-        if (currentState == LOW) {
-          buttonState = BUTTON_HANDLED;
-        }
-        else {
-          buttonState = WAITING_RELEASE;
-        }
-        break;
-
-      case WAITING_PRESS:
-      case WAITING_RELEASE:
-      case BUTTON_HANDLED:
-      default:
-        break;
-      }
-    }
+  switch (buttonState) {
+  case BUTTON_PRESSED:
+    buttonState = BUTTON_RELEASED;
+    break;
 
-    lastButtonState = currentState;
+  case BUTTON_SECOND_PRESS:
+    buttonState = BUTTON_IDLE;
+    report(BUTTON_EVENT_DOUBLE);
+    break;
+
+  default:
+    // End of a long press, or of the press held at boot
+    buttonState = BUTTON_IDLE;
+    break;
   }
-}
\ No newline at end of file
+}
+
+void Peripherals::report(uint8_t event) {
+  events |= event;
+  // Runs the button task once the interrupt returns, nothing polls for it
+  Scheduler::post(buttonTask);
+}
+
+void Peripherals::setTickEnabled(bool enabled) {
+#ifdef __AVR__
+  if (!enabled) {
+    TIMSK0 &= ~_BV(OCIE0B);
+  }
+  else if (!(TIMSK0 & _BV(OCIE0B))) {
+    // Start on the next compare match, not on a stale flag
+    TIFR0 = _BV(OCF0B);
+    TIMSK0 |= _BV(OCIE0B);
+  }
+#else
+  (void)enabled;
+#endif
+}
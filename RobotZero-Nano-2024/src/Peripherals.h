@@ -1,30 +1,50 @@
 #ifndef PERIPHERALS_H
 #define PERIPHERALS_H
 
-#include "Timer.h"
+#include <Arduino.h>
+
+// Debounced button gestures, bits returned by Peripherals::takeEvents()
+enum ButtonEvent : uint8_t {
+    BUTTON_EVENT_PRESS = 0x01,      // Button went down, reported at once
+    BUTTON_EVENT_SHORT = 0x02,      // Released, no second press within DOUBLE_PRESS_GAP
+    BUTTON_EVENT_LONG = 0x04,       // Held for LONG_PRESS_TIME, reported while held
+    BUTTON_EVENT_DOUBLE = 0x08      // Second press within DOUBLE_PRESS_GAP, on its release
+};
 
 class Peripherals {
 private:
-    // Button state machine states
-    enum ButtonState {
-        WAITING_PRESS,
-        DEBOUNCING_PRESS,
-        WAITING_RELEASE,
-        DEBOUNCING_RELEASE,
-        BUTTON_HANDLED
+    // Gesture states
+    enum ButtonState : uint8_t {
+        BUTTON_IDLE,            // Released
+        BUTTON_PRESSED,         // Down, timing a long press
+        BUTTON_HELD,            // Down, gesture already reported
+        BUTTON_RELEASED,        // Up after a short press, waiting for a second one
+        BUTTON_SECOND_PRESS     // Down again, a double press on release
     };
 
-    // Button control variables
-    static ButtonState buttonState;
-    static Timer debounceTimer;
-    static bool lastButtonState;
+    // Written by the interrupts
+    static volatile uint8_t buttonState;
+    static volatile uint8_t events;         // Pending ButtonEvent bits
+    static volatile bool buttonLevel;       // Last debounced level
+    static volatile uint8_t debounceTicks;  // Ticks until the level is read, 0 when idle
+    static volatile uint16_t gestureTicks;  // Ticks in the current state
+
+    static void pressed();
+    static void released();
+    static void report(uint8_t event);
+    static void setTickEnabled(bool enabled);
 
 public:
-    // Initialize peripherals
+    // Button pin, pin change interrupt and gesture timer
     static void initialize();
 
-    // Wait for button press with debounce
-    static void waitForButtonPress();
+    // Pending ButtonEvent bits, cleared by the call
+    static uint8_t takeEvents();
+
+    // Interrupt handlers: button pin change and Timer0 compare B (one tick
+    // per millis() overflow period, enabled only while a gesture is timed)
+    static void pinChanged();
+    static void tick();
 };
 
-#endif // PERIPHERALS_H
\ No newline at end of file
+#endif // PERIPHERALS_H
@@ -0,0 +1,93 @@
+#include "PidController.h"
+#include "config.h"
+#include "TimeBase.h"
+
+// Gains for DEBUG_LEVEL 0 builds and until initialize() is called
+static const GainSchedule DEFAULT_GAINS PROGMEM =
+    makeGainSchedule(K_PROPORTIONAL_DEFAULT, K_DERIVATIVE_DEFAULT, FILTER_COEFFICIENT_DEFAULT);
+
+// Static member initialization
+const GainSchedule* PidController::schedule = &DEFAULT_GAINS;
+int PidController::filteredErrorRate = 0;
+int PidController::previousError = 0;
+uint32_t PidController::lastUpdateTicks = 0;
+bool PidController::hasLastUpdate = false;
+#if DEBUG_LEVEL > 0
+GainSchedule PidController::tunedSchedule;
+bool PidController::isTuned = false;
+#endif
+
+void PidController::initialize(const GainSchedule* gains) {
+    schedule = gains ? gains : &DEFAULT_GAINS;
+#if DEBUG_LEVEL > 0
+    isTuned = false;
+#endif
+    reset();
+}
+
+void PidController::reset() {
+    filteredErrorRate = 0;
+    previousError = 0;
+    hasLastUpdate = false;
+}
+
+#if DEBUG_LEVEL > 0
+void PidController::tune(const GainSchedule& gains) {
+    // Runs between control updates, no state to protect
+    tunedSchedule = gains;
+    isTuned = true;
+}
+#endif
+
+void PidController::interpolateGains(int speed, GainPoint& gains) {
+    uint8_t clamped = constrain(speed, 0, 255);
+    uint8_t bucket = clamped >> GAIN_SCHEDULE_SHIFT;
+    int16_t weight = clamped & ((1 << GAIN_SCHEDULE_SHIFT) - 1);
+
+    GainPoint low, high;
+#if DEBUG_LEVEL > 0
+    if (isTuned) {
+        low = tunedSchedule.point[bucket];
+        high = tunedSchedule.point[bucket + 1];
+    }
+    else
+#endif
+    {
+        memcpy_P(&low, &schedule->point[bucket], sizeof(GainPoint));
+        memcpy_P(&high, &schedule->point[bucket + 1], sizeof(GainPoint));
+    }
+
+    gains.kp = low.kp + (((int32_t)high.kp - low.kp) * weight >> GAIN_SCHEDULE_SHIFT);
+    gains.kd = low.kd + (((int32_t)high.kd - low.kd) * weight >> GAIN_SCHEDULE_SHIFT);
+    gains.filter = low.filter + (((int32_t)high.filter - low.filter) * weight >> GAIN_SCHEDULE_SHIFT);
+}
+
+int PidController::update(int error, int speed) {
+    // Measure dt, the first update after reset assumes the nominal period
+    uint32_t now = TimeBase::ticks();
+    uint32_t dt = hasLastUpdate ? now - lastUpdateTicks : PID_DT_NOMINAL_TICKS;
+    dt = constrain(dt, (uint32_t)PID_DT_MIN_TICKS, (uint32_t)PID_DT_MAX_TICKS);
+    lastUpdateTicks = now;
+    hasLastUpdate = true;
+
+    // Error change per nominal period, dtScale is Q8 fixed point
+    uint16_t dtScale = ((uint32_t)PID_DT_NOMINAL_TICKS << 8) / dt;
+    int d_error = ((int32_t)(error - previousError) * dtScale) >> 8;
+
+    GainPoint gains;
+    interpolateGains(speed, gains);
+
+    // Filter the derivative
+    const int32_t filterOne = 1 << GAIN_FILTER_FRACTION_BITS;
+    filteredErrorRate = ((int32_t)gains.filter * d_error +
+        (filterOne - gains.filter) * filteredErrorRate) / filterOne;
+
+    // Calculate PID correction, both terms in Kp's Q format
+    int32_t proportional_term = (int32_t)gains.kp * error;
+    int32_t derivative_term = (int32_t)gains.kd * filteredErrorRate *
+        (1 << (GAIN_KP_FRACTION_BITS - GAIN_KD_FRACTION_BITS));
+    int32_t total_correction = (proportional_term + derivative_term) / (1 << GAIN_KP_FRACTION_BITS);
+    previousError = error;
+
+    return constrain(total_correction, -255, 255);
+}
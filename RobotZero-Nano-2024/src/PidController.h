@@ -0,0 +1,44 @@
+#ifndef PIDCONTROLLER_H
+#define PIDCONTROLLER_H
+
+#include <Arduino.h>
+#include "GainSchedule.h"
+
+class PidController {
+private:
+    // Gains by base speed, in PROGMEM
+    static const GainSchedule* schedule;
+
+#if DEBUG_LEVEL > 0
+    // Gains set at run time (serial console), used instead of the schedule
+    static GainSchedule tunedSchedule;
+    static bool isTuned;
+#endif
+
+    // Controller state
+    static int filteredErrorRate;
+    static int previousError;
+    static uint32_t lastUpdateTicks;
+    static bool hasLastUpdate;
+
+    // Gains for the speed, interpolated between the two nearest buckets
+    static void interpolateGains(int speed, GainPoint& gains);
+
+public:
+    // Set the gain schedule (PROGMEM) and clear state
+    static void initialize(const GainSchedule* gains);
+
+    // Clear derivative history
+    static void reset();
+
+#if DEBUG_LEVEL > 0
+    // Replace the gains with a schedule in RAM until the next initialize()
+    static void tune(const GainSchedule& gains);
+#endif
+
+    // Compute motor correction for the current error and base speed,
+    // the derivative uses the measured time since the previous update
+    static int update(int error, int speed);
+};
+
+#endif // PIDCONTROLLER_H
@@ -1,11 +1,52 @@
 #include "ProfileManager.h"
 #include "config.h"
+#include <stddef.h>
 
 #if DEBUG_LEVEL > 0
 
 // Static member initialization
 DebugMode ProfileManager::currentMode = DebugMode::NORMAL;
 const SpeedProfile* ProfileManager::activeProfile = nullptr;
+const GainSchedule* ProfileManager::activeGains = nullptr;
+SpeedProfile ProfileManager::tunedProfile;
+
+// Named profile fields, in SpeedProfile order
+struct ProfileField {
+    char name[ProfileManager::FIELD_NAME_SIZE];
+    uint8_t offset;
+    ProfileFieldType type;
+    uint16_t maximum;   // Largest accepted value (fixed point range for gains)
+};
+
+#define BYTE_FIELD(field) { #field, offsetof(SpeedProfile, field), ProfileFieldType::BYTE, 255 }
+#define GAIN_FIELD(field, maximum) { #field, offsetof(SpeedProfile, field), ProfileFieldType::GAIN, maximum }
+
+static const ProfileField PROFILE_FIELDS[] PROGMEM = {
+    BYTE_FIELD(speedStop),
+    BYTE_FIELD(speedStartup),
+    BYTE_FIELD(speedTurn),
+    BYTE_FIELD(speedBrake),
+    BYTE_FIELD(speedCruise),
+    BYTE_FIELD(speedSlow),
+    BYTE_FIELD(speedFast),
+    BYTE_FIELD(speedBoost),
+    BYTE_FIELD(speedMax),
+    BYTE_FIELD(accelerationStep),
+    BYTE_FIELD(brakeStep),
+    BYTE_FIELD(turnSpeed),
+    BYTE_FIELD(turnThreshold),
+    BYTE_FIELD(straightThreshold),
+    BYTE_FIELD(boostDuration),
+    BYTE_FIELD(boostIncrement),
+    GAIN_FIELD(kProportional, 255),   // Q8 in the schedule
+    GAIN_FIELD(kDerivative, 4095),    // Q4 in the schedule
+    GAIN_FIELD(filterCoefficient, 1)
+};
+
+#undef BYTE_FIELD
+#undef GAIN_FIELD
+
+static const uint8_t PROFILE_FIELD_COUNT = sizeof(PROFILE_FIELDS) / sizeof(PROFILE_FIELDS[0]);
 
 // Analysis mode profile
 const SpeedProfile ProfileManager::ANALYSIS_PROFILE = {
@@ -63,6 +104,10 @@ const SpeedProfile ProfileManager::SPEED_PROFILE = {
     .filterCoefficient = 0.7f
 };
 
+// Gain schedules from the profiles' base gains (tools: host/gainfit)
+const GainSchedule ProfileManager::ANALYSIS_GAINS PROGMEM = makeGainSchedule(4.0f, 500.0f, 0.5f);
+const GainSchedule ProfileManager::SPEED_GAINS PROGMEM = makeGainSchedule(6.0f, 700.0f, 0.7f);
+
 void ProfileManager::initialize(DebugMode mode) {
     currentMode = mode;
     setActiveProfile(mode);
@@ -131,20 +176,74 @@ uint8_t ProfileManager::getBoostIncrement() {
     return activeProfile ? activeProfile->boostIncrement : BOOST_INCREMENT;
 }
 
+const GainSchedule* ProfileManager::getGainSchedule() {
+    return activeGains;
+}
+
 const SpeedProfile* ProfileManager::getActiveProfile() {
     return activeProfile;
 }
 
+uint8_t ProfileManager::getFieldCount() {
+    return activeProfile ? PROFILE_FIELD_COUNT : 0;
+}
+
+void ProfileManager::getFieldName(uint8_t index, char* name) {
+    memcpy_P(name, PROFILE_FIELDS[index].name, FIELD_NAME_SIZE);
+}
+
+int8_t ProfileManager::findField(const char* name) {
+    for (uint8_t i = 0; i < getFieldCount(); i++) {
+        if (strcmp_P(name, PROFILE_FIELDS[i].name) == 0) return i;
+    }
+    return -1;
+}
+
+ProfileFieldType ProfileManager::getFieldType(uint8_t index) {
+    return (ProfileFieldType)pgm_read_byte(&PROFILE_FIELDS[index].type);
+}
+
+float ProfileManager::getField(uint8_t index) {
+    const uint8_t* field = (const uint8_t*)&tunedProfile + pgm_read_byte(&PROFILE_FIELDS[index].offset);
+    if (getFieldType(index) == ProfileFieldType::BYTE) return *field;
+
+    float value;
+    memcpy(&value, field, sizeof(value));
+    return value;
+}
+
+bool ProfileManager::setField(uint8_t index, float value) {
+    uint16_t maximum = pgm_read_word(&PROFILE_FIELDS[index].maximum);
+    if (!(value >= 0.0f && value <= maximum)) return false;
+
+    uint8_t* field = (uint8_t*)&tunedProfile + pgm_read_byte(&PROFILE_FIELDS[index].offset);
+    if (getFieldType(index) == ProfileFieldType::BYTE) {
+        // Speeds and steps are whole numbers
+        if (value != (uint8_t)value) return false;
+        *field = (uint8_t)value;
+    }
+    else {
+        memcpy(field, &value, sizeof(value));
+    }
+    return true;
+}
+
 void ProfileManager::setActiveProfile(DebugMode mode) {
+    // Profiles are copied to RAM so the console can tune them
     switch (mode) {
     case DebugMode::ANALYSIS:
-        activeProfile = &ANALYSIS_PROFILE;
+        tunedProfile = ANALYSIS_PROFILE;
+        activeProfile = &tunedProfile;
+        activeGains = &ANALYSIS_GAINS;
         break;
     case DebugMode::SPEED:
-        activeProfile = &SPEED_PROFILE;
+        tunedProfile = SPEED_PROFILE;
+        activeProfile = &tunedProfile;
+        activeGains = &SPEED_GAINS;
         break;
     default:
         activeProfile = nullptr;
+        activeGains = nullptr;
         break;
     }
 }
@@ -3,9 +3,16 @@
 
 #include <Arduino.h>
 #include "DataStructures.h"
+#include "GainSchedule.h"
 
 #if DEBUG_LEVEL > 0
 
+// Profile field kinds for live tuning
+enum class ProfileFieldType : uint8_t {
+    BYTE,   // uint8_t speed or control parameter
+    GAIN    // float PID parameter, feeds the gain schedule
+};
+
 class ProfileManager {
 public:
     // Initialize profile manager
@@ -22,6 +29,9 @@ public:
     static float getKD(float defaultValue);
     static float getFilterCoefficient(float defaultValue);
 
+    // Gain schedule of the active profile (PROGMEM), nullptr without one
+    static const GainSchedule* getGainSchedule();
+
     // Get acceleration parameters
     static uint8_t getAccelerationStep();
     static uint8_t getBrakeStep();
@@ -34,14 +44,30 @@ public:
     // Get active profile
     static const SpeedProfile* getActiveProfile();
 
+    // Profile fields by name (serial console). Changes go to the RAM copy
+    // of the active profile and last until the next initialize()
+    static const uint8_t FIELD_NAME_SIZE = 18;
+    static uint8_t getFieldCount();                      // 0 without a profile
+    static void getFieldName(uint8_t index, char* name); // FIELD_NAME_SIZE bytes
+    static int8_t findField(const char* name);           // -1 if unknown
+    static ProfileFieldType getFieldType(uint8_t index);
+    static float getField(uint8_t index);
+    static bool setField(uint8_t index, float value);    // false if out of range
+
 private:
     static DebugMode currentMode;
     static const SpeedProfile* activeProfile;
+    static const GainSchedule* activeGains;
+    static SpeedProfile tunedProfile;   // Active profile, writable copy
 
     // Predefined profiles
     static const SpeedProfile ANALYSIS_PROFILE;
     static const SpeedProfile SPEED_PROFILE;
 
+    // Gain schedules for the predefined profiles
+    static const GainSchedule ANALYSIS_GAINS;
+    static const GainSchedule SPEED_GAINS;
+
     // Private methods
     static void setActiveProfile(DebugMode mode);
     static uint8_t validateSpeed(uint8_t speed);
@@ -0,0 +1,117 @@
+#include "Scheduler.h"
+#include "config.h"
+
+// Static member initialization
+Task* Scheduler::tasks = nullptr;
+uint8_t Scheduler::taskCount = 0;
+Task* Scheduler::currentTask = nullptr;
+uint32_t Scheduler::loopCount = 0;
+uint32_t Scheduler::loopWindowStart = 0;
+uint32_t Scheduler::loopRate = 0;
+
+void Scheduler::initialize(Task* table, uint8_t count) {
+    tasks = table;
+    taskCount = count;
+
+    uint32_t now = micros();
+    loopCount = 0;
+    loopWindowStart = now;
+    loopRate = 0;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].nextRun = now;
+        tasks[i].lastTimeUs = 0;
+        tasks[i].maxTimeUs = 0;
+        tasks[i].overruns = 0;
+        tasks[i].lateReleases = 0;
+        tasks[i].retry = false;
+        tasks[i].posted = false;
+    }
+}
+
+void Scheduler::dispatch() {
+    uint32_t now = micros();
+
+    // Loop rate, shows the time left over by the periodic tasks
+    loopCount++;
+    if (now - loopWindowStart >= LOOP_RATE_WINDOW_US) {
+        loopRate = loopCount;
+        loopCount = 0;
+        loopWindowStart = now;
+    }
+
+    // Periodic tasks: highest priority due task first, until none is due
+    while (true) {
+        Task* next = nullptr;
+
+        for (uint8_t i = 0; i < taskCount; i++) {
+            Task& task = tasks[i];
+            if (task.periodUs == 0 || task.retry) continue;
+            if (task.periodUs == TASK_PERIOD_EVENT) {
+                if (!task.posted) continue;
+            }
+            else if ((int32_t)(now - task.nextRun) < 0) continue;
+            if (next == nullptr || task.priority < next->priority) next = &task;
+        }
+
+        if (next == nullptr) break;
+
+        if (next->periodUs == TASK_PERIOD_EVENT) {
+            // Posts made while it runs release it again
+            next->posted = false;
+        }
+        else {
+            // Advance the release, resynchronize if more than a period behind
+            next->nextRun += next->periodUs;
+            if ((int32_t)(now - next->nextRun) >= 0) {
+                next->lateReleases++;
+                next->nextRun = now + next->periodUs;
+            }
+        }
+
+        runTask(*next);
+        now = micros();
+    }
+
+    // Background tasks and retries use the remaining time
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (tasks[i].periodUs == 0 || tasks[i].retry) runTask(tasks[i]);
+    }
+}
+
+void Scheduler::post(bool (*run)()) {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (tasks[i].run == run) {
+            tasks[i].posted = true;
+            return;
+        }
+    }
+}
+
+uint8_t Scheduler::getTaskCount() {
+    return taskCount;
+}
+
+const Task* Scheduler::getTask(uint8_t index) {
+    return (index < taskCount) ? &tasks[index] : nullptr;
+}
+
+uint32_t Scheduler::getLoopRate() {
+    return loopRate;
+}
+
+const Task* Scheduler::getCurrentTask() {
+    return currentTask;
+}
+
+void Scheduler::runTask(Task& task) {
+    uint32_t start = micros();
+    currentTask = &task;
+    bool done = task.run();
+    currentTask = nullptr;
+    uint32_t elapsed = micros() - start;
+
+    task.retry = !done;
+    task.lastTimeUs = min(elapsed, (uint32_t)UINT16_MAX);
+    if (task.lastTimeUs > task.maxTimeUs) task.maxTimeUs = task.lastTimeUs;
+    if (elapsed > task.budgetUs && task.overruns < UINT16_MAX) task.overruns++;
+}
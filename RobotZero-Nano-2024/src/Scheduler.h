@@ -0,0 +1,59 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Task period of event tasks, run once per Scheduler::post()
+static constexpr uint32_t TASK_PERIOD_EVENT = UINT32_MAX;
+
+// Entry of the static task table
+struct Task {
+    bool (*run)();          // Returns false to be retried in the background
+    uint32_t periodUs;      // Run period, 0 = background (every dispatch), TASK_PERIOD_EVENT = posted
+    uint8_t priority;       // 0 runs first
+    uint16_t budgetUs;      // Expected worst-case run time
+
+    // Runtime state, filled by the scheduler (the task table leaves it out)
+    uint32_t nextRun = 0;       // micros() of the next release
+    uint16_t lastTimeUs = 0;    // Measured time of the last run
+    uint16_t maxTimeUs = 0;     // Longest measured run
+    uint16_t overruns = 0;      // Runs that exceeded budgetUs
+    uint16_t lateReleases = 0;  // Releases that started more than a period late
+    bool retry = false;         // Last run asked to be retried
+    volatile bool posted = false;   // Event task waiting to run
+};
+
+class Scheduler {
+public:
+    // Register the task table and release every task now
+    static void initialize(Task* table, uint8_t count);
+
+    // Run due tasks in priority order, then background tasks (call in loop)
+    static void dispatch();
+
+    // Release the event task of this run function on the next dispatch,
+    // safe from interrupts. No effect before initialize()
+    static void post(bool (*run)());
+
+    // Task statistics
+    static uint8_t getTaskCount();
+    static const Task* getTask(uint8_t index);
+
+    // dispatch() calls per second over the last full second
+    static uint32_t getLoopRate();
+
+    // Task being run, nullptr outside of a task
+    static const Task* getCurrentTask();
+
+private:
+    static Task* tasks;
+    static uint8_t taskCount;
+    static Task* currentTask;
+    static uint32_t loopCount;          // dispatch() calls in the current window
+    static uint32_t loopWindowStart;
+    static uint32_t loopRate;
+
+    static void runTask(Task& task);
+};
+
+#endif // SCHEDULER_H
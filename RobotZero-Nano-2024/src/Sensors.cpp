@@ -1,82 +1,183 @@
 #include <Arduino.h>
 #include "Sensors.h"
+#include "Adc.h"
+#include "CalibrationStore.h"
 #include "config.h"
 #include "debug.h"
+#include "globals.h"
+#include "TimerService.h"
 
 // Static member initialization
 int16_t Sensors::sensorMin[NUM_SENSORES] = { SENSOR_MAX_VALUE, SENSOR_MAX_VALUE, SENSOR_MAX_VALUE, SENSOR_MAX_VALUE, SENSOR_MAX_VALUE, SENSOR_MAX_VALUE };
 int16_t Sensors::sensorMax[NUM_SENSORES] = { SENSOR_MIN_VALUE, SENSOR_MIN_VALUE, SENSOR_MIN_VALUE, SENSOR_MIN_VALUE, SENSOR_MIN_VALUE, SENSOR_MIN_VALUE };
 volatile int16_t Sensors::processedSensorValues[NUM_SENSORES];
+int16_t Sensors::rawSensorValues[NUM_SENSORES];
 boolean Sensors::isLineDetected;
 int16_t Sensors::lastValidLinePosition;
 int16_t Sensors::lastValidPosition;
+uint8_t Sensors::oversampleShift = 0;
+uint32_t Sensors::cyclesPerShift[OVERSAMPLE_MAX_SHIFT + 1];
+uint32_t Sensors::noiseSquares[NUM_SENSORES];
+uint32_t Sensors::noisePairs = 0;
+uint16_t Sensors::calibrationCount = 0;
 
 void Sensors::calibration() {
-  static Timer calibrationTimer;
-  static uint16_t calibrationCount = 0;
-
   calibrationCount = 0;
-  calibrationTimer.Start(CALIBRATION_DELAY);
+  TimerService::start(TIMER_CALIBRATION, CALIBRATION_DELAY, calibrationSample);
 
   while (calibrationCount < CALIBRATION_SAMPLES) {
-    if (calibrationTimer.Expired()) {
-      int16_t v_s[NUM_SENSORES];
-
-      // Read all sensors
-      v_s[0] = analogRead(PIN_LINE_LEFT_EDGE);
-      v_s[1] = analogRead(PIN_LINE_LEFT_MID);
-      v_s[2] = analogRead(PIN_LINE_CENTER_LEFT);
-      v_s[3] = analogRead(PIN_LINE_CENTER_RIGHT);
-      v_s[4] = analogRead(PIN_LINE_RIGHT_MID);
-      v_s[5] = analogRead(PIN_LINE_RIGHT_EDGE);
-
-      // Update min and max values
-      for (uint8_t i = 0; i < NUM_SENSORES; i++) {
-        DEBUG_PRINT_VAL(v_s[i]);
-        DEBUG_PRINT("\t");
-
-        if (v_s[i] < sensorMin[i]) sensorMin[i] = v_s[i];
-        if (v_s[i] > sensorMax[i]) sensorMax[i] = v_s[i];
-      }
-      DEBUG_PRINTLN("");
+    TimerService::process();
+  }
+}
 
-      // Debug minimum values
-      DEBUG_PRINT("Minimums\t");
-      for (uint8_t i = 0; i < NUM_SENSORES; i++) {
-        DEBUG_PRINT_VAL(sensorMin[i]);
-        DEBUG_PRINT("\t");
-      }
-      DEBUG_PRINTLN("");
+void Sensors::calibrationSample() {
+  int16_t v_s[NUM_SENSORES];
 
-      // Debug maximum values
-      DEBUG_PRINT("Maximums\t");
-      for (uint8_t i = 0; i < NUM_SENSORES; i++) {
-        DEBUG_PRINT_VAL(sensorMax[i]);
-        DEBUG_PRINT("\t");
-      }
-      DEBUG_PRINTLN("");
+  // Read all sensors
+  v_s[0] = Adc::readLine(PIN_LINE_LEFT_EDGE);
+  v_s[1] = Adc::readLine(PIN_LINE_LEFT_MID);
+  v_s[2] = Adc::readLine(PIN_LINE_CENTER_LEFT);
+  v_s[3] = Adc::readLine(PIN_LINE_CENTER_RIGHT);
+  v_s[4] = Adc::readLine(PIN_LINE_RIGHT_MID);
+  v_s[5] = Adc::readLine(PIN_LINE_RIGHT_EDGE);
 
-      calibrationCount++;
-      calibrationTimer.Start(CALIBRATION_DELAY);
-    }
+  // Update min and max values
+  for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    DEBUG_PRINT_VAL(v_s[i]);
+    DEBUG_PRINT("\t");
+
+    if (v_s[i] < sensorMin[i]) sensorMin[i] = v_s[i];
+    if (v_s[i] > sensorMax[i]) sensorMax[i] = v_s[i];
+  }
+  DEBUG_PRINTLN("");
+
+  // Debug minimum values
+  DEBUG_PRINT("Minimums\t");
+  for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    DEBUG_PRINT_VAL(sensorMin[i]);
+    DEBUG_PRINT("\t");
+  }
+  DEBUG_PRINTLN("");
+
+  // Debug maximum values
+  DEBUG_PRINT("Maximums\t");
+  for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    DEBUG_PRINT_VAL(sensorMax[i]);
+    DEBUG_PRINT("\t");
+  }
+  DEBUG_PRINTLN("");
+
+  calibrationCount++;
+  if (calibrationCount < CALIBRATION_SAMPLES) {
+    TimerService::start(TIMER_CALIBRATION, CALIBRATION_DELAY, calibrationSample);
+  }
+}
+
+bool Sensors::loadCalibration() {
+  return CalibrationStore::load(sensorMin, sensorMax);
+}
+
+void Sensors::saveCalibration() {
+  CalibrationStore::save(sensorMin, sensorMax);
+}
+
+int16_t Sensors::getSensorMin(uint8_t index) {
+  return sensorMin[index] << SENSOR_ADC_SHIFT;
+}
+
+int16_t Sensors::getSensorMax(uint8_t index) {
+  return sensorMax[index] << SENSOR_ADC_SHIFT;
+}
+
+int16_t Sensors::getRawValue(uint8_t index) {
+  return rawSensorValues[index] << SENSOR_ADC_SHIFT;
+}
+
+void Sensors::planAcquisition(uint16_t budgetUs, uint16_t lastCycleUs) {
+  // Top speed outside precision mode: fresh single samples
+  if (!isPrecisionMode && currentSpeed > OVERSAMPLE_MAX_SPEED) {
+    oversampleShift = 0;
+    return;
   }
+
+  // Rest of the control path, the last acquisition taken out
+  const uint16_t sweepUs = NUM_SENSORES * ADC_CONVERSION_US;
+  uint16_t acquisitionUs = sweepUs << oversampleShift;
+  uint16_t otherUs = (lastCycleUs > acquisitionUs) ? lastCycleUs - acquisitionUs : 0;
+
+  uint8_t shift = 0;
+  while (shift < OVERSAMPLE_MAX_SHIFT &&
+    otherUs + (sweepUs << (shift + 1)) + OVERSAMPLE_MARGIN_US <= budgetUs) {
+    shift++;
+  }
+  oversampleShift = shift;
+}
+
+float Sensors::getNoiseFloor(uint8_t index) {
+  if (noisePairs == 0) return 0.0f;
+
+  // E[(a - b)^2] = 2 sigma^2 for two independent samples
+  float variance = noiseSquares[index] / (2.0f * noisePairs);
+
+  // Averaging 2^shift sweeps divides the variance by 2^shift
+  uint32_t cycles = 0;
+  float reduction = 0.0f;
+  for (uint8_t shift = 0; shift <= OVERSAMPLE_MAX_SHIFT; shift++) {
+    cycles += cyclesPerShift[shift];
+    reduction += (float)cyclesPerShift[shift] / (1 << shift);
+  }
+
+  return sqrtf(variance * reduction / cycles) * (1 << SENSOR_ADC_SHIFT);
+}
+
+void Sensors::resetStatistics() {
+  for (uint8_t shift = 0; shift <= OVERSAMPLE_MAX_SHIFT; shift++) {
+    cyclesPerShift[shift] = 0;
+  }
+  for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    noiseSquares[i] = 0;
+  }
+  noisePairs = 0;
 }
 
 void Sensors::readSensors() {
   int16_t s[NUM_SENSORES];
+  int16_t sum[NUM_SENSORES] = { 0, 0, 0, 0, 0, 0 };
   bool isOnline;
   int localSum = 0;
 
-  // Read sensors
-  s[0] = analogRead(PIN_LINE_LEFT_EDGE);
-  s[1] = analogRead(PIN_LINE_LEFT_MID);
-  s[2] = analogRead(PIN_LINE_CENTER_LEFT);
-  s[3] = analogRead(PIN_LINE_CENTER_RIGHT);
-  s[4] = analogRead(PIN_LINE_RIGHT_MID);
-  s[5] = analogRead(PIN_LINE_RIGHT_EDGE);
+  // Read sensors, 2^oversampleShift sweeps
+  uint8_t sweeps = 1 << oversampleShift;
+  for (uint8_t n = 0; n < sweeps; n++) {
+    int16_t v[NUM_SENSORES];
+    v[0] = Adc::readLine(PIN_LINE_LEFT_EDGE);
+    v[1] = Adc::readLine(PIN_LINE_LEFT_MID);
+    v[2] = Adc::readLine(PIN_LINE_CENTER_LEFT);
+    v[3] = Adc::readLine(PIN_LINE_CENTER_RIGHT);
+    v[4] = Adc::readLine(PIN_LINE_RIGHT_MID);
+    v[5] = Adc::readLine(PIN_LINE_RIGHT_EDGE);
+
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+      // Successive samples of a channel differ by noise only
+      if (n > 0) {
+        int16_t difference = v[i] - s[i];
+        noiseSquares[i] += (uint32_t)((int32_t)difference * difference);
+      }
+      s[i] = v[i];
+      sum[i] += v[i];
+    }
+  }
+
+  // Decimate: rounded mean in sensor counts
+  for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    s[i] = (sum[i] + (sweeps >> 1)) >> oversampleShift;
+  }
+  noisePairs += sweeps - 1;
+  cyclesPerShift[oversampleShift]++;
 
   // Process values
   for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+    rawSensorValues[i] = s[i];
     if (s[i] < sensorMin[i]) s[i] = sensorMin[i];
     if (s[i] > sensorMax[i]) s[i] = sensorMax[i];
     s[i] = map(s[i], sensorMin[i], sensorMax[i], 100, 0);
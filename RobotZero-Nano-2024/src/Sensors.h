@@ -2,24 +2,56 @@
 #define SENSORS_H
 
 #include "config.h"
-#include "Timer.h"
 
 class Sensors {
 private:
     static int16_t sensorMin[NUM_SENSORES];
     static int16_t sensorMax[NUM_SENSORES];
     static volatile int16_t processedSensorValues[NUM_SENSORES];
+    static int16_t rawSensorValues[NUM_SENSORES];
     static boolean isLineDetected;
     static int16_t lastValidLinePosition;
     static int16_t lastValidPosition;
 
+    // Oversampling state and noise statistics
+    static uint8_t oversampleShift;                 // 2^shift sweeps per reading
+    static uint32_t cyclesPerShift[OVERSAMPLE_MAX_SHIFT + 1];
+    static uint32_t noiseSquares[NUM_SENSORES];     // Squared differences of successive samples
+    static uint32_t noisePairs;                     // Successive sample pairs per channel
+
     // Helper method
     static void readSensors();
 
+    // Calibration progress, one sample per TIMER_CALIBRATION expiry
+    static uint16_t calibrationCount;
+    static void calibrationSample();
+
 public:
     // Calibration method
     static void calibration();
 
+    // Persisted calibration
+    static bool loadCalibration();
+    static void saveCalibration();
+
+    // Calibration accessors, in 10-bit ADC counts in both acquisition modes
+    static int16_t getSensorMin(uint8_t index);
+    static int16_t getSensorMax(uint8_t index);
+
+    // Last raw ADC reading in 10-bit counts (record and replay)
+    static int16_t getRawValue(uint8_t index);
+
+    // Choose the sweeps per reading from the time the last control cycle
+    // left in its budget (call before calculateLinePosition)
+    static void planAcquisition(uint16_t budgetUs, uint16_t lastCycleUs);
+
+    // Effective noise of a reading in 10-bit ADC counts (standard deviation
+    // after averaging), 0 until an oversampled reading gave an estimate
+    static float getNoiseFloor(uint8_t index);
+
+    // Clear the oversampling and noise statistics (run start)
+    static void resetStatistics();
+
     // Line position calculation
     static int16_t calculateLinePosition();
 };
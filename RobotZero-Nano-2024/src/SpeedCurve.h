@@ -0,0 +1,45 @@
+#ifndef SPEEDCURVE_H
+#define SPEEDCURVE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Target speed indexed by |error|, generated at compile time.
+// Replaces the per-cycle map() in CourseMarkers::speedControl.
+struct SpeedCurve {
+    uint8_t speed[SPEED_CURVE_MAX_ERROR + 1];
+};
+
+static_assert(TURN_THRESHOLD < SPEED_CURVE_MAX_ERROR, "Speed curve must cover the turn threshold");
+static_assert(STRAIGHT_THRESHOLD < TURN_THRESHOLD, "Straight threshold must be below turn threshold");
+
+// Speed between the straight and turn thresholds, fastSpeed at the
+// straight end and TURN_SPEED at the turn end
+constexpr uint8_t speedCurvePoint(uint8_t absError, uint8_t fastSpeed) {
+    long range = TURN_THRESHOLD - STRAIGHT_THRESHOLD;
+    long x = absError - STRAIGHT_THRESHOLD;
+    long delta = (long)TURN_SPEED - fastSpeed;
+
+    // SPEED_CURVE_QUADRATIC keeps the speed up and brakes close to the turn
+    return (SPEED_CURVE_SHAPE == SPEED_CURVE_QUADRATIC) ?
+        fastSpeed + x * x * delta / (range * range) :
+        fastSpeed + x * delta / range;  // Same result as map()
+}
+
+constexpr SpeedCurve makeSpeedCurve(uint8_t fastSpeed) {
+    SpeedCurve curve{};
+    for (uint8_t e = 0; e <= SPEED_CURVE_MAX_ERROR; e++) {
+        if (e < STRAIGHT_THRESHOLD) {
+            curve.speed[e] = fastSpeed;
+        }
+        else if (e > TURN_THRESHOLD) {
+            curve.speed[e] = TURN_SPEED;
+        }
+        else {
+            curve.speed[e] = speedCurvePoint(e, fastSpeed);
+        }
+    }
+    return curve;
+}
+
+#endif // SPEEDCURVE_H
@@ -0,0 +1,82 @@
+#include "StopController.h"
+#include "globals.h"
+#include "MotorsDrivers.h"
+#include "TimerService.h"
+
+#if DEBUG_LEVEL > 0
+#include "Logger.h"
+#endif
+
+static const BrakeProfile BRAKE_PROFILE PROGMEM = makeBrakeProfile();
+
+// Static member initialization
+StopController::Phase StopController::phase = PHASE_IDLE;
+uint8_t StopController::holdSpeed = 0;
+BrakeStep StopController::brakeStep = {};
+
+void StopController::reset() {
+    phase = PHASE_IDLE;
+    TimerService::stop(TIMER_STOP);
+}
+
+void StopController::start(uint32_t elapsedUs) {
+    uint8_t speed = constrain(MotorDriver::getSpeedEstimate(), 0, 255);
+
+    // Bin at or above the speed, the stop errs on the short side
+    uint8_t index = (speed + BRAKE_PROFILE_STEP - 1) / BRAKE_PROFILE_STEP;
+    memcpy_P(&brakeStep, &BRAKE_PROFILE.steps[index], sizeof(BrakeStep));
+    holdSpeed = speed;
+    phase = PHASE_DRIVE;
+
+#if DEBUG_LEVEL > 0
+    Logger::logEvent(EventType::BRAKE_START, ((uint16_t)brakeStep.power << 8) | speed);
+#endif
+
+    uint32_t speedMmS = (uint32_t)speed * MOTOR_MODEL_MAX_SPEED / 255;
+    if (speedMmS == 0) {
+        finish();
+        return;
+    }
+
+    // Drive on for what the braking distance leaves of the stop distance
+    int32_t travelled = speedMmS * (elapsedUs / 1000) / 1000;
+    int32_t remaining = (int32_t)STOP_DISTANCE_MM - travelled - brakeStep.distanceMm;
+    if (remaining > 0) {
+        TimerService::start(TIMER_STOP, remaining * 1000 / speedMmS, startBraking);
+    }
+    else {
+        startBraking();
+    }
+}
+
+bool StopController::isActive() {
+    return phase != PHASE_IDLE;
+}
+
+bool StopController::isBraking() {
+    return phase == PHASE_BRAKE;
+}
+
+int StopController::getHoldSpeed() {
+    return holdSpeed;
+}
+
+uint8_t StopController::getBrakePower() {
+    return brakeStep.power;
+}
+
+void StopController::startBraking() {
+    if (phase != PHASE_DRIVE) return;
+
+    phase = PHASE_BRAKE;
+    TimerService::start(TIMER_STOP, brakeStep.durationMs, finish);
+}
+
+void StopController::finish() {
+    if (phase == PHASE_IDLE) return;
+
+    phase = PHASE_IDLE;
+    currentSpeed = 0;
+    MotorDriver::stopMotors();
+    isRobotStopped = true;
+}
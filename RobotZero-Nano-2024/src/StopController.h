@@ -0,0 +1,44 @@
+#ifndef STOPCONTROLLER_H
+#define STOPCONTROLLER_H
+
+#include <Arduino.h>
+#include "BrakeProfile.h"
+
+// Stop sequence after the last finish line.
+// The speed the motor model gives at the line picks a braking step from
+// the BrakeProfile; the robot follows the line at that speed until only
+// the braking distance is left of STOP_DISTANCE_MM, then reverses the
+// motors for the time the model needs to reach standstill.
+class StopController {
+public:
+    // Cancel the sequence (run start)
+    static void reset();
+
+    // Plan the stop, the finish line was passed elapsedUs ago
+    static void start(uint32_t elapsedUs);
+
+    // Driving on or braking
+    static bool isActive();
+    static bool isBraking();
+
+    // Base speed limit while driving on, reverse power while braking
+    static int getHoldSpeed();
+    static uint8_t getBrakePower();
+
+private:
+    enum Phase : uint8_t {
+        PHASE_IDLE,
+        PHASE_DRIVE,
+        PHASE_BRAKE
+    };
+
+    static Phase phase;
+    static uint8_t holdSpeed;
+    static BrakeStep brakeStep;
+
+    // TIMER_STOP callbacks
+    static void startBraking();
+    static void finish();
+};
+
+#endif // STOPCONTROLLER_H
@@ -0,0 +1,145 @@
+#include "Telemetry.h"
+#include "CircularBuffer.h"
+#include "CourseMarkers.h"
+#include "Sensors.h"
+#include <util/crc16.h>
+
+#if DEBUG_LEVEL > 0
+
+// Encoded frames waiting for room in the serial TX buffer
+static CircularBuffer<uint8_t, TELEMETRY_BUFFER_SIZE> txRing;
+
+// Static member initialization
+uint8_t Telemetry::decimationCounter = 0;
+uint8_t Telemetry::sequence = 0;
+uint16_t Telemetry::droppedFrames = 0;
+
+void Telemetry::sendFrame(uint8_t speed, int16_t error, int16_t correction,
+    int16_t leftPower, int16_t rightPower, uint8_t state) {
+    if (++decimationCounter < TELEMETRY_DECIMATION) return;
+    decimationCounter = 0;
+
+    TelemetryFrame frame;
+    frame.type = TelemetryType::CONTROL;
+    frame.timestamp = (uint16_t)millis();
+    frame.speed = speed;
+    frame.error = error;
+    frame.correction = correction;
+    frame.leftPower = leftPower;
+    frame.rightPower = rightPower;
+    frame.state = state;
+
+    queueFrame((uint8_t*)&frame, sizeof(TelemetryFrame));
+}
+
+void Telemetry::sendRawFrame(uint32_t timestamp, int16_t leftPower, int16_t rightPower) {
+    RawSensorFrame frame;
+    frame.type = TelemetryType::RAW_SENSORS;
+    frame.timestamp = timestamp;
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        frame.line[i] = Sensors::getRawValue(i);
+    }
+    frame.markerLeft = CourseMarkers::getRawLeft();
+    frame.markerRight = CourseMarkers::getRawRight();
+    frame.leftPower = leftPower;
+    frame.rightPower = rightPower;
+
+    queueFrame((uint8_t*)&frame, sizeof(RawSensorFrame));
+}
+
+void Telemetry::sendCalibration() {
+    CalibrationFrame frame;
+    frame.type = TelemetryType::CALIBRATION;
+    for (uint8_t i = 0; i < NUM_SENSORES; i++) {
+        frame.sensorMin[i] = Sensors::getSensorMin(i);
+        frame.sensorMax[i] = Sensors::getSensorMax(i);
+    }
+
+    queueFrame((uint8_t*)&frame, sizeof(CalibrationFrame));
+}
+
+bool Telemetry::sendText(const char* text) {
+    if (txRing.getFreeSpace() < sizeof(ConsoleFrame) + 3) return false;
+
+    ConsoleFrame frame;
+    frame.type = TelemetryType::CONSOLE;
+    memset(frame.text, 0, sizeof(frame.text));
+    memcpy(frame.text, text, min(strlen(text), sizeof(frame.text)));
+
+    queueFrame((uint8_t*)&frame, sizeof(ConsoleFrame));
+    return true;
+}
+
+void Telemetry::process() {
+    // HardwareSerial drains its own buffer from the UDRE interrupt,
+    // so only hand over what fits without blocking
+    int room = Serial.availableForWrite();
+    uint8_t byte;
+
+    while (room-- > 0 && txRing.pop(byte)) {
+        Serial.write(byte);
+    }
+}
+
+uint16_t Telemetry::getDroppedFrames() {
+    return droppedFrames;
+}
+
+void Telemetry::queueFrame(uint8_t* frame, uint8_t size) {
+    // Every frame starts with type and sequence and ends with the CRC
+    frame[1] = sequence++;
+    uint16_t crc = calculateCrc(frame, size - sizeof(uint16_t));
+    frame[size - 2] = crc & 0xFF;
+    frame[size - 1] = crc >> 8;
+
+    // Only whole frames go into the ring
+    if (txRing.getFreeSpace() < size + 3) {
+        droppedFrames++;
+        return;
+    }
+
+    uint8_t encoded[MAX_ENCODED_SIZE];
+    encoded[0] = 0x00;  // Leading delimiter resynchronizes after text output
+    uint8_t encodedSize = encodeCobs(frame, size, &encoded[1]) + 1;
+    encoded[encodedSize++] = 0x00;
+
+    txRing.pushMultiple(encoded, encodedSize);
+}
+
+uint8_t Telemetry::encodeCobs(const uint8_t* data, uint8_t size, uint8_t* output) {
+    uint8_t codeIndex = 0;
+    uint8_t writeIndex = 1;
+    uint8_t code = 1;
+
+    for (uint8_t i = 0; i < size; i++) {
+        if (data[i] == 0) {
+            output[codeIndex] = code;
+            codeIndex = writeIndex++;
+            code = 1;
+        }
+        else {
+            output[writeIndex++] = data[i];
+            if (++code == 0xFF) {
+                output[codeIndex] = code;
+                codeIndex = writeIndex++;
+                code = 1;
+            }
+        }
+    }
+
+    output[codeIndex] = code;
+    return writeIndex;
+}
+
+uint16_t Telemetry::calculateCrc(const void* data, uint8_t size) {
+    uint16_t crc = 0xFFFF;
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (uint8_t i = 0; i < size; i++) {
+        crc = _crc16_update(crc, bytes[i]);
+    }
+
+    return crc;
+}
+
+#endif // DEBUG_LEVEL > 0
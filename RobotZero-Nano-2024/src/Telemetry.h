@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "DataStructures.h"
+
+#if DEBUG_LEVEL > 0
+
+class Telemetry {
+public:
+    // Queue a frame (decimated), never blocks
+    static void sendFrame(uint8_t speed, int16_t error, int16_t correction,
+        int16_t leftPower, int16_t rightPower, uint8_t state);
+
+    // Queue a raw ADC frame (every call, used for record and replay)
+    static void sendRawFrame(uint32_t timestamp, int16_t leftPower, int16_t rightPower);
+
+    // Queue the current sensor calibration
+    static void sendCalibration();
+
+    // Queue one line of console text (truncated to the frame),
+    // false when the ring has no room so the caller can retry later
+    static bool sendText(const char* text);
+
+    // Move staged bytes into the serial TX buffer (call in main loop)
+    static void process();
+
+    // Number of frames dropped because the ring was full
+    static uint16_t getDroppedFrames();
+
+private:
+    // COBS adds one byte per 254, plus the two frame delimiters
+    static const uint8_t MAX_ENCODED_SIZE = sizeof(RawSensorFrame) + 3;
+    static_assert(sizeof(ConsoleFrame) <= sizeof(RawSensorFrame), "Console frames must fit the encoder buffer");
+
+    static uint8_t decimationCounter;
+    static uint8_t sequence;
+    static uint16_t droppedFrames;
+
+    // Internal methods
+    static void queueFrame(uint8_t* frame, uint8_t size);
+    static uint8_t encodeCobs(const uint8_t* data, uint8_t size, uint8_t* output);
+    static uint16_t calculateCrc(const void* data, uint8_t size);
+};
+
+#endif // DEBUG_LEVEL > 0
+#endif // TELEMETRY_H
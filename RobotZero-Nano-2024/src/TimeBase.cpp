@@ -0,0 +1,59 @@
+#include "TimeBase.h"
+#include "config.h"
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+
+// Timer1 overflows since initialize(), the low byte comes from TCNT1
+static volatile uint32_t overflowCount = 0;
+
+ISR(TIMER1_OVF_vect) {
+    overflowCount++;
+}
+
+void TimeBase::initialize() {
+    uint8_t oldSREG = SREG;
+    cli();
+
+    // 8-bit fast PWM keeps analogWrite() working on pins 9 and 10,
+    // clk/8 gives 0.5 us ticks and a 7.8 kHz PWM carrier. The right motor
+    // PWM (pin 10) moves to that carrier, MotorDriver puts Timer2 (left
+    // motor, pin 3) in the same mode. The overflow interrupt runs every
+    // 128 us, about 40 cycles each or 2% of the CPU
+    TCCR1A = (TCCR1A & (_BV(COM1A1) | _BV(COM1A0) | _BV(COM1B1) | _BV(COM1B0))) | _BV(WGM10);
+    TCCR1B = _BV(WGM12) | _BV(CS11);
+    TCNT1 = 0;
+    overflowCount = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 |= _BV(TOIE1);
+
+    SREG = oldSREG;
+}
+
+uint32_t TimeBase::ticks() {
+    uint8_t oldSREG = SREG;
+    cli();
+
+    uint32_t count = overflowCount;
+    uint8_t low = TCNT1L;
+
+    // Overflow pending but not yet serviced
+    if ((TIFR1 & _BV(TOV1)) && low < 255) {
+        count++;
+    }
+
+    SREG = oldSREG;
+    return (count << 8) | low;
+}
+
+#else
+
+// Host builds: derive ticks from the simulated clock
+void TimeBase::initialize() {
+}
+
+uint32_t TimeBase::ticks() {
+    return micros() * TIMEBASE_TICKS_PER_US;
+}
+
+#endif
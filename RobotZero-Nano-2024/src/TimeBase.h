@@ -0,0 +1,28 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <Arduino.h>
+
+// High-resolution time source on Timer1.
+// Ticks are TIMEBASE_TICKS_PER_US per microsecond and wrap after ~35 minutes,
+// so always compare them through unsigned differences (elapsed/reached).
+class TimeBase {
+public:
+    // Take over Timer1 (call once before using ticks)
+    static void initialize();
+
+    // Current tick count
+    static uint32_t ticks();
+
+    // Ticks since a previous ticks() value, wrap-safe
+    static uint32_t elapsed(uint32_t since) {
+        return ticks() - since;
+    }
+
+    // True once the deadline tick has passed, wrap-safe
+    static bool reached(uint32_t deadline) {
+        return (int32_t)(ticks() - deadline) >= 0;
+    }
+};
+
+#endif // TIMEBASE_H
@@ -0,0 +1,117 @@
+#include "TimerService.h"
+
+static constexpr uint32_t SLOT_MASK = (1UL << TIMER_WHEEL_BITS) - 1;
+static constexpr uint32_t LEVEL1_SPAN = 1UL << (2 * TIMER_WHEEL_BITS);   // Ticks covered by levels 0 and 1
+static constexpr uint32_t WHEEL_SPAN = 1UL << (3 * TIMER_WHEEL_BITS);    // Ticks covered by the wheel
+
+// Static member initialization
+TimerService::Entry TimerService::entries[TIMER_COUNT];
+uint8_t TimerService::heads[LIST_COUNT];
+uint32_t TimerService::now = 0;
+
+void TimerService::initialize() {
+    for (uint8_t i = 0; i < LIST_COUNT; i++) {
+        heads[i] = NONE;
+    }
+    for (uint8_t id = 0; id < TIMER_COUNT; id++) {
+        entries[id].callback = nullptr;
+        entries[id].list = NONE;
+    }
+    now = millis();
+}
+
+void TimerService::start(TimerId id, uint32_t ms, TimerCallback callback) {
+    unlink(id);
+
+    // Never on a tick the wheel already passed
+    uint32_t expiry = millis() + ms;
+    if ((int32_t)(expiry - now) <= 0) {
+        expiry = now + 1;
+    }
+
+    entries[id].expiry = expiry;
+    entries[id].callback = callback;
+    insert(id);
+}
+
+void TimerService::stop(TimerId id) {
+    unlink(id);
+}
+
+bool TimerService::isRunning(TimerId id) {
+    return entries[id].list != NONE;
+}
+
+void TimerService::process() {
+    uint32_t target = millis();
+    while (now != target) {
+        tick();
+    }
+}
+
+void TimerService::insert(uint8_t id) {
+    Entry& entry = entries[id];
+    uint32_t delta = entry.expiry - now;
+
+    uint8_t list;
+    if (delta <= SLOT_MASK) {
+        list = entry.expiry & SLOT_MASK;
+    }
+    else if (delta < LEVEL1_SPAN) {
+        list = SLOTS + ((entry.expiry >> TIMER_WHEEL_BITS) & SLOT_MASK);
+    }
+    else {
+        // Past the wheel: park in the last level 2 slot to come, the
+        // cascade places it again
+        uint32_t target = (delta < WHEEL_SPAN) ? entry.expiry : now + WHEEL_SPAN - 1;
+        list = 2 * SLOTS + ((target >> (2 * TIMER_WHEEL_BITS)) & SLOT_MASK);
+    }
+
+    entry.list = list;
+    entry.prev = NONE;
+    entry.next = heads[list];
+    if (entry.next != NONE) {
+        entries[entry.next].prev = id;
+    }
+    heads[list] = id;
+}
+
+void TimerService::unlink(uint8_t id) {
+    Entry& entry = entries[id];
+    if (entry.list == NONE) return;
+
+    if (entry.prev != NONE) entries[entry.prev].next = entry.next;
+    else heads[entry.list] = entry.next;
+    if (entry.next != NONE) entries[entry.next].prev = entry.prev;
+    entry.list = NONE;
+}
+
+void TimerService::cascade(uint8_t level) {
+    uint8_t list = level * SLOTS + ((now >> (level * TIMER_WHEEL_BITS)) & SLOT_MASK);
+    uint8_t id = heads[list];
+    heads[list] = NONE;
+
+    // Remaining time now fits a lower level
+    while (id != NONE) {
+        uint8_t next = entries[id].next;
+        insert(id);
+        id = next;
+    }
+}
+
+void TimerService::tick() {
+    now++;
+    if ((now & (LEVEL1_SPAN - 1)) == 0) cascade(2);
+    if ((now & SLOT_MASK) == 0) cascade(1);
+
+    // Every timer in the level 0 slot of this tick is due; callbacks may
+    // start timers again, always on a later tick
+    uint8_t list = now & SLOT_MASK;
+    while (heads[list] != NONE) {
+        uint8_t id = heads[list];
+        unlink(id);
+        if (entries[id].callback) {
+            entries[id].callback();
+        }
+    }
+}
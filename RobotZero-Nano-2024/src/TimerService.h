@@ -0,0 +1,62 @@
+#ifndef TIMERSERVICE_H
+#define TIMERSERVICE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// One-shot timers of the firmware, one slot each
+enum TimerId : uint8_t {
+    TIMER_SETUP = 0,        // setup() state machine delays
+    TIMER_CALIBRATION,      // Calibration sample period
+    TIMER_STOP,             // Stop sequence phases
+    TIMER_COUNT
+};
+
+typedef void (*TimerCallback)();
+
+// Millisecond timers on a hierarchical timer wheel.
+// Three levels of 2^TIMER_WHEEL_BITS lists cover 1, 16 and 256 ms per slot;
+// a timer sits in the list of the level its remaining time falls in and
+// cascades down as the wheel turns. Starting and stopping are O(1), a tick
+// only touches the timers of the slots it reaches (each timer cascades at
+// most twice), and expiries fire in order from process(), never from an
+// interrupt, so callbacks may use any module.
+class TimerService {
+public:
+    // Stop every timer and start counting from millis()
+    static void initialize();
+
+    // (Re)start a timer, the callback runs from process() after ms
+    static void start(TimerId id, uint32_t ms, TimerCallback callback = nullptr);
+    static void stop(TimerId id);
+    static bool isRunning(TimerId id);
+
+    // Turn the wheel up to millis(), firing every expiry on the way
+    // (TASK_PERIOD_TIMER_US task, and blocking loops before the scheduler)
+    static void process();
+
+private:
+    static constexpr uint8_t LEVELS = 3;
+    static constexpr uint8_t SLOTS = 1 << TIMER_WHEEL_BITS;
+    static constexpr uint8_t LIST_COUNT = LEVELS * SLOTS;
+    static constexpr uint8_t NONE = 0xFF;
+
+    struct Entry {
+        uint32_t expiry;            // Tick the timer fires on
+        TimerCallback callback;
+        uint8_t next;               // Doubly linked list of the wheel slot
+        uint8_t prev;
+        uint8_t list;               // Slot list, NONE when stopped
+    };
+
+    static Entry entries[TIMER_COUNT];
+    static uint8_t heads[LIST_COUNT];
+    static uint32_t now;            // Last processed tick
+
+    static void insert(uint8_t id);
+    static void unlink(uint8_t id);
+    static void cascade(uint8_t level);
+    static void tick();
+};
+
+#endif // TIMERSERVICE_H
@@ -17,8 +17,21 @@ static constexpr uint8_t DEBUG_LAPS_MODE1 = 5;    // Number of laps for analysis
 static constexpr uint8_t DEBUG_LAPS_MODE2 = 3;    // Number of laps for speed mode
 
 // Logging parameters - Optimized for performance
-static constexpr uint16_t SAMPLE_RATE_STRAIGHT = 100;  // Reduced sampling in straight
-static constexpr uint16_t SAMPLE_RATE_CURVE = 40;      // Reduced sampling in curves
+// A performance record is taken when the error, the correction or a motor
+// output moved by its delta since the last record, no sooner than
+// LOG_SAMPLE_MIN_INTERVAL and no later than LOG_SAMPLE_MAX_INTERVAL (ms).
+// The PID dither moves the correction and motor outputs past their deltas
+// most cycles, so nothing counts as a change while the error stays inside
+// LOG_ERROR_DEADBAND: centred on the line, records fall back to the longest
+// interval
+static constexpr uint16_t LOG_SAMPLE_MIN_INTERVAL = 20;
+static constexpr uint16_t LOG_SAMPLE_MAX_INTERVAL = 200;
+static constexpr int16_t LOG_ERROR_DEADBAND = 20;      // Line position units, above STRAIGHT_THRESHOLD
+static constexpr int16_t LOG_DELTA_ERROR = 8;          // Line position units
+static constexpr int16_t LOG_DELTA_CORRECTION = 64;    // PWM
+static constexpr int16_t LOG_DELTA_MOTOR = 40;         // PWM, either wheel
+static constexpr uint32_t TASK_PERIOD_LOG_SAMPLE_US = 10000;   // Record hand-off to the buffer
+static constexpr uint32_t LOG_FLUSH_INTERVAL_US = 250000;      // Flush buffers, retried until on a straight
 static constexpr uint16_t LOG_BUFFER_SIZE = 64;        // Size of circular buffer
 
 // Flash memory parameters
@@ -27,10 +40,15 @@ static constexpr uint16_t FLASH_PAGE_SIZE = 256;       // Flash page size for wr
 static constexpr uint32_t FLASH_CONTROL_BYTE = 0x0800; // Control byte address
 static constexpr uint8_t FLASH_LOG_READY = 0xAA;       // Value indicating log is ready
 
-// LED Pattern parameters
-static constexpr uint16_t LED_SLOW_BLINK = 1000;       // Slow blink interval (ms)
-static constexpr uint16_t LED_FAST_BLINK = 300;        // Fast blink interval (ms)
-static constexpr uint16_t LED_PATTERN_SWITCH = 3000;   // Time to switch patterns (ms)
+// Live telemetry parameters
+static constexpr uint8_t TELEMETRY_DECIMATION = 8;     // Send one frame every N loop iterations
+static constexpr uint8_t TELEMETRY_BUFFER_SIZE = 128;  // TX staging ring size (bytes)
+static constexpr bool TELEMETRY_RAW_CAPTURE = false;   // Stream raw ADC frames every loop for replay
+static constexpr uint32_t RAW_CAPTURE_BAUD_RATE = 1000000;  // Raw capture needs ~30 bytes per loop
+
+// Serial console parameters
+static constexpr uint32_t TASK_PERIOD_CONSOLE_US = 20000;  // Command polling (50 Hz)
+static constexpr uint8_t CONSOLE_LINE_SIZE = 32;           // Longest command line (bytes)
 #endif
 
 // ====== Pins ======
@@ -47,6 +65,12 @@ static const uint8_t PIN_MOTOR_RIGHT_PWM = 10;   // Right Motor Speed
 // Optimized button debounce time
 static const uint16_t DEBOUNCE_DELAY = 30;  // Reduced from 50ms for faster response
 
+// Button gestures (Peripherals), timed by the Timer0 compare B interrupt
+// once per millis() overflow period (1 tick = 1.024 ms)
+static const uint16_t LONG_PRESS_TIME = 780;    // Hold time of a long press (~800 ms)
+static const uint16_t DOUBLE_PRESS_GAP = 290;   // Longest release inside a double press (~300 ms)
+static const uint8_t BUTTON_TIMER_COMPARE = 64; // OCR0B, apart from the LED compare
+
 // Sensor pins - Only modify if changing physical connections
 static const uint8_t PIN_LINE_LEFT_EDGE = A6;      // Leftmost sensor
 static const uint8_t PIN_LINE_LEFT_MID = A5;
@@ -57,8 +81,27 @@ static const uint8_t PIN_LINE_RIGHT_EDGE = A1;     // Rightmost sensor
 static const uint8_t PIN_MARKER_LEFT = A7;         // Left marker
 static const uint8_t PIN_MARKER_RIGHT = A0;        // Right marker
 
-// Optimized marker reading interval
-static constexpr uint16_t MARKER_READ_INTERVAL = 5;  // Increased from 2ms for better performance
+// ====== Time Base ======
+// Timer1 runs at clk/8, see TimeBase.cpp
+static constexpr uint8_t TIMEBASE_TICKS_PER_US = 2;
+
+// ====== Scheduler ======
+// Task periods for the static task table in main.cpp
+static constexpr uint32_t TASK_PERIOD_CONTROL_US = 1000;   // Line sensors, speed and PID (1 kHz)
+static constexpr uint32_t TASK_PERIOD_MARKERS_US = 2000;   // Marker edge detection (500 Hz)
+static constexpr uint32_t LOOP_RATE_WINDOW_US = 1000000;   // loop() rate measurement window
+
+// Timer wheel (TimerService), 1 ms ticks
+static constexpr uint32_t TASK_PERIOD_TIMER_US = 1000;     // Wheel tick task (1 kHz)
+static constexpr uint8_t TIMER_WHEEL_BITS = 4;             // 16 slots per level, 3 levels cover 4 s
+
+// ====== Status LED ======
+// LedPattern steps its sequences from the Timer0 compare A interrupt,
+// once per millis() overflow period (1 tick = 1.024 ms)
+static constexpr uint8_t LED_TIMER_COMPARE = 128;       // OCR0A, half way between millis() updates
+static constexpr uint8_t LED_SEQUENCE_MAX_STEPS = 64;   // Longest sequence (multiple of 8)
+static constexpr uint8_t LED_STEP_TICKS_FAST = 98;      // Transmission pattern step (~100 ms)
+static constexpr uint8_t LED_STEP_TICKS_SLOW = 146;     // Error code step (~150 ms)
 
 // ====== Predefined Speeds ======
 // Optimized speed settings for better performance
@@ -81,16 +124,63 @@ static constexpr uint8_t STRAIGHT_THRESHOLD = 12;  // Faster straight detection
 static constexpr uint8_t BOOST_DURATION = 15;      // Longer boost
 static constexpr uint8_t BOOST_INCREMENT = 35;     // Stronger boost
 
+// ====== Motor Output Stage ======
+// Each wheel's command is low-pass filtered, then its PWM moves at most
+// accelerationStep per control period away from zero and brakeStep towards
+// it (profile values in debug builds, the constants above otherwise). A
+// wheel changing direction stops at zero first. Without the filter, the
+// saturating PID correction flips between full forward and reverse and the
+// unequal limits pull the mean PWM down.
+static constexpr uint8_t MOTOR_OUTPUT_FILTER_SHIFT = 3;  // Filter weight 1/2^N per control period, 0 = none
+static constexpr uint8_t MOTOR_REVERSE_DEAD_TIME = 0;    // Control periods at zero before reversing, 0 = none
+
+// Speed curve between STRAIGHT_THRESHOLD and TURN_THRESHOLD (SpeedCurve.h)
+static constexpr uint8_t SPEED_CURVE_LINEAR = 0;     // Linear, as map()
+static constexpr uint8_t SPEED_CURVE_QUADRATIC = 1;  // Late braking near the turn threshold
+static constexpr uint8_t SPEED_CURVE_SHAPE = 0;       // SPEED_CURVE_LINEAR or SPEED_CURVE_QUADRATIC
+static constexpr uint8_t SPEED_CURVE_MAX_ERROR = 100;  // Larger errors use the last entry
+
 // ====== PID Control Parameters ======
 static constexpr float K_PROPORTIONAL_DEFAULT = 7.5f;    // More aggressive proportional control
 static constexpr float K_DERIVATIVE_DEFAULT = 900.0f;    // More aggressive derivative control
 static constexpr float FILTER_COEFFICIENT_DEFAULT = 0.8f; // More responsive filtering
 
+// Derivative is scaled to the period the gains were tuned at
+static constexpr uint16_t PID_DT_NOMINAL_TICKS = TASK_PERIOD_CONTROL_US * TIMEBASE_TICKS_PER_US;
+static constexpr uint16_t PID_DT_MIN_TICKS = PID_DT_NOMINAL_TICKS / 8;  // Limits derivative gain
+static constexpr uint16_t PID_DT_MAX_TICKS = PID_DT_NOMINAL_TICKS * 8;  // Stall after a pause
+
+// Gain schedule (GainSchedule.h): PID gains at base speeds 0, 64, 128, 192
+// and 256, linearly interpolated in between. Kp and the filter coefficient
+// are Q8 fixed point (256 = 1.0), Kd is Q4 (16 = 1.0).
+static constexpr uint8_t GAIN_SCHEDULE_BUCKETS = 5;
+static constexpr uint8_t GAIN_SCHEDULE_SHIFT = 6;       // Bucket width 1 << 6 speed units
+static constexpr uint8_t GAIN_KP_FRACTION_BITS = 8;
+static constexpr uint8_t GAIN_KD_FRACTION_BITS = 4;
+static constexpr uint8_t GAIN_FILTER_FRACTION_BITS = 8;
+
+// Profile gains are scaled per bucket, softer at the top speeds
+static constexpr float GAIN_SCHEDULE_SCALE[GAIN_SCHEDULE_BUCKETS] = { 1.0f, 1.0f, 1.0f, 1.0f, 0.85f };
+
 // Desired center position (don't change without recalibrating control)
 static constexpr int16_t POSICION_IDEAL_DEFAULT = 0;
 
 // ====== Marker Parameters ======
-static constexpr int16_t MARKER_DETECTION_THRESHOLD = 180;
+// The marker sensors are sampled by the marker task, so edge times and pulse
+// durations have a resolution of TASK_PERIOD_MARKERS_US
+static constexpr int16_t MARKER_DETECTION_THRESHOLD = 180;  // Marker starts at or below this value
+static constexpr int16_t MARKER_RELEASE_THRESHOLD = 260;    // Marker ends at or above this value (hysteresis)
+static constexpr uint8_t MARKER_MIN_PULSE_SAMPLES = 2;      // Pulses seen by fewer samples are discarded as noise
+static constexpr uint16_t MARKER_MIN_PULSE_US = MARKER_MIN_PULSE_SAMPLES * TASK_PERIOD_MARKERS_US;
+static constexpr uint8_t MARKER_EDGE_QUEUE_SIZE = 16;       // Pending marker edges
+static constexpr uint32_t MARKER_MAX_PULSE_US = 150000;     // Longer pulses are a sensor riding a line, not a pad
+static constexpr uint8_t MARKER_FULL_PULSE_SAMPLES = 4;     // Pulses this many samples long get full duration confidence
+static_assert(MARKER_FULL_PULSE_SAMPLES > MARKER_MIN_PULSE_SAMPLES, "Duration confidence needs a range above the noise limit");
+static constexpr int16_t MARKER_FULL_DEPTH = 120;           // Readings this dark get full depth confidence
+static constexpr uint8_t MARKER_MIN_CONFIDENCE = 40;        // Single markers below this (0-100) are ignored
+static constexpr uint8_t MARKER_COINCIDENCE_RATIO = 2;      // Pattern stays open this many pulse lengths after the last pulse
+static constexpr uint16_t MARKER_WINDOW_MIN_US = 4000;      // Shortest co-occurrence window
+static constexpr uint16_t MARKER_WINDOW_MAX_US = 60000;     // Longest co-occurrence window
 // Base speeds - Significantly increased
 static constexpr uint8_t BASE_SLOW = 160;  // Increased from 115
 static constexpr uint8_t BASE_FAST = 200;  // Increased from 115
@@ -100,14 +190,51 @@ static constexpr uint8_t BASE_FAST = 200;  // Increased from 115
 static const uint16_t SETUP_DELAY = 400;           // Reduced from 600
 static const uint16_t CALIBRATION_SAMPLES = 300;   // Reduced from 400
 static const uint8_t CALIBRATION_DELAY = 20;       // Reduced from 30
-static const uint16_t STOP_DELAY = 200;            // Reduced from 300
+
+// ====== Stop Sequence ======
+// First-order motor model: wheel speed follows PWM * MOTOR_MODEL_MAX_SPEED / 255
+// with a MOTOR_MODEL_TIME_CONSTANT lag. Fit it with host/brakefit.
+static constexpr uint16_t MOTOR_MODEL_MAX_SPEED = 1500;     // Wheel speed at PWM 255 (mm/s)
+static constexpr uint16_t MOTOR_MODEL_TIME_CONSTANT = 30;   // Motor response (ms)
+
+// The robot stops STOP_DISTANCE_MM past the last finish line: it drives on,
+// then reverses with the gentlest power that stops it within
+// STOP_BRAKE_DISTANCE_MM (BrakeProfile.h)
+static constexpr uint16_t STOP_DISTANCE_MM = 150;
+static constexpr uint16_t STOP_BRAKE_DISTANCE_MM = 20;
+static constexpr uint8_t STOP_BRAKE_MIN_POWER = 40;         // Gentlest reverse PWM
+static constexpr uint8_t STOP_BRAKE_MAX_POWER = 255;
+static constexpr uint8_t BRAKE_PROFILE_STEP = 16;           // Speed bin width (PWM)
+
+// ====== ADC ======
+// Line sensor acquisition: 8 = left-adjusted 8-bit reads at clk/16 (~13 us per
+// conversion), 10 = full resolution analogRead at clk/128 (~104 us).
+// Select with -D SENSOR_ADC_BITS=10. Marker sensors always use analogRead.
+#ifndef SENSOR_ADC_BITS
+#define SENSOR_ADC_BITS 8
+#endif
+static_assert(SENSOR_ADC_BITS == 8 || SENSOR_ADC_BITS == 10, "SENSOR_ADC_BITS must be 8 or 10");
+static constexpr uint8_t SENSOR_ADC_SHIFT = 10 - SENSOR_ADC_BITS;          // 10-bit ADC counts to sensor counts
+static constexpr uint8_t ADC_PRESCALER = (SENSOR_ADC_BITS == 8) ? 16 : 128;
+static constexpr uint8_t ADC_CONVERSION_US = 13 * ADC_PRESCALER / 16;       // 13 ADC clocks at 16 MHz
+static constexpr int16_t ADC_MAX_VALUE = 1023;                             // analogRead full scale
+
+// ====== Calibration Storage ======
+static constexpr uint16_t EEPROM_CALIBRATION_ADDRESS = 0;  // Calibration block address in EEPROM
+static constexpr uint8_t CALIBRATION_VERSION = 2;          // Bump when CalibrationData layout changes
+static constexpr int16_t CALIBRATION_MIN_RANGE = 50 >> SENSOR_ADC_SHIFT;  // Minimum max-min spread for a valid sensor
 
 // ====== Sensor Parameters ======
 static const uint8_t NUM_SENSORES = 6;
-static constexpr int16_t SENSOR_MAX_VALUE = 1023;
+static constexpr int16_t SENSOR_MAX_VALUE = (1 << SENSOR_ADC_BITS) - 1;
 static constexpr int16_t SENSOR_MIN_VALUE = 0;
 static constexpr int16_t SENSOR_THRESHOLD = 100;  // Reduced from 120 for faster response
 
+// Oversampling: 2^shift line sweeps averaged when the control budget has room
+static constexpr uint8_t OVERSAMPLE_MAX_SHIFT = 2;        // Up to 4 sweeps per control cycle
+static constexpr uint8_t OVERSAMPLE_MAX_SPEED = BASE_SLOW; // Single sweeps above this outside precision mode
+static constexpr uint16_t OVERSAMPLE_MARGIN_US = 100;     // Control budget kept free for jitter
+
 // ====== Sensor Weights ======
 // Optimized weights for better responsiveness
 static constexpr float SENSOR_WEIGHT_S1 = -3.0f;  // Increased from -2.5f
@@ -100,6 +100,7 @@ class ConfigEditor(QMainWindow):
                 "FILTER_COEFFICIENT_DEFAULT": {"default": 0.8, "min": 0, "max": 1.0},
                 "TURN_THRESHOLD": {"default": 35, "min": 0, "max": 100},
                 "STRAIGHT_THRESHOLD": {"default": 12, "min": 0, "max": 50},
+                "SPEED_CURVE_SHAPE": {"default": 0, "min": 0, "max": 1},
             },
             "Sensor Parameters": {
                 "SENSOR_WEIGHT_S1": {"default": -3.0, "min": -10.0, "max": 10.0},
@@ -112,7 +113,6 @@ class ConfigEditor(QMainWindow):
             "Timing Parameters": {
                 "SETUP_DELAY": {"default": 400, "min": 0, "max": 2000},
                 "CALIBRATION_DELAY": {"default": 20, "min": 0, "max": 100},
-                "MARKER_READ_INTERVAL": {"default": 5, "min": 1, "max": 50},
                 "DEBOUNCE_DELAY": {"default": 30, "min": 0, "max": 200},
             }
         }
@@ -213,7 +213,7 @@ class ConfigEditor(QMainWindow):
                 if isinstance(value, float):
                     content.append(f"static constexpr float {param_name} = {value}f;")
                 else:
-                    if param_name in ["SETUP_DELAY", "CALIBRATION_DELAY", "MARKER_READ_INTERVAL", "DEBOUNCE_DELAY"]:
+                    if param_name in ["SETUP_DELAY", "CALIBRATION_DELAY", "DEBOUNCE_DELAY"]:
                         content.append(f"static constexpr uint16_t {param_name} = {value};")
                     else:
                         content.append(f"static constexpr uint8_t {param_name} = {value};")
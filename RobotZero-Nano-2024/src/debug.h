@@ -18,6 +18,7 @@ const char DEBUG_FAST_MODE[] PROGMEM = "Fast mode activated";
 const char DEBUG_INTERSECTION[] PROGMEM = "Intersection detected";
 const char DEBUG_SETUP_START[] PROGMEM = "Starting setup";
 const char DEBUG_SETUP_COMPLETE[] PROGMEM = "Setup completed";
+const char DEBUG_CALIBRATION_LOADED[] PROGMEM = "Calibration loaded from EEPROM";
 
 // Helper function to print strings from Flash
 inline void debugPrintFlash(const char* str) {
@@ -8,4 +8,10 @@ extern bool isStopSequenceActive; // Stopping sequence active
 extern int lapCount;                // End marker counter
 extern bool isPrecisionMode;              // Slow mode active
 
+// Run control (main.cpp)
+void initializeControl();           // Load profile, PID gains and logging
+void startRun();                    // Reset control state and start the run
+void restartRun();                  // Close the last log session and start a new run
+bool buttonTask();                  // Button gestures, posted by the button interrupt
+
 #endif // GLOBALS_H
\ No newline at end of file
@@ -6,18 +6,27 @@
 #include "ProfileManager.h"
 #include "FlashManager.h"
 #include "Logger.h"
-#include "LedPattern.h"
+#include "FlashReader.h"
+#include "Telemetry.h"
+#include "Console.h"
 #endif
 
 // Core system includes
 #include "config.h"
 #include "debug.h"
-#include "Timer.h"
 #include "globals.h"
 #include "MotorsDrivers.h"
 #include "Sensors.h"
 #include "Peripherals.h"
+#include "LedPattern.h"
 #include "CourseMarkers.h"
+#include "StopController.h"
+#include "PidController.h"
+#include "Scheduler.h"
+#include "TimeBase.h"
+#include "TimerService.h"
+#include "Adc.h"
+#include "CycleProbe.h"
 
 // Global variables initialization
 int currentSpeed = 0;
@@ -31,6 +40,7 @@ enum SetupState {
     SETUP_INIT,
     SETUP_WAIT1,
     SETUP_WAIT2,
+    SETUP_LOAD_CALIBRATION,
     SETUP_BUTTON1,
     SETUP_CALIBRATION,
     SETUP_BUTTON2,
@@ -44,77 +54,346 @@ uint8_t plannedLaps = (DEBUG_LEVEL == 1) ? DEBUG_LAPS_MODE1 : DEBUG_LAPS_MODE2;
 
 // Control parameters
 int targetLinePosition = POSICION_IDEAL_DEFAULT;
-float kProportional = K_PROPORTIONAL_DEFAULT;
-float kDerivative = K_DERIVATIVE_DEFAULT;
-float filterCoefficient = FILTER_COEFFICIENT_DEFAULT;
-int filteredErrorRate = 0;
-int previousError = 0;
 
-void setup() {
-    // Initialize serial if in debug mode
+// Timer wheel tick, fires due timer callbacks (TASK_PERIOD_TIMER_US)
+static bool timerTask() {
+    TimerService::process();
+    return true;
+}
+
+// Marker edge detection and stop sequence (TASK_PERIOD_MARKERS_US)
+static bool markerTask() {
+    CourseMarkers::processMarkerSignals();
+    return true;
+}
+
+// Line position, speed and PID (TASK_PERIOD_CONTROL_US)
+static bool controlTask() {
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_CONTROL);
+#if DEBUG_LEVEL > 0
+    uint32_t cycleTime = micros();
+#endif
+
+    // Skip control if robot is stopped
+    if (isRobotStopped) {
+        MotorDriver::stopMotors();
+#if DEBUG_LEVEL > 0
+        if (Logger::isLogging()) {
+            Logger::endSession();
+        }
+#endif
+        CYCLE_PROBE_END(CYCLE_PROBE_CONTROL);
+        return true;
+    }
+
+    // Stop sequence: reverse power until the motor model stands still
+    if (StopController::isBraking()) {
+        int brakePower = -StopController::getBrakePower();
+        MotorDriver::setMotorsPower(brakePower, brakePower);
+        CYCLE_PROBE_END(CYCLE_PROBE_CONTROL);
+        return true;
+    }
+
+    // Oversample with the time the last cycle left in the control budget
+    const Task* self = Scheduler::getCurrentTask();
+    Sensors::planAcquisition(self->budgetUs, self->lastTimeUs);
+
+    // Get current position and calculate error
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_LINE_POSITION);
+    int linePosition = Sensors::calculateLinePosition();
+    CYCLE_PROBE_END(CYCLE_PROBE_LINE_POSITION);
+    int error = linePosition - targetLinePosition;
+
+    // Update current speed using new control interface
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_SPEED_CONTROL);
+#if DEBUG_LEVEL > 0
+    currentSpeed = ProfileManager::getSpeedValue(CourseMarkers::speedControl(error));
+#else
+    currentSpeed = CourseMarkers::speedControl(error);
+#endif
+    // Stop sequence: drive on at the speed the braking was planned for
+    if (StopController::isActive()) {
+        currentSpeed = min(currentSpeed, StopController::getHoldSpeed());
+    }
+    CYCLE_PROBE_END(CYCLE_PROBE_SPEED_CONTROL);
+
+    // Calculate PID correction
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_PID);
+    int correction_power = PidController::update(error, currentSpeed);
+    CYCLE_PROBE_END(CYCLE_PROBE_PID);
+
+    // Apply correction to motors
+    int left_power = constrain(currentSpeed + correction_power, -255, 255);
+    int right_power = constrain(currentSpeed - correction_power, -255, 255);
+
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_MOTORS);
+    MotorDriver::setMotorsPower(left_power, right_power);
+    CYCLE_PROBE_END(CYCLE_PROBE_MOTORS);
+
+    // Log and telemetry show what the output stage applied
+    left_power = MotorDriver::getLeftOutput();
+    right_power = MotorDriver::getRightOutput();
+
+#if DEBUG_LEVEL > 0
+    uint8_t state = 0;
+    if (isPrecisionMode) state |= 0x01;
+    if (abs(error) > TURN_THRESHOLD) state |= 0x02;
+
+    // Latest values for the log sampling task
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_LOG_PERFORMANCE);
+    Logger::logPerformance(linePosition, error, correction_power,
+        left_power, right_power, state);
+    CYCLE_PROBE_END(CYCLE_PROBE_LOG_PERFORMANCE);
+
+    // Live telemetry (binary, non-blocking)
+    if (TELEMETRY_RAW_CAPTURE) {
+        Telemetry::sendRawFrame(cycleTime, left_power, right_power);
+    }
+    else {
+        Telemetry::sendFrame(currentSpeed, error, correction_power,
+            left_power, right_power, state);
+    }
+#endif
+    CYCLE_PROBE_END(CYCLE_PROBE_CONTROL);
+    return true;
+}
+
+#if DEBUG_LEVEL > 0
+// Performance record sampling (TASK_PERIOD_LOG_SAMPLE_US)
+static bool logSampleTask() {
+    Logger::sample();
+    return true;
+}
+
+// Flash flush, retried in the background until on a straight
+static bool logFlushTask() {
+    return Logger::process();
+}
+
+// Serial console commands (TASK_PERIOD_CONSOLE_US)
+static bool consoleTask() {
+    return Console::process();
+}
+
+// Telemetry TX staging (background)
+static bool telemetryTask() {
+    Telemetry::process();
+    return true;
+}
+#endif
+
+// Gestures while stopped, other than the short press that starts a run
+static void stoppedGesture(uint8_t events) {
+#if DEBUG_LEVEL > 0
+    // Long press: send the log of the last run
+    if ((events & BUTTON_EVENT_LONG) && FlashManager::isLogReady()) {
+        LedPattern::play(LED_CHANNEL_TRANSMISSION, LED_PATTERN_TRANSMISSION);
+        FlashReader::processCommands();
+        LedPattern::stop(LED_CHANNEL_TRANSMISSION);
+    }
+
+    // Double press: switch profile, one flash for analysis, two for speed
+    if (events & BUTTON_EVENT_DOUBLE) {
+        bool analysis = currentDebugMode != DebugMode::ANALYSIS;
+        currentDebugMode = analysis ? DebugMode::ANALYSIS : DebugMode::SPEED;
+        plannedLaps = analysis ? DEBUG_LAPS_MODE1 : DEBUG_LAPS_MODE2;
+        ProfileManager::initialize(currentDebugMode);
+        PidController::initialize(ProfileManager::getGainSchedule());
+        LedPattern::play(LED_CHANNEL_STATUS,
+            analysis ? LED_PATTERN_PROFILE_ANALYSIS : LED_PATTERN_PROFILE_SPEED);
+    }
+#else
+    (void)events;
+#endif
+}
+
+// Gesture whose press stopped the run, its release is not a new command
+static bool stopGesture = false;
+
+// Button gestures (posted by the button interrupt)
+bool buttonTask() {
+    uint8_t events = Peripherals::takeEvents();
+
+    if (!isRobotStopped) {
+        // Emergency stop on the press itself, the control task
+        // closes the log session
+        if (events & BUTTON_EVENT_PRESS) {
+            MotorDriver::stopMotors();
+            isRobotStopped = true;
+            stopGesture = true;
+#if DEBUG_LEVEL > 0
+            FlashManager::setLogReady();
+#endif
+        }
+        return true;
+    }
+
+    if (stopGesture) {
+        if (events & (BUTTON_EVENT_SHORT | BUTTON_EVENT_LONG | BUTTON_EVENT_DOUBLE)) {
+            stopGesture = false;
+        }
+        return true;
+    }
+
+    if (events & BUTTON_EVENT_SHORT) {
+        restartRun();
+        return true;
+    }
+    stoppedGesture(events);
+    return true;
+}
+
+// Blocks setup() until a short press, other gestures act as after a run
+static void waitForStart() {
+    Peripherals::takeEvents();  // Drop earlier gestures
+    uint8_t events = 0;
+
+    while (!(events & BUTTON_EVENT_SHORT)) {
+        TimerService::process();
+        events = Peripherals::takeEvents();
+        stoppedGesture(events);
+    }
+}
+
+// Static task table: run, period (us), priority, budget (us)
+static Task tasks[] = {
+    { timerTask, TASK_PERIOD_TIMER_US, 0, 100 },
+    { markerTask, TASK_PERIOD_MARKERS_US, 1, 300 },
+    { controlTask, TASK_PERIOD_CONTROL_US, 2, 800 },
+    { buttonTask, TASK_PERIOD_EVENT, 3, 300 },
+#if DEBUG_LEVEL > 0
+    { logSampleTask, TASK_PERIOD_LOG_SAMPLE_US, 4, 100 },
+    { logFlushTask, LOG_FLUSH_INTERVAL_US, 5, 20000 },
+    { consoleTask, TASK_PERIOD_CONSOLE_US, 6, 300 },
+    { telemetryTask, 0, 7, 100 },
+#endif
+};
+
+void initializeControl() {
+    TimerService::initialize();
+
 #if DEBUG_LEVEL > 0
-    Serial.begin(115200);
     // Initialize profile manager with appropriate mode
     ProfileManager::initialize(currentDebugMode);
 
     // Update control parameters from profile
-    kProportional = ProfileManager::getKP(K_PROPORTIONAL_DEFAULT);
-    kDerivative = ProfileManager::getKD(K_DERIVATIVE_DEFAULT);
-    filterCoefficient = ProfileManager::getFilterCoefficient(FILTER_COEFFICIENT_DEFAULT);
+    PidController::initialize(ProfileManager::getGainSchedule());
 
     // Initialize logger and flash
     FlashManager::initialize();
     Logger::initialize();
+#else
+    PidController::initialize(nullptr);  // Default gains from config.h
+#endif
+}
+
+void startRun() {
+    // Initialize control variables
+    PidController::reset();
+    Sensors::resetStatistics();
+    MotorDriver::resetOutputStage();
+    StopController::reset();
+
+    // Set initial speed based on mode
+#if DEBUG_LEVEL > 0
+    currentSpeed = ProfileManager::getSpeedValue(BASE_FAST);
+    // Start logging session
+    Logger::startSession(currentDebugMode, plannedLaps);
+    if (TELEMETRY_RAW_CAPTURE) {
+        Telemetry::sendCalibration();
+    }
+#else
+    currentSpeed = BASE_FAST;
+#endif
+
+    lapCount = 0;
+    Scheduler::initialize(tasks, sizeof(tasks) / sizeof(tasks[0]));
+}
+
+void restartRun() {
+#if DEBUG_LEVEL > 0
+    if (Logger::isLogging()) {
+        Logger::endSession();
+    }
 #endif
+    isRobotStopped = false;
+    isStopSequenceActive = false;
+    startRun();
+}
+
+void setup() {
+    // Initialize serial if in debug mode
+#if DEBUG_LEVEL > 0
+    Serial.begin(TELEMETRY_RAW_CAPTURE ? RAW_CAPTURE_BAUD_RATE : 115200);
+#endif
+    initializeControl();
 
     DEBUG_PRINT(DEBUG_SETUP_START);
 
     // Hardware initialization
+    TimeBase::initialize();
+    Adc::initialize();
     Peripherals::initialize();
     MotorDriver::initializeMotorDriver();
-    pinMode(PIN_STATUS_LED, OUTPUT);
 
     // Non-blocking setup loop
     SetupState setupState = SETUP_INIT;
-    Timer setupTimer;
 
     while (setupState != SETUP_COMPLETE) {
+        TimerService::process();
+
         switch (setupState) {
         case SETUP_INIT:
-            setupTimer.Start(SETUP_DELAY);
+            TimerService::start(TIMER_SETUP, SETUP_DELAY);
             setupState = SETUP_WAIT1;
             break;
 
         case SETUP_WAIT1:
-            if (setupTimer.Expired()) {
-                digitalWrite(PIN_STATUS_LED, LOW);
-                MotorDriver::setMotorsPower(0, 0);
-                setupTimer.Start(SETUP_DELAY);
+            if (!TimerService::isRunning(TIMER_SETUP)) {
+                MotorDriver::stopMotors();
+                TimerService::start(TIMER_SETUP, SETUP_DELAY);
                 setupState = SETUP_WAIT2;
             }
             break;
 
         case SETUP_WAIT2:
-            if (setupTimer.Expired()) {
+            if (!TimerService::isRunning(TIMER_SETUP)) {
+                setupState = SETUP_LOAD_CALIBRATION;
+            }
+            break;
+
+        case SETUP_LOAD_CALIBRATION:
+            // Holding the button at boot forces a new calibration
+            if (digitalRead(PIN_START_BUTTON) == HIGH) {
+                setupState = SETUP_BUTTON1;
+            }
+            else if (Sensors::loadCalibration()) {
+                DEBUG_PRINTLN(DEBUG_CALIBRATION_LOADED);
+                setupState = SETUP_BUTTON2;
+            }
+            else {
+                // Nothing valid stored, calibrate first
+                LedPattern::play(LED_CHANNEL_ERROR, LED_PATTERN_ERROR_CALIBRATION);
                 setupState = SETUP_BUTTON1;
             }
             break;
 
         case SETUP_BUTTON1:
-            Peripherals::waitForButtonPress();
-            digitalWrite(PIN_STATUS_LED, HIGH);
+            waitForStart();
+            LedPattern::play(LED_CHANNEL_STATUS, LED_PATTERN_ON);
             setupState = SETUP_CALIBRATION;
             break;
 
         case SETUP_CALIBRATION:
             Sensors::calibration();
-            digitalWrite(PIN_STATUS_LED, LOW);
+            Sensors::saveCalibration();
+            LedPattern::stop(LED_CHANNEL_STATUS);
             setupState = SETUP_BUTTON2;
             break;
 
         case SETUP_BUTTON2:
-            Peripherals::waitForButtonPress();
-            digitalWrite(PIN_STATUS_LED, HIGH);
+            // The LED is left to the marker feedback during the run
+            waitForStart();
             setupState = SETUP_COMPLETE;
             break;
 
@@ -123,93 +402,15 @@ void setup() {
         }
     }
 
-    // Initialize control variables
-    previousError = 0;
-    filteredErrorRate = 0;
-
-    // Set initial speed based on mode
-#if DEBUG_LEVEL > 0
-    currentSpeed = ProfileManager::getSpeedValue(BASE_FAST);
-    // Start logging session
-    Logger::startSession(currentDebugMode, plannedLaps);
-#else
-    currentSpeed = BASE_FAST;
-#endif
-
-    lapCount = 0;
+    startRun();
     DEBUG_PRINTLN(DEBUG_SETUP_COMPLETE);
 }
 
 void loop() {
-#if DEBUG_LEVEL > 0
-    LedPattern::process();
-#endif
-
-    // Process marker signals with optimized timing
-    CourseMarkers::processMarkerSignals();
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_EMPTY);
+    CYCLE_PROBE_END(CYCLE_PROBE_EMPTY);
 
-    // Skip control if robot is stopped
-    if (isRobotStopped) {
-        MotorDriver::setMotorsPower(0, 0);
-#if DEBUG_LEVEL > 0
-        if (Logger::isLogging()) {
-            Logger::endSession();
-        }
-#endif
-        return;
-    }
-
-    // Get current position and calculate error
-    int linePosition = Sensors::calculateLinePosition();
-    int error = linePosition - targetLinePosition;
-
-    // Update current speed using new control interface
-#if DEBUG_LEVEL > 0
-    currentSpeed = ProfileManager::getSpeedValue(CourseMarkers::speedControl(error));
-#else
-    currentSpeed = CourseMarkers::speedControl(error);
-#endif
-
-    // Calculate error derivative and filter
-    int d_error = error - previousError;
-    filteredErrorRate = filterCoefficient * d_error + (1 - filterCoefficient) * filteredErrorRate;
-
-    // Calculate PID correction
-    float proportional_term = kProportional * error;
-    float derivative_term = kDerivative * filteredErrorRate;
-    float total_correction = proportional_term + derivative_term;
-
-    // Adjust correction gain based on speed
-    float speed_factor = (currentSpeed > 200) ? 0.85f : 1.0f;
-    int correction_power = constrain(int(total_correction * speed_factor), -255, 255);
-
-    // Apply correction to motors
-    int left_power = constrain(currentSpeed + correction_power, -255, 255);
-    int right_power = constrain(currentSpeed - correction_power, -255, 255);
-
-    MotorDriver::setMotorsPower(left_power, right_power);
-    previousError = error;
-
-#if DEBUG_LEVEL > 0
-    // Log performance data
-    if (Logger::isLogging()) {
-        uint8_t state = 0;
-        if (isPrecisionMode) state |= 0x01;
-        if (abs(error) > TURN_THRESHOLD) state |= 0x02;
-
-        Logger::logPerformance(linePosition, error, correction_power,
-            left_power, right_power, state);
-
-        // Process logger (handles buffer flushing)
-        Logger::process();
-    }
-
-    // Debug output
-    DEBUG_PRINT(DEBUG_BASE);
-    DEBUG_PRINT_VAL(currentSpeed);
-    DEBUG_PRINT(DEBUG_ERROR);
-    DEBUG_PRINT_VAL(error);
-    DEBUG_PRINT(DEBUG_CORRECTION);
-    DEBUG_PRINTLN_VAL(correction_power);
-#endif
-}   
\ No newline at end of file
+    CYCLE_PROBE_BEGIN(CYCLE_PROBE_LOOP);
+    Scheduler::dispatch();
+    CYCLE_PROBE_END(CYCLE_PROBE_LOOP);
+}
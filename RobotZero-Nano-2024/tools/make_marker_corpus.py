@@ -0,0 +1,182 @@
+"""Generates the marker classifier corpus in host/markers/corpus.
+
+Each file is a raw capture (the tools/telemetry_receiver.py --raw-csv
+format) of the robot driving centred over one marker situation at a
+constant speed, with the outcome CourseMarkers must reach on a
+"# expect" line. Marker readings come from a sensor footprint model:
+white floor ~850, black ~120, a blurred edge and reading noise.
+
+    python tools/make_marker_corpus.py
+    python tools/run_markers.py
+
+Real captures can be added next to the generated files; give them an
+expect line by hand.
+"""
+import argparse
+import math
+import random
+import sys
+from pathlib import Path
+from typing import List, NamedTuple, Tuple
+
+PROJECT_DIR = Path(__file__).resolve().parent.parent
+CORPUS_DIR = PROJECT_DIR / 'host' / 'markers' / 'corpus'
+
+PERIOD_US = 1000
+LEAD_MS = 30
+TAIL_MS = 100           # Longer than MARKER_WINDOW_MAX_US plus the stop delay margin
+SPEEDS_MM_S = (600, 1000, 1500)
+
+WHITE = 850
+BLACK = 120
+NOISE = 6
+EDGE_BLUR_MM = 2.5
+MARKER_LATERAL_MM = 45.0
+PAD_LENGTH_MM = 25.0
+SHORT_PAD_MM = 12.5     # Dark for four frames at top speed, two marker task samples
+LINE_WIDTH_MM = 19.0
+
+# Line array, same model as the golden scenarios
+LINE_POSITIONS_MM = (-30.0, -15.0, -8.0, 8.0, 15.0, 30.0)
+LINE_SPREAD_MM = 12.0
+LINE_MIN = 100
+LINE_MAX = 900
+
+
+class Dark(NamedTuple):
+    """Dark interval along the travel seen by one marker sensor."""
+    side: str           # 'L' or 'R'
+    start_mm: float
+    end_mm: float
+    coverage: float     # Fraction of the footprint over black at full overlap
+
+
+class Spike(NamedTuple):
+    """Electrical glitch, the reading drops to black for a few frames."""
+    side: str
+    time_ms: float
+    frames: int
+
+
+class Case(NamedTuple):
+    name: str
+    description: str
+    darks: List[Dark]
+    spikes: List[Spike]
+    length_mm: float    # Distance covered by the features
+    expect: Tuple[int, int, int, int]   # laps, toggles, intersections, rejected
+
+
+def pad(side: str, start: float, coverage: float = 1.0, length: float = PAD_LENGTH_MM) -> Dark:
+    return Dark(side, start, start + length, coverage)
+
+
+def crossing(centre: float, angle_deg: float) -> List[Dark]:
+    """A line crossing the course at an angle, left sensor is at -lateral."""
+    slope = math.tan(math.radians(angle_deg))
+    half = LINE_WIDTH_MM / 2 / math.cos(math.radians(angle_deg))
+    darks = []
+    for side, lateral in (('L', -MARKER_LATERAL_MM), ('R', MARKER_LATERAL_MM)):
+        middle = centre + lateral * slope
+        darks.append(Dark(side, middle - half, middle + half, 1.0))
+    return darks
+
+
+def cases(speed: int) -> List[Case]:
+    # Ride-along length is fixed in time so it stays longer than MARKER_MAX_PULSE_US
+    ride_mm = speed * 0.25
+    result = [
+        Case('finish', 'finish pad on the left', [pad('L', 0)], [], PAD_LENGTH_MM, (1, 0, 0, 0)),
+        Case('speed_mode', 'speed mode pad on the right', [pad('R', 0)], [], PAD_LENGTH_MM, (0, 1, 0, 0)),
+        Case('crossing', 'square crossing', crossing(0, 0), [], LINE_WIDTH_MM, (0, 0, 1, 0)),
+        Case('crossing_skew10', 'crossing skewed 10 deg, left first', crossing(60, 10), [], 120, (0, 0, 1, 0)),
+        Case('crossing_skew25', 'crossing skewed 25 deg, right first', crossing(60, -25), [], 120, (0, 0, 1, 0)),
+        Case('finish_then_speed', 'finish pad then a speed mode pad 150 mm later',
+             [pad('L', 0), pad('R', 150)], [], 175, (1, 1, 0, 0)),
+        Case('speed_then_crossing', 'speed mode pad then a skewed crossing 200 mm later',
+             [pad('R', 0)] + crossing(240, 15), [], 280, (0, 1, 1, 0)),
+        Case('skim', 'right sensor grazes the edge of a pad', [pad('R', 0, 0.935)], [], PAD_LENGTH_MM,
+             (0, 0, 0, 1)),
+        Case('glitch', 'two-frame electrical dip on the right', [], [Spike('R', 10, 2)], 20,
+             (0, 0, 0, 0)),
+        Case('ride_along', 'left sensor rides a dark stripe for 250 ms', [Dark('L', 0, ride_mm, 1.0)], [],
+             ride_mm, (0, 0, 0, 1)),
+    ]
+    if speed == max(SPEEDS_MM_S):
+        result.append(Case('short_pad', 'short finish pad seen by two marker samples',
+                           [pad('L', 0, length=SHORT_PAD_MM)], [], SHORT_PAD_MM, (1, 0, 0, 0)))
+    return result
+
+
+def coverage_at(darks: List[Dark], side: str, position: float) -> float:
+    total = 0.0
+    for dark in darks:
+        if dark.side != side:
+            continue
+        enter = 0.5 * (1 + math.erf((position - dark.start_mm) / (EDGE_BLUR_MM * math.sqrt(2))))
+        leave = 0.5 * (1 + math.erf((position - dark.end_mm) / (EDGE_BLUR_MM * math.sqrt(2))))
+        total += dark.coverage * (enter - leave)
+    return min(total, 1.0)
+
+
+def marker_reading(coverage: float, rng: random.Random) -> int:
+    value = WHITE - coverage * (WHITE - BLACK) + rng.gauss(0, NOISE)
+    return max(0, min(1023, round(value)))
+
+
+def write_case(path: Path, case: Case, speed: int) -> None:
+    rng = random.Random(f'{case.name}-{speed}')
+    lead_mm = speed * LEAD_MS / 1000
+    frames = round((LEAD_MS + TAIL_MS) * 1000 / PERIOD_US + case.length_mm / speed * 1e6 / PERIOD_US)
+
+    with open(path, 'w') as output:
+        laps, toggles, intersections, rejected = case.expect
+        output.write(f'# {case.description} at {speed} mm/s\n')
+        output.write(f'# expect laps {laps} toggles {toggles} intersections {intersections} '
+                     f'rejected {rejected}\n')
+        output.write('calibration,' + ','.join([str(LINE_MIN)] * 6 + [str(LINE_MAX)] * 6) + '\n')
+        output.write('timestamp_us,line0,line1,line2,line3,line4,line5,'
+                     'marker_left,marker_right,left_power,right_power\n')
+
+        for frame in range(frames):
+            time_ms = frame * PERIOD_US / 1000
+            position = time_ms * speed / 1000 - lead_mm
+
+            line = []
+            for sensor in LINE_POSITIONS_MM:
+                distance = sensor / LINE_SPREAD_MM
+                value = LINE_MAX - math.exp(-distance * distance) * (LINE_MAX - LINE_MIN)
+                line.append(round(value + rng.gauss(0, NOISE)))
+
+            markers = []
+            for side in ('L', 'R'):
+                value = marker_reading(coverage_at(case.darks, side, position), rng)
+                for spike in case.spikes:
+                    start = spike.time_ms + LEAD_MS
+                    if spike.side == side and start <= time_ms < start + spike.frames * PERIOD_US / 1000:
+                        value = BLACK
+                markers.append(value)
+
+            values = [(frame + 1) * PERIOD_US, *line, *markers, 0, 0]
+            output.write(','.join(str(v) for v in values) + '\n')
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--output', type=Path, default=CORPUS_DIR, help='Corpus directory')
+    args = parser.parse_args(argv)
+
+    args.output.mkdir(parents=True, exist_ok=True)
+    count = 0
+    for speed in SPEEDS_MM_S:
+        for case in cases(speed):
+            write_case(args.output / f'{case.name}_{speed}.csv', case, speed)
+            count += 1
+
+    print(f'wrote {count} captures to {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
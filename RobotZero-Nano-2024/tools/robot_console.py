@@ -0,0 +1,124 @@
+"""Interactive client for the RobotZero serial console (src/Console.h).
+
+Commands are sent as text lines, the replies come back as CONSOLE frames
+in the binary telemetry stream, so control telemetry keeps flowing while
+tuning. Type 'help' for the command list.
+
+Usage:
+    python robot_console.py COM6
+    python robot_console.py /dev/ttyUSB0 -c "g speedFast" -c "s kProportional 4.5"
+    python robot_console.py /dev/pts/3      # host build, pio run -e console
+
+Needs pyserial for real ports; pseudo terminals of the host build are
+opened directly.
+"""
+import argparse
+import os
+import select
+import sys
+import time
+from typing import Callable, List, Optional
+
+from telemetry_receiver import ConsoleFrame, FrameDecoder, TelemetryFrame
+
+HELP = """\
+?                  list profile fields with their values
+g <field>          read a profile field
+s <field> <value>  write a profile field (lost at reset)
+t                  task statistics: t<index> last max overruns late,
+                   then loop rate and dropped telemetry frames
+r                  start a run when stopped
+x                  stop the robot
+quit               leave the console"""
+
+
+class ConsoleLink:
+    """Sends command lines and collects the console replies."""
+
+    def __init__(self, read: Callable[[int], bytes], write: Callable[[bytes], None]):
+        self.read = read      # Returns b'' after a short timeout
+        self.write = write
+        self.decoder = FrameDecoder()
+        self.control_frames = 0
+
+    def poll(self) -> List[str]:
+        """Decode what arrived, return the console lines."""
+        texts = []
+        for frame in self.decoder.feed(self.read(256)):
+            if isinstance(frame, ConsoleFrame):
+                texts.append(frame.text)
+            elif isinstance(frame, TelemetryFrame):
+                self.control_frames += 1
+        return texts
+
+    def command(self, line: str, replies: Optional[int] = None,
+                timeout: float = 1.0, quiet: float = 0.15) -> List[str]:
+        """Send a command and wait for `replies` lines, or until the
+        replies stop for `quiet` seconds when the count is not known."""
+        self.write(line.encode('ascii') + b'\n')
+        texts: List[str] = []
+        deadline = time.monotonic() + timeout
+        last_reply = None
+        while time.monotonic() < deadline:
+            received = self.poll()
+            if received:
+                texts += received
+                last_reply = time.monotonic()
+            if replies is not None and len(texts) >= replies:
+                break
+            if replies is None and last_reply and time.monotonic() - last_reply >= quiet:
+                break
+        return texts
+
+
+def open_link(port: str, baud: int) -> ConsoleLink:
+    if port.startswith('/dev/pts/'):
+        # Pseudo terminal of the host build
+        import tty
+        fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+
+        def read_pty(size: int) -> bytes:
+            ready, _, _ = select.select([fd], [], [], 0.02)
+            return os.read(fd, size) if ready else b''
+
+        return ConsoleLink(read_pty, lambda data: os.write(fd, data))
+
+    import serial  # pyserial, only needed for real ports
+    link = serial.Serial(port, baud, timeout=0.02)
+    return ConsoleLink(link.read, link.write)
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('port', help='Serial port of the robot or host PTY')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('-c', '--command', action='append', default=[],
+                        help='Run this command and exit (repeatable)')
+    args = parser.parse_args(argv)
+
+    link = open_link(args.port, args.baud)
+    for line in args.command:
+        for text in link.command(line):
+            print(text)
+    if args.command:
+        return 0
+
+    try:
+        while True:
+            line = input('> ').strip()
+            if line == 'quit':
+                break
+            if line == 'help':
+                print(HELP)
+            elif line:
+                texts = link.command(line)
+                print('\n'.join(texts) if texts else '(no reply)')
+    except (EOFError, KeyboardInterrupt):
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,121 @@
+"""Checks the serial console against the host build behind a pseudo terminal.
+
+Starts the console host program (analysis profile), talks to it through
+the PTY like tools/robot_console.py does with the robot and compares the
+replies of every command, including the error cases. POSIX only:
+
+    pio run -e console
+    python tools/run_console_check.py
+"""
+import argparse
+import subprocess
+import sys
+import time
+from pathlib import Path
+from typing import List
+
+from robot_console import ConsoleLink, open_link
+
+PROJECT_DIR = Path(__file__).resolve().parent.parent
+DEFAULT_BINARY = PROJECT_DIR / '.pio' / 'build' / 'console' / 'program'
+
+PROFILE_FIELDS = 19
+TASKS = 8
+
+
+class Check:
+    def __init__(self, link: ConsoleLink):
+        self.link = link
+        self.failed = 0
+
+    def expect(self, command: str, expected: List[str]) -> List[str]:
+        replies = self.link.command(command, replies=len(expected))
+        self.report(command, replies == expected, replies, expected)
+        return replies
+
+    def report(self, command: str, passed: bool, actual, expected) -> None:
+        if not passed:
+            self.failed += 1
+        print(f"{'PASS' if passed else 'FAIL'} {command!r}: {actual}"
+              + ('' if passed else f" (expected {expected})"))
+
+
+def control_frames_during(link: ConsoleLink, seconds: float) -> int:
+    start = link.control_frames
+    end = time.monotonic() + seconds
+    while time.monotonic() < end:
+        link.poll()
+    return link.control_frames - start
+
+
+def run(link: ConsoleLink) -> int:
+    check = Check(link)
+
+    # Reads and writes of single fields, analysis profile values
+    check.expect('g speedFast', ['speedFast=140'])
+    check.expect('s speedFast 150', ['speedFast=150'])
+    check.expect('g speedFast', ['speedFast=150'])
+    check.expect('s kProportional 4.25', ['kProportional=4.250'])
+    check.expect('g filterCoefficient', ['filterCoefficient=0.500'])
+
+    # Errors
+    check.expect('s speedFast 300', ['? range'])
+    check.expect('s speedFast 12.5', ['? range'])
+    check.expect('s filterCoefficient 2', ['? range'])
+    check.expect('s speedFast fast', ['? value'])
+    check.expect('s speedFast', ['? value'])
+    check.expect('g speed', ['? speed'])
+    check.expect('q', ['? q'])
+    check.expect('x' * 40, ['? line too long'])
+
+    # Listings
+    fields = link.command('?', replies=PROFILE_FIELDS)
+    check.report('?', len(fields) == PROFILE_FIELDS and fields[0] == 'speedStop=0'
+                 and 'speedFast=150' in fields, fields, f'{PROFILE_FIELDS} fields')
+    time.sleep(1.1)  # One loop rate window
+    tasks = link.command('t', replies=TASKS + 1)
+    loop_rate = int(tasks[-1].split()[1]) if tasks and tasks[-1].startswith('loop ') else 0
+    check.report('t', len(tasks) == TASKS + 1 and tasks[0].startswith('t0 ') and loop_rate > 0,
+                 tasks, f'{TASKS} tasks and the loop rate')
+
+    # Run control: telemetry stops with the robot and resumes with a new run
+    check.expect('r', ['? running'])
+    check.expect('x', ['stop'])
+    link.command('', timeout=0.1)
+    stopped = control_frames_during(link, 0.3)
+    check.report('stopped', stopped == 0, f'{stopped} control frames', 'none')
+    check.expect('r', ['run'])
+    running = control_frames_during(link, 0.3)
+    check.report('running', running > 0, f'{running} control frames', 'some')
+
+    # Tuned values stay for the next run, until reset
+    check.expect('g speedFast', ['speedFast=150'])
+
+    print(f"{'all checks passed' if check.failed == 0 else f'{check.failed} checks failed'}, "
+          f"{link.decoder.bad_frames} bad frames")
+    return 1 if check.failed else 0
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--binary', type=Path, default=DEFAULT_BINARY,
+                        help='Console host executable (default: %(default)s)')
+    args = parser.parse_args(argv)
+
+    if not args.binary.exists():
+        print(f"{args.binary} not found, build it with 'pio run -e console'", file=sys.stderr)
+        return 2
+
+    process = subprocess.Popen([str(args.binary), '--seconds', '60'],
+                               stdout=subprocess.PIPE, text=True)
+    try:
+        port = process.stdout.readline().strip()
+        return run(open_link(port, 115200))
+    finally:
+        process.terminate()
+        process.wait()
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,59 @@
+"""Runs every golden-trace scenario through the host build.
+
+Each scenario in host/golden/scenarios/<name>.txt is compared against
+host/golden/expected/<name>.csv. Build the checker first:
+
+    pio run -e golden
+    python tools/run_golden.py
+    python tools/run_golden.py --tolerance 2
+    python tools/run_golden.py --update    # accept an intended behavior change
+"""
+import argparse
+import subprocess
+import sys
+from pathlib import Path
+from typing import List
+
+PROJECT_DIR = Path(__file__).resolve().parent.parent
+GOLDEN_DIR = PROJECT_DIR / 'host' / 'golden'
+DEFAULT_BINARY = PROJECT_DIR / '.pio' / 'build' / 'golden' / 'program'
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--binary', type=Path, default=DEFAULT_BINARY,
+                        help='Golden checker executable (default: %(default)s)')
+    parser.add_argument('--tolerance', type=int, default=0,
+                        help='Allowed difference for motor powers and speed')
+    parser.add_argument('--update', action='store_true', help='Rewrite the expected traces')
+    parser.add_argument('scenarios', nargs='*', help='Scenario names (default: all)')
+    args = parser.parse_args(argv)
+
+    binary = args.binary
+    if not binary.exists() and binary.with_suffix('.exe').exists():
+        binary = binary.with_suffix('.exe')
+    if not binary.exists():
+        print(f"{binary} not found, build it with 'pio run -e golden'", file=sys.stderr)
+        return 2
+
+    names = args.scenarios or sorted(p.stem for p in (GOLDEN_DIR / 'scenarios').glob('*.txt'))
+    failed = []
+    for name in names:
+        command = [str(binary), str(GOLDEN_DIR / 'scenarios' / f'{name}.txt'),
+                   str(GOLDEN_DIR / 'expected' / f'{name}.csv'),
+                   '--tolerance', str(args.tolerance)]
+        if args.update:
+            command.append('--update')
+        # One process per scenario: firmware state is static
+        if subprocess.run(command).returncode != 0:
+            failed.append(name)
+
+    print(f"{len(names) - len(failed)}/{len(names)} scenarios passed")
+    if failed:
+        print('failed: ' + ', '.join(failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,51 @@
+"""Runs every capture of the marker classifier corpus through the host build.
+
+Each capture in host/markers/corpus/*.csv carries the expected outcome
+on a "# expect" line (see tools/make_marker_corpus.py). Build the
+checker first:
+
+    pio run -e markers
+    python tools/run_markers.py
+    python tools/run_markers.py crossing_skew25_1500
+"""
+import argparse
+import subprocess
+import sys
+from pathlib import Path
+from typing import List
+
+PROJECT_DIR = Path(__file__).resolve().parent.parent
+CORPUS_DIR = PROJECT_DIR / 'host' / 'markers' / 'corpus'
+DEFAULT_BINARY = PROJECT_DIR / '.pio' / 'build' / 'markers' / 'program'
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--binary', type=Path, default=DEFAULT_BINARY,
+                        help='Marker checker executable (default: %(default)s)')
+    parser.add_argument('captures', nargs='*', help='Capture names (default: all)')
+    args = parser.parse_args(argv)
+
+    binary = args.binary
+    if not binary.exists() and binary.with_suffix('.exe').exists():
+        binary = binary.with_suffix('.exe')
+    if not binary.exists():
+        print(f"{binary} not found, build it with 'pio run -e markers'", file=sys.stderr)
+        return 2
+
+    names = args.captures or sorted(p.stem for p in CORPUS_DIR.glob('*.csv'))
+    failed = []
+    for name in names:
+        # One process per capture: firmware state is static
+        if subprocess.run([str(binary), str(CORPUS_DIR / f'{name}.csv')]).returncode != 0:
+            failed.append(name)
+
+    print(f"{len(names) - len(failed)}/{len(names)} captures passed")
+    if failed:
+        print('failed: ' + ', '.join(failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
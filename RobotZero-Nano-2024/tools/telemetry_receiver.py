@@ -0,0 +1,227 @@
+"""Live decoder for the RobotZero binary telemetry stream.
+
+Frames are COBS encoded and delimited by 0x00 bytes. Each payload starts
+with a TelemetryType byte and a sequence number, matches the structures in
+src/DataStructures.h and ends with a CRC16 (MODBUS).
+
+Usage:
+    python telemetry_receiver.py COM6
+    python telemetry_receiver.py /dev/ttyUSB0 --csv run.csv
+    python telemetry_receiver.py /dev/ttyUSB0 --baud 1000000 --raw-csv capture.csv
+
+The --raw-csv file (TELEMETRY_RAW_CAPTURE builds) is the input of the
+host replay harness (pio run -e replay).
+"""
+import argparse
+import struct
+import sys
+import time
+from typing import Iterator, List, Optional, NamedTuple, TextIO, Union
+
+TYPE_CONTROL = 0x01
+TYPE_RAW_SENSORS = 0x02
+TYPE_CALIBRATION = 0x03
+TYPE_CONSOLE = 0x04
+
+STATE_PRECISION = 0x01
+STATE_TURN = 0x02
+
+
+class TelemetryFrame(NamedTuple):
+    sequence: int
+    timestamp: int
+    speed: int
+    error: int
+    correction: int
+    left_power: int
+    right_power: int
+    state: int
+
+
+class RawSensorFrame(NamedTuple):
+    sequence: int
+    timestamp: int
+    line: tuple
+    marker_left: int
+    marker_right: int
+    left_power: int
+    right_power: int
+
+
+class CalibrationFrame(NamedTuple):
+    sequence: int
+    sensor_min: tuple
+    sensor_max: tuple
+
+
+class ConsoleFrame(NamedTuple):
+    sequence: int
+    text: str
+
+
+Frame = Union[TelemetryFrame, RawSensorFrame, CalibrationFrame, ConsoleFrame]
+
+# Payload layouts after the type byte, CRC excluded
+FRAME_FORMATS = {
+    TYPE_CONTROL: struct.Struct('<BHBhhhhB'),
+    TYPE_RAW_SENSORS: struct.Struct('<BI6hhhhh'),
+    TYPE_CALIBRATION: struct.Struct('<B6h6h'),
+    TYPE_CONSOLE: struct.Struct('<B24s'),
+}
+
+
+def crc16(data: bytes) -> int:
+    """CRC16 matching avr-libc _crc16_update with 0xFFFF seed."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_decode(data: bytes) -> Optional[bytes]:
+    output = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        if code == 0 or index + code > len(data) + 1:
+            return None
+        output += data[index + 1:index + code]
+        index += code
+        if code < 0xFF and index < len(data):
+            output.append(0)
+    return bytes(output)
+
+
+def decode_frame(packet: bytes) -> Optional[Frame]:
+    payload = cobs_decode(packet)
+    if payload is None or len(payload) < 4:
+        return None
+    layout = FRAME_FORMATS.get(payload[0])
+    if layout is None or len(payload) != 1 + layout.size + 2:
+        return None
+    if crc16(payload[:-2]) != struct.unpack('<H', payload[-2:])[0]:
+        return None
+
+    fields = layout.unpack(payload[1:-2])
+    if payload[0] == TYPE_CONTROL:
+        return TelemetryFrame(*fields)
+    if payload[0] == TYPE_RAW_SENSORS:
+        return RawSensorFrame(fields[0], fields[1], fields[2:8], *fields[8:])
+    if payload[0] == TYPE_CONSOLE:
+        return ConsoleFrame(fields[0], fields[1].rstrip(b'\0').decode('ascii', 'replace'))
+    return CalibrationFrame(fields[0], fields[1:7], fields[7:13])
+
+
+class FrameDecoder:
+    """Splits a byte stream on 0x00 and keeps link statistics."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.frames = 0
+        self.bad_frames = 0
+        self.lost_frames = 0
+        self.last_sequence: Optional[int] = None
+        self.lost = 0  # Frames lost right before the last yielded frame
+
+    def feed(self, data: bytes) -> Iterator[Frame]:
+        self.pending += data
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return
+            packet = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not packet:
+                continue
+            frame = decode_frame(packet)
+            if frame is None:
+                self.bad_frames += 1
+                continue
+            self.lost = 0
+            if self.last_sequence is not None:
+                self.lost = (frame.sequence - self.last_sequence - 1) & 0xFF
+                self.lost_frames += self.lost
+            self.last_sequence = frame.sequence
+            self.frames += 1
+            yield frame
+
+
+def format_frame(frame: Frame) -> str:
+    if isinstance(frame, RawSensorFrame):
+        return (f"{frame.timestamp:10d} #{frame.sequence:3d} raw line={list(frame.line)} "
+                f"markers=({frame.marker_left},{frame.marker_right}) "
+                f"L={frame.left_power:4d} R={frame.right_power:4d}")
+    if isinstance(frame, ConsoleFrame):
+        return f"console {frame.text}"
+    if isinstance(frame, CalibrationFrame):
+        return f"calibration min={list(frame.sensor_min)} max={list(frame.sensor_max)}"
+    mode = 'P' if frame.state & STATE_PRECISION else 'F'
+    turn = 'T' if frame.state & STATE_TURN else ' '
+    return (f"{frame.timestamp:5d} #{frame.sequence:3d} {mode}{turn} "
+            f"speed={frame.speed:3d} error={frame.error:4d} "
+            f"corr={frame.correction:4d} L={frame.left_power:4d} R={frame.right_power:4d}")
+
+
+def write_raw_row(output: TextIO, frame: Frame, lost: int) -> None:
+    """Append a frame to a replay capture file."""
+    if isinstance(frame, CalibrationFrame):
+        values = list(frame.sensor_min) + list(frame.sensor_max)
+        output.write('calibration,' + ','.join(str(v) for v in values) + '\n')
+        output.write('timestamp_us,line0,line1,line2,line3,line4,line5,'
+                     'marker_left,marker_right,left_power,right_power\n')
+    elif isinstance(frame, RawSensorFrame):
+        if lost:
+            output.write(f'# lost {lost}\n')
+        values = [frame.timestamp, *frame.line, frame.marker_left, frame.marker_right,
+                  frame.left_power, frame.right_power]
+        output.write(','.join(str(v) for v in values) + '\n')
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('port', help='Serial port of the robot')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--csv', help='Also write decoded frames to this CSV file')
+    parser.add_argument('--raw-csv', help='Write raw sensor frames to this replay capture file')
+    parser.add_argument('--quiet', action='store_true', help='Only print link statistics')
+    args = parser.parse_args(argv)
+
+    import serial  # pyserial, imported here so the decoder is usable without it
+
+    decoder = FrameDecoder()
+    csv_file = open(args.csv, 'w') if args.csv else None
+    if csv_file:
+        csv_file.write(','.join(TelemetryFrame._fields) + '\n')
+    raw_file = open(args.raw_csv, 'w') if args.raw_csv else None
+
+    last_report = time.monotonic()
+    try:
+        with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+            while True:
+                for frame in decoder.feed(port.read(256)):
+                    if csv_file and isinstance(frame, TelemetryFrame):
+                        csv_file.write(','.join(str(v) for v in frame) + '\n')
+                    if raw_file:
+                        write_raw_row(raw_file, frame, decoder.lost)
+                    if not args.quiet:
+                        print(format_frame(frame))
+                now = time.monotonic()
+                if now - last_report >= 1.0:
+                    print(f"-- frames={decoder.frames} lost={decoder.lost_frames} "
+                          f"bad={decoder.bad_frames}", file=sys.stderr)
+                    last_report = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if csv_file:
+            csv_file.close()
+        if raw_file:
+            raw_file.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))